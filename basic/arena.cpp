@@ -0,0 +1,148 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace {
+
+thread_local Arena* current_arena = nullptr;
+
+}  // namespace
+
+Arena::Arena(size_t chunk_size)
+    : own_heap_(),
+      heap_(nullptr),
+      finalizers_(),
+      chunk_size_(chunk_size),
+      chunks_(),
+      curr_chunk_(0),
+      offset_(0),
+      used_before_(0),
+      allocations_(0),
+      free_lists_() {
+#ifdef SCHEME_COMPRESSED_REFS
+    heap_ = CompressedHeap();
+#else
+    own_heap_ = std::make_unique<ObjectHeap>();
+    heap_ = own_heap_.get();
+#endif
+}
+
+Arena::~Arena() {
+    Reset();
+    if (!own_heap_) {
+        for (auto& chunk : chunks_) {
+            heap_->Release(chunk.data, chunk.size);
+        }
+    }
+}
+
+void* Arena::Allocate(size_t size, size_t align) {
+    ++allocations_;
+    if (!Recycled(size, align)) {
+        return Bump(size, align);
+    }
+    FreeBlock*& head = free_lists_[SizeClass(size)];
+    if (FreeBlock* block = head) {
+        head = block->next;
+        return block;
+    }
+    return Bump((SizeClass(size) + 1) * kSizeClass, kSizeClass);
+}
+
+void Arena::Deallocate(void* ptr, size_t size, size_t align) {
+    if (Recycled(size, align)) {
+        FreeBlock*& head = free_lists_[SizeClass(size)];
+        head = new (ptr) FreeBlock{head};
+    }
+}
+
+void* Arena::Bump(size_t size, size_t align) {
+    if (!chunks_.empty()) {
+        auto& chunk = chunks_[curr_chunk_];
+        auto base = reinterpret_cast<uintptr_t>(chunk.data);
+        size_t start = ((base + offset_ + align - 1) & ~(align - 1)) - base;
+        if (start + size <= chunk.size) {
+            offset_ = start + size;
+            return chunk.data + start;
+        }
+    }
+    NextChunk(size + align);
+    return Bump(size, align);
+}
+
+void Arena::NextChunk(size_t min_size) {
+    if (!chunks_.empty()) {
+        used_before_ += offset_;
+        ++curr_chunk_;
+    }
+    offset_ = 0;
+    // Reuse a chunk kept from before the last Reset if it is large enough.
+    while (curr_chunk_ < chunks_.size() && chunks_[curr_chunk_].size < min_size) {
+        ++curr_chunk_;
+    }
+    if (curr_chunk_ < chunks_.size()) {
+        return;
+    }
+    size_t size = std::max(chunk_size_, min_size);
+    void* data = heap_->Allocate(size);
+    chunks_.push_back({static_cast<char*>(data), size});
+    curr_chunk_ = chunks_.size() - 1;
+}
+
+void Arena::AddFinalizer(void* obj, void (*finalize)(void*)) {
+    finalizers_.push_back({obj, finalize});
+}
+
+void Arena::Reset() {
+    for (auto it = finalizers_.rbegin(); it != finalizers_.rend(); ++it) {
+        it->finalize(it->obj);
+    }
+    finalizers_.clear();
+    free_lists_.fill(nullptr);
+    curr_chunk_ = 0;
+    offset_ = 0;
+    used_before_ = 0;
+}
+
+bool Arena::Owns(const void* ptr) const {
+    auto p = static_cast<const char*>(ptr);
+    for (const auto& chunk : chunks_) {
+        if (chunk.data <= p && p < chunk.data + chunk.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Arena::BytesUsed() const {
+    return used_before_ + offset_;
+}
+
+Arena* CurrentArena() {
+    return current_arena;
+}
+
+Arena* StaticArena() {
+    // Leaked on purpose: its objects may be referenced until the thread is gone.
+    thread_local Arena* arena = new Arena();
+    return arena;
+}
+
+ArenaScope::ArenaScope(Arena* arena) : arena_(arena), prev_(current_arena) {
+    current_arena = arena_;
+}
+
+ArenaScope::~ArenaScope() {
+    current_arena = prev_;
+    arena_->Reset();
+}
+
+HeapScope::HeapScope() : prev_(current_arena) {
+    current_arena = nullptr;
+}
+
+HeapScope::~HeapScope() {
+    current_arena = prev_;
+}
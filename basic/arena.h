@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "heap.h"
+
+// Bump allocator for the objects of a single Interpreter::Run; the whole region is rewound at once
+// by Reset(). Small blocks that are deallocated before that go to a free list per size class and
+// are handed out again, so a long loop over short-lived objects runs in bounded memory. Chunks are
+// carved from an ObjectHeap, which is the arena's own one unless SCHEME_COMPRESSED_REFS makes all
+// arenas share one base.
+class Arena {
+public:
+    Arena(size_t chunk_size = 64 * 1024);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+
+    void* Allocate(size_t size, size_t align);
+
+    // Makes a block from Allocate with the same `size` and `align` available for reuse.
+    void Deallocate(void* ptr, size_t size, size_t align);
+
+    // Registers a destructor to run on Reset, for objects that the arena owns outright.
+    void AddFinalizer(void* obj, void (*finalize)(void*));
+
+    // Runs the finalizers and rewinds to the first chunk. Chunks are kept, so a steady workload
+    // stops mapping memory.
+    void Reset();
+
+    bool Owns(const void* ptr) const;
+
+    size_t BytesUsed() const;
+
+    // Blocks handed out by Allocate since the arena was made; Reset does not clear it.
+    size_t Allocations() const {
+        return allocations_;
+    }
+
+    ObjectHeap* GetHeap() {
+        return heap_;
+    }
+
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    struct Finalizer {
+        void* obj;
+        void (*finalize)(void*);
+    };
+
+    // Blocks up to kMaxRecycled bytes are rounded up to a multiple of kSizeClass and aligned to
+    // it, so that any block of a class fits any request of the class.
+    static constexpr size_t kSizeClass = 16;
+    static constexpr size_t kMaxRecycled = 256;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static bool Recycled(size_t size, size_t align) {
+        return size <= kMaxRecycled && align <= kSizeClass;
+    }
+
+    static size_t SizeClass(size_t size) {
+        return size ? (size - 1) / kSizeClass : 0;
+    }
+
+    void* Bump(size_t size, size_t align);
+    void NextChunk(size_t min_size);
+
+    std::unique_ptr<ObjectHeap> own_heap_;
+    ObjectHeap* heap_;
+    std::vector<Finalizer> finalizers_;
+    size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    size_t curr_chunk_;
+    size_t offset_;
+    size_t used_before_;
+    size_t allocations_;
+    std::array<FreeBlock*, kMaxRecycled / kSizeClass> free_lists_;
+};
+
+// Arena objects are allocated from while set, the general-purpose heap otherwise.
+Arena* CurrentArena();
+
+// With SCHEME_COMPRESSED_REFS every object lives in an arena; this one is never reset and takes
+// the objects built outside of Run as well as promoted ones.
+Arena* StaticArena();
+
+// Makes `arena` current for the lifetime of the scope and resets it on exit. Every object
+// allocated in the scope must be released before the scope ends.
+class ArenaScope {
+public:
+    ArenaScope(Arena* arena);
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    ~ArenaScope();
+
+private:
+    Arena* arena_;
+    Arena* prev_;
+};
+
+// Suspends the current arena so that long-lived values are allocated on the heap.
+class HeapScope {
+public:
+    HeapScope();
+    HeapScope(const HeapScope&) = delete;
+    HeapScope& operator=(const HeapScope&) = delete;
+    ~HeapScope();
+
+private:
+    Arena* prev_;
+};
+
+template <class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(Arena* arena) : arena_(arena) {
+    }
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.GetArena()) {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        arena_->Deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    Arena* GetArena() const {
+        return arena_;
+    }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return arena_ == other.GetArena();
+    }
+
+private:
+    Arena* arena_;
+};
+
+// Types whose destructor only releases memory inside the arena, so it may be skipped.
+template <class T>
+constexpr bool kArenaTrivial = false;
+
+// Single allocation point for interpreter objects: the object and its control block go to the
+// current arena if there is one. With SCHEME_COMPRESSED_REFS objects are owned by the arena
+// itself and the returned pointer does not count references.
+template <class T, class... Args>
+std::shared_ptr<T> Make(Args&&... args) {
+#ifdef SCHEME_COMPRESSED_REFS
+    Arena* arena = CurrentArena() ? CurrentArena() : StaticArena();
+    T* obj = new (arena->Allocate(sizeof(T), std::max<size_t>(alignof(T), 8)))
+        T(std::forward<Args>(args)...);
+    if constexpr (!kArenaTrivial<T>) {
+        arena->AddFinalizer(obj, [](void* ptr) { static_cast<T*>(ptr)->~T(); });
+    }
+    return std::shared_ptr<T>(std::shared_ptr<T>(), obj);
+#else
+    if (Arena* arena = CurrentArena()) {
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+    }
+    return std::make_shared<T>(std::forward<Args>(args)...);
+#endif
+}
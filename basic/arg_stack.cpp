@@ -0,0 +1,49 @@
+#include "arg_stack.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+constexpr size_t kChunkSize = 1024;
+
+struct ArgStack {
+    struct Chunk {
+        std::unique_ptr<std::shared_ptr<Object>[]> slots;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t curr_chunk = 0;
+    size_t offset = 0;
+};
+
+thread_local ArgStack stack;
+
+}  // namespace
+
+ArgFrame::ArgFrame(size_t size)
+    : size_(size), prev_chunk_(stack.curr_chunk), prev_offset_(stack.offset), active_(true) {
+    while (stack.curr_chunk < stack.chunks.size() &&
+           stack.offset + size > stack.chunks[stack.curr_chunk].size) {
+        ++stack.curr_chunk;
+        stack.offset = 0;
+    }
+    if (stack.curr_chunk == stack.chunks.size()) {
+        size_t chunk_size = std::max(kChunkSize, size);
+        stack.chunks.push_back({std::make_unique<std::shared_ptr<Object>[]>(chunk_size), chunk_size});
+    }
+    slots_ = stack.chunks[stack.curr_chunk].slots.get() + stack.offset;
+    stack.offset += size;
+}
+
+ArgFrame::~ArgFrame() {
+    if (!active_) {
+        return;
+    }
+    for (size_t i = 0; i < size_; ++i) {
+        slots_[i].reset();
+    }
+    stack.curr_chunk = prev_chunk_;
+    stack.offset = prev_offset_;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+
+class Object;
+
+// Evaluated arguments of a builtin call, borrowed from the argument stack.
+using ArgSpan = std::span<const std::shared_ptr<Object>>;
+
+// Reserves `size` contiguous slots on the thread's argument stack for the lifetime of the scope.
+// The stack is a list of chunks that are kept when frames are popped, so once it is warm passing
+// arguments does not allocate. Slots never move, so frames pushed while evaluating the arguments
+// of an outer call leave its span valid.
+class ArgFrame {
+public:
+    explicit ArgFrame(size_t size);
+    ArgFrame(const ArgFrame&) = delete;
+    ArgFrame& operator=(const ArgFrame&) = delete;
+    // The moved-from frame no longer pops anything, so frames can live in a vector as long as
+    // they are destroyed in reverse order of creation.
+    ArgFrame(ArgFrame&& other) noexcept
+        : slots_(other.slots_),
+          size_(other.size_),
+          prev_chunk_(other.prev_chunk_),
+          prev_offset_(other.prev_offset_),
+          active_(other.active_) {
+        other.active_ = false;
+    }
+    ArgFrame& operator=(ArgFrame&&) = delete;
+    // Releases the values and pops the frame.
+    ~ArgFrame();
+
+    std::shared_ptr<Object>& operator[](size_t i) {
+        return slots_[i];
+    }
+
+    ArgSpan Args() const {
+        return {slots_, size_};
+    }
+
+private:
+    std::shared_ptr<Object>* slots_;
+    size_t size_;
+    size_t prev_chunk_;
+    size_t prev_offset_;
+    bool active_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Runs `f` `iters` times and prints the mean time per call.
+template <class F>
+void Measure(const std::string& name, int64_t iters, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iters; ++i) {
+        f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << name << ": " << ns / iters << " ns/op" << std::endl;
+}
+
+void RunVectorBench();
+
+void RunInterpreterBench();
+
+void RunHeapBench();
+
+void RunBignumBench();
+
+void RunStringBench();
+
+void RunHashBench();
+
+void RunMapBench();
+
+void RunBytevectorBench();
+
+void RunRecordBench();
+
+void RunEngineBench();
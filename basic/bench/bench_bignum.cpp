@@ -0,0 +1,25 @@
+#include <string>
+
+#include "bench.h"
+#include <bigint.h>
+#include <scheme.h>
+
+void RunBignumBench() {
+    Interpreter interpreter;
+    std::string factorial = "(*";
+    for (int i = 1; i <= 10000; ++i) {
+        factorial += " " + std::to_string(i);
+    }
+    factorial += ")";
+    Measure("run factorial 10000", 3, [&] { interpreter.Run(factorial); });
+
+    BigInt fact(1);
+    for (int i = 1; i <= 10000; ++i) {
+        fact = fact * BigInt(i);
+    }
+    BigInt half = fact / BigInt(3);
+    Measure("multiply 10000! by 10000!/3 (karatsuba)", 10, [&] { (void)(fact * half); });
+    Measure("multiply 10000! by 10000!/3 (schoolbook)", 10,
+            [&] { (void)BigInt::MulSchoolbook(fact, half); });
+    Measure("print 10000!", 10, [&] { (void)fact.ToString(); });
+}
@@ -0,0 +1,26 @@
+#include <string>
+
+#include "bench.h"
+#include <object.h>
+#include <scheme.h>
+
+void RunBytevectorBench() {
+    const size_t size = 1 << 24;
+    auto bytes = Make<Bytevector>(size, 1);
+    auto other = Make<Bytevector>(size, 1);
+    bytes->Set(size - 1, 2);
+    volatile size_t sink = 0;
+    Measure("bytevector fill 16 MB", 20, [&] { other->Fill(1); });
+    Measure("bytevector copy 16 MB", 20,
+            [&] { sink = Make<Bytevector>(bytes->Data(), bytes->Size())->Size(); });
+    Measure("bytevector compare 16 MB", 20, [&] { sink = bytes->Equals(*other); });
+    Measure("bytevector search 16 MB", 20, [&] { sink = bytes->Find(2, 0); });
+
+    Interpreter interpreter;
+    std::string literal = "(bytevector-length #u8(";
+    for (int i = 0; i < 1000; ++i) {
+        literal += std::to_string(i % 256) + " ";
+    }
+    literal += "))";
+    Measure("run bytevector literal of 1000", 3000, [&] { interpreter.Run(literal); });
+}
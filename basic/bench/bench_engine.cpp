@@ -0,0 +1,49 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include <scheme.h>
+
+void RunEngineBench() {
+    // The operands are lambda parameters, so that constant folding leaves the work to the engine.
+    std::string arithmetic =
+        "((lambda (loop) (loop loop 1000 0))"
+        " (lambda (self n acc) (if (= n 0) acc (self self (- n 1) (+ acc (- (* n 3) 1))))))";
+    std::string lists =
+        "((lambda (build sum) (sum sum (build build 1000 '()) 0))"
+        " (lambda (self n acc) (if (= n 0) acc (self self (- n 1) (cons n acc))))"
+        " (lambda (self l acc) (if (null? l) acc (self self (cdr l) (+ acc (car l))))))";
+    std::string fib =
+        "((lambda (fib) (fib fib 20))"
+        " (lambda (self n) (if (< n 2) n (+ (self self (- n 1)) (self self (- n 2))))))";
+    // A lambda applied where it is made and a pair taken apart right away, on every iteration.
+    std::string temporaries =
+        "((lambda (loop) (loop loop 1000 0))"
+        " (lambda (self n acc)"
+        "  (if (= n 0) acc (self self (- n 1) ((lambda (x) (+ acc x)) (car (cons n acc)))))))";
+    std::vector<std::pair<Engine, std::string>> engines = {
+        {Engine::TREE, "tree"}, {Engine::BYTECODE, "bytecode"}, {Engine::NODES, "nodes"}};
+    for (const auto& [engine, name] : engines) {
+        Interpreter interpreter;
+        interpreter.SetEngine(engine);
+        NodeStats stats;
+        interpreter.SetNodeStats(&stats);
+        // Prints the objects that each run allocates after the time it takes.
+        auto measure = [&](const std::string& label, int64_t iters, const std::string& program) {
+            size_t before = interpreter.GetAllocationCount();
+            Measure(name + " " + label, iters, [&] { interpreter.Run(program); });
+            std::cout << "  allocations per run: "
+                      << (interpreter.GetAllocationCount() - before) / iters << std::endl;
+        };
+        measure("arithmetic loop of 1000", 1000, arithmetic);
+        measure("build and sum a list of 1000", 1000, lists);
+        measure("fib 20", 10, fib);
+        measure("temporary closures and pairs, 1000", 1000, temporaries);
+        measure("(+ 1 2)", 1000000, "(+ 1 2)");
+        if (engine == Engine::NODES) {
+            std::cout << "  nodes specialized: " << stats.specialized
+                      << ", guard failures: " << stats.guard_failures << std::endl;
+        }
+    }
+}
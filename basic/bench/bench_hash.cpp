@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <string>
+
+#include "bench.h"
+#include <object.h>
+
+namespace {
+
+std::shared_ptr<Object> Assoc(const std::shared_ptr<Object>& key, std::shared_ptr<Object> alist) {
+    while (Is<Cell>(alist)) {
+        auto entry = As<Cell>(alist)->GetFirst();
+        if (IsEquivalent(As<Cell>(entry)->GetFirst(), key, Equivalence::EQUAL)) {
+            return entry;
+        }
+        alist = As<Cell>(alist)->GetSecond();
+    }
+    return nullptr;
+}
+
+void BenchLookups(int64_t size) {
+    auto table = Make<HashTable>(Equivalence::EQUAL);
+    std::shared_ptr<Object> alist;
+    std::vector<std::shared_ptr<Object>> keys;
+    for (int64_t i = 0; i < size; ++i) {
+        auto key = Make<Cell>(Make<Symbol>("key"), Make<Number>(i));
+        keys.push_back(key);
+        table->Set(key, Make<Number>(i));
+        alist = Make<Cell>(Make<Cell>(key, Make<Number>(i)), alist);
+    }
+    int64_t i = 0;
+    auto name = std::to_string(size) + " keys";
+    Measure("hash table lookup, " + name, 1000000, [&] { table->Get(keys[i++ % size]); });
+    Measure("assoc list lookup, " + name, std::max<int64_t>(3, 1000000 / size),
+            [&] { Assoc(keys[i++ % size], alist); });
+}
+
+}  // namespace
+
+void RunHashBench() {
+    BenchLookups(10);
+    BenchLookups(1000);
+    BenchLookups(1000000);
+}
@@ -0,0 +1,20 @@
+#include <string>
+
+#include "bench.h"
+#include <scheme.h>
+
+void RunHeapBench() {
+    for (bool huge_pages : {false, true}) {
+        Interpreter interpreter;
+        interpreter.SetHugePages(huge_pages);
+        auto suffix = std::string(" huge_pages=") + (huge_pages ? "on" : "off");
+        Measure("build list of 1M" + suffix, 20, [&] {
+            interpreter.Run("(list-tail (vector->list (make-vector 1000000 0)) 999999)");
+        });
+        auto stats = interpreter.GetHeapStats();
+        std::cout << "  regions mapped: " << stats.regions_mapped
+                  << ", huge page regions: " << stats.huge_page_regions
+                  << ", bytes mapped: " << stats.bytes_mapped
+                  << ", bytes used: " << stats.bytes_used << std::endl;
+    }
+}
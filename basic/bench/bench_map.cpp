@@ -0,0 +1,63 @@
+#include <string>
+
+#include "bench.h"
+#include <object.h>
+
+namespace {
+
+// Functional update of an association list: the entries before `key` are copied.
+std::shared_ptr<Object> AlistSet(const std::shared_ptr<Object>& alist,
+                                 const std::shared_ptr<Object>& key,
+                                 const std::shared_ptr<Object>& value) {
+    std::vector<std::shared_ptr<Object>> prefix;
+    auto curr = alist;
+    while (Is<Cell>(curr)) {
+        auto entry = As<Cell>(curr)->GetFirst();
+        if (IsEquivalent(As<Cell>(entry)->GetFirst(), key, Equivalence::EQUAL)) {
+            curr = As<Cell>(curr)->GetSecond();
+            break;
+        }
+        prefix.push_back(entry);
+        curr = As<Cell>(curr)->GetSecond();
+    }
+    auto ans = Make<Cell>(Make<Cell>(key, value), curr);
+    for (auto it = prefix.rbegin(); it != prefix.rend(); ++it) {
+        ans = Make<Cell>(*it, ans);
+    }
+    return ans;
+}
+
+}  // namespace
+
+void RunMapBench() {
+    std::vector<std::shared_ptr<Object>> keys;
+    for (int64_t i = 0; i < 1000000; ++i) {
+        keys.push_back(Make<Number>(i));
+    }
+    auto value = Make<Number>(int64_t(0));
+
+    Measure("persistent map, 1000000 single updates", 1, [&] {
+        PersistentMap::Trie map = PersistentMap().GetTrie();
+        for (const auto& key : keys) {
+            map = map.Set(key, value);
+        }
+    });
+    Measure("persistent map, 1000000 updates in one transient", 1, [&] {
+        PersistentMap::Trie::Transient batch(PersistentMap().GetTrie());
+        for (const auto& key : keys) {
+            batch.Set(key, value);
+        }
+        batch.Persistent();
+    });
+
+    PersistentMap::Trie map = PersistentMap().GetTrie();
+    std::shared_ptr<Object> alist;
+    for (int64_t i = 0; i < 1000; ++i) {
+        map = map.Set(keys[i], value);
+        alist = Make<Cell>(Make<Cell>(keys[i], value), alist);
+    }
+    int64_t i = 0;
+    Measure("persistent map update, 1000 keys", 100000, [&] { map.Set(keys[i++ % 1000], value); });
+    Measure("assoc list update, 1000 keys", 10000,
+            [&] { AlistSet(alist, keys[i++ % 1000], value); });
+}
@@ -0,0 +1,35 @@
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include <object.h>
+#include <scheme.h>
+
+void RunRecordBench() {
+    const size_t fields = 16;
+    RecordType type{"wide", {}};
+    std::vector<std::shared_ptr<Object>> values;
+    std::shared_ptr<Object> list;
+    for (size_t i = 0; i < fields; ++i) {
+        type.fields.push_back("f" + std::to_string(i));
+        values.push_back(Make<Number>(i));
+        list = Make<Cell>(Make<Number>(fields - 1 - i), list);
+    }
+    RecordProc accessor{RecordProc::Kind::ACCESSOR, &type, {fields - 1}};
+    std::vector<std::shared_ptr<Object>> args = {Make<Record>(&type, values)};
+    volatile int64_t sink = 0;
+    Measure("record accessor, last of 16 fields", 10000000,
+            [&] { sink = As<Number>(*ApplyRecordProc(accessor, args))->GetValue(); });
+    Measure("list walk, last of 16 elements", 10000000, [&] {
+        auto curr = list;
+        for (size_t i = 0; i + 1 < fields; ++i) {
+            curr = As<Cell>(curr)->GetSecond();
+        }
+        sink = As<Number>(As<Cell>(curr)->GetFirst())->GetValue();
+    });
+
+    Interpreter interpreter;
+    interpreter.Run("(define-record-type point (make-point x y) point? (x point-x) (y point-y))");
+    Measure("run record accessor", 100000, [&] { interpreter.Run("(point-y (make-point 1 2))"); });
+    Measure("run list-ref", 100000, [&] { interpreter.Run("(list-ref (list 1 2) 1)"); });
+}
@@ -0,0 +1,61 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include <fold.h>
+#include <object.h>
+#include <parser.h>
+#include <scheme.h>
+
+void RunInterpreterBench() {
+    Interpreter interpreter;
+    std::string list = "'(";
+    for (int i = 0; i < 1000; ++i) {
+        list += std::to_string(i) + " ";
+    }
+    list += ")";
+    Measure("run (+ 1 2)", 1000000, [&] { interpreter.Run("(+ 1 2)"); });
+    Measure("run nested arithmetic", 300000,
+            [&] { interpreter.Run("(+ (* 2 3) (- 10 (/ 8 2)) (max 1 2 3) (abs -4))"); });
+    Measure("run (+ 1.5 2.5)", 1000000, [&] { interpreter.Run("(+ 1.5 2.5)"); });
+    Measure("run float fold of 8", 300000,
+            [&] { interpreter.Run("(* 1.5 2.5 0.5 3.25 1.125 2 0.75 1.0)"); });
+    Measure("run list of 1000", 3000, [&] { interpreter.Run(list); });
+    Measure("try-run failing (+ 1 (car 2))", 1000000,
+            [&] { interpreter.TryRun("(+ 1 (car 2))"); });
+    Measure("run failing (+ 1 (car 2))", 1000000, [&] {
+        try {
+            interpreter.Run("(+ 1 (car 2))");
+        } catch (const RuntimeError&) {
+        }
+    });
+
+    std::string tail_loop =
+        "((lambda (loop) (loop loop 100000 0))"
+        " (lambda (self n acc) (if (= n 0) acc (self self (- n 1) (+ acc 1)))))";
+    Measure("run tail loop of 100000 calls", 30, [&] { interpreter.Run(tail_loop); });
+
+    std::string nested = "0";
+    for (int i = 0; i < 1000; ++i) {
+        nested = "(+ 1 " + nested + ")";
+    }
+    std::stringstream nested_stream(nested);
+    Tokenizer tokenizer(&nested_stream);
+    auto nested_ast = Read(&tokenizer);
+    Measure("eval 1000 nested calls", 3000, [&] { EvalExpr(nested_ast); });
+    Measure("fold 1000 nested calls", 3000,
+            [&] { FoldConstants(nested_ast, kDefaultEvalDepthLimit); });
+
+    std::vector<std::shared_ptr<Object>> numbers;
+    for (int64_t i = 0; i < 1000; ++i) {
+        numbers.push_back(Make<Number>(i));
+    }
+    Function* add = FindBuiltin("+");
+    Function* less = FindBuiltin("<");
+    volatile int64_t sink = 0;
+    Measure("apply + to 1000 fixnums", 100000,
+            [&] { sink = As<Number>(*add->Apply(numbers))->GetValue(); });
+    Measure("apply < to 1000 fixnums", 100000,
+            [&] { sink = As<Bool>(*less->Apply(numbers))->GetVal(); });
+}
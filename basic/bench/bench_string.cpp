@@ -0,0 +1,29 @@
+#include <string>
+
+#include "bench.h"
+#include <object.h>
+#include <scheme.h>
+
+void RunStringBench() {
+    const std::string piece(100, 'x');
+    Measure("append 100000 strings of 100 bytes", 10, [&] {
+        auto str = Make<String>("");
+        for (int i = 0; i < 100000; ++i) {
+            str = String::Concat(str, Make<String>(piece));
+        }
+        (void)str->Flat();
+    });
+
+    auto text = Make<String>(std::string(1 << 24, 'a') + "needle");
+    auto needle = std::string("needle");
+    volatile size_t pos = 0;
+    Measure("search 16 MB string", 10, [&] { pos = text->Find(needle); });
+
+    Interpreter interpreter;
+    std::string append = "(string-length (string-append";
+    for (int i = 0; i < 1000; ++i) {
+        append += " \"" + piece + "\"";
+    }
+    append += "))";
+    Measure("run string-append of 1000", 1000, [&] { interpreter.Run(append); });
+}
@@ -0,0 +1,54 @@
+#include <sstream>
+#include <string>
+
+#include "bench.h"
+#include <parser.h>
+
+namespace {
+
+std::shared_ptr<Object> ReadString(const std::string& str) {
+    std::stringstream ss{str};
+    Tokenizer tokenizer{&ss};
+    return Read(&tokenizer);
+}
+
+std::string Range(int64_t n) {
+    std::string ans;
+    for (int64_t i = 0; i < n; ++i) {
+        ans += std::to_string(i) + " ";
+    }
+    return ans;
+}
+
+}  // namespace
+
+void RunVectorBench() {
+    for (int64_t n : {10, 1000, 100000}) {
+        auto suffix = " n=" + std::to_string(n);
+        auto idx = std::to_string(n - 1);
+
+        // Parse once, evaluate repeatedly: the literal is shared, only the access is measured.
+        auto list_ref = ReadString("(list-ref '(" + Range(n) + ") " + idx + ")");
+        auto vector_ref = ReadString("(vector-ref #(" + Range(n) + ") " + idx + ")");
+        int64_t iters = 10000000 / n + 100;
+        Measure("list-ref last" + suffix, iters, [&] { EvalExpr(list_ref); });
+        Measure("vector-ref last" + suffix, iters, [&] { EvalExpr(vector_ref); });
+
+        auto list = *EvalExpr(ReadString("'(" + Range(n) + ")"));
+        auto vector = As<Vector>(*EvalExpr(ReadString("#(" + Range(n) + ")")));
+        int64_t sum = 0;
+        Measure("list iteration" + suffix, iters, [&] {
+            for (auto curr = list; curr; curr = As<Cell>(curr)->GetSecond()) {
+                sum += As<Number>(As<Cell>(curr)->GetFirst())->GetValue();
+            }
+        });
+        Measure("vector iteration" + suffix, iters, [&] {
+            for (size_t i = 0; i < vector->Size(); ++i) {
+                sum += As<Number>(vector->Get(i))->GetValue();
+            }
+        });
+        if (sum == 42) {
+            std::cout << std::endl;
+        }
+    }
+}
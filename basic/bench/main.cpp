@@ -0,0 +1,15 @@
+#include "bench.h"
+
+int main() {
+    RunVectorBench();
+    RunInterpreterBench();
+    RunHeapBench();
+    RunBignumBench();
+    RunStringBench();
+    RunHashBench();
+    RunMapBench();
+    RunBytevectorBench();
+    RunRecordBench();
+    RunEngineBench();
+    return 0;
+}
@@ -0,0 +1,356 @@
+#include "bigint.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Below this many limbs in the shorter operand schoolbook multiplication is faster.
+constexpr size_t kKaratsubaThreshold = 32;
+
+constexpr uint32_t kDecimalBase = 1000000000;
+constexpr int kDecimalDigits = 9;
+
+}  // namespace
+
+BigInt::BigInt(int64_t value) : negative_(value < 0), limbs_() {
+    uint64_t abs = negative_ ? ~static_cast<uint64_t>(value) + 1 : static_cast<uint64_t>(value);
+    while (abs) {
+        limbs_.push_back(static_cast<uint32_t>(abs));
+        abs >>= 32;
+    }
+}
+
+BigInt::BigInt(bool negative, Limbs limbs) : negative_(negative), limbs_(std::move(limbs)) {
+    Trim(&limbs_);
+    if (limbs_.empty()) {
+        negative_ = false;
+    }
+}
+
+BigInt BigInt::FromString(const std::string& str) {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < str.size() && (str[pos] == '-' || str[pos] == '+')) {
+        negative = str[pos] == '-';
+        ++pos;
+    }
+    Limbs limbs;
+    // Consume the digits in groups of nine, so that every step is one multiply-add by 10^9.
+    size_t first = (str.size() - pos) % kDecimalDigits;
+    if (first == 0) {
+        first = kDecimalDigits;
+    }
+    while (pos < str.size()) {
+        uint32_t chunk = 0;
+        uint32_t scale = 1;
+        for (size_t i = 0; i < first; ++i, ++pos) {
+            chunk = chunk * 10 + (str[pos] - '0');
+            scale *= 10;
+        }
+        first = kDecimalDigits;
+        uint64_t carry = chunk;
+        for (auto& limb : limbs) {
+            uint64_t cur = static_cast<uint64_t>(limb) * scale + carry;
+            limb = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        if (carry) {
+            limbs.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+    return BigInt(negative, std::move(limbs));
+}
+
+std::string BigInt::ToString() const {
+    if (limbs_.empty()) {
+        return "0";
+    }
+    Limbs rest = limbs_;
+    std::vector<uint32_t> chunks;
+    while (!rest.empty()) {
+        chunks.push_back(DivModSmall(&rest, kDecimalBase));
+    }
+    std::string ans = negative_ ? "-" : "";
+    ans += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i > 0; --i) {
+        auto digits = std::to_string(chunks[i - 1]);
+        ans.append(kDecimalDigits - digits.size(), '0');
+        ans += digits;
+    }
+    return ans;
+}
+
+bool BigInt::FitsInt64() const {
+    if (limbs_.size() <= 1) {
+        return true;
+    }
+    if (limbs_.size() > 2) {
+        return false;
+    }
+    uint64_t abs = (static_cast<uint64_t>(limbs_[1]) << 32) | limbs_[0];
+    return abs <= (negative_ ? uint64_t(1) << 63 : (uint64_t(1) << 63) - 1);
+}
+
+int64_t BigInt::ToInt64() const {
+    uint64_t abs = 0;
+    for (size_t i = limbs_.size(); i > 0; --i) {
+        abs = (abs << 32) | limbs_[i - 1];
+    }
+    return static_cast<int64_t>(negative_ ? ~abs + 1 : abs);
+}
+
+double BigInt::ToDouble() const {
+    // The top three limbs hold more bits than a double keeps; the rest only shift the exponent.
+    double ans = 0;
+    size_t low = limbs_.size() > 3 ? limbs_.size() - 3 : 0;
+    for (size_t i = limbs_.size(); i > low; --i) {
+        ans = ans * 4294967296.0 + limbs_[i - 1];
+    }
+    ans = std::ldexp(ans, static_cast<int>(std::min<size_t>(low * 32, 1 << 20)));
+    return negative_ ? -ans : ans;
+}
+
+size_t BigInt::Hash() const {
+    uint64_t ans = negative_;
+    for (uint32_t limb : limbs_) {
+        ans = (ans ^ limb) * 0x100000001b3;
+    }
+    return ans;
+}
+
+BigInt BigInt::operator-() const {
+    return BigInt(!negative_, limbs_);
+}
+
+int Compare(const BigInt& a, const BigInt& b) {
+    if (a.negative_ != b.negative_) {
+        return a.negative_ ? -1 : 1;
+    }
+    int abs = BigInt::CompareAbs(a.limbs_, b.limbs_);
+    return a.negative_ ? -abs : abs;
+}
+
+BigInt operator+(const BigInt& a, const BigInt& b) {
+    if (a.negative_ == b.negative_) {
+        return BigInt(a.negative_, BigInt::AddAbs(a.limbs_, b.limbs_));
+    }
+    if (BigInt::CompareAbs(a.limbs_, b.limbs_) >= 0) {
+        return BigInt(a.negative_, BigInt::SubAbs(a.limbs_, b.limbs_));
+    }
+    return BigInt(b.negative_, BigInt::SubAbs(b.limbs_, a.limbs_));
+}
+
+BigInt operator-(const BigInt& a, const BigInt& b) {
+    return a + (-b);
+}
+
+BigInt operator*(const BigInt& a, const BigInt& b) {
+    return BigInt(a.negative_ != b.negative_, BigInt::MulAbs(a.limbs_, b.limbs_));
+}
+
+BigInt operator/(const BigInt& a, const BigInt& b) {
+    BigInt::Limbs quot, rem;
+    BigInt::DivModAbs(a.limbs_, b.limbs_, &quot, &rem);
+    return BigInt(a.negative_ != b.negative_, std::move(quot));
+}
+
+BigInt operator%(const BigInt& a, const BigInt& b) {
+    BigInt::Limbs quot, rem;
+    BigInt::DivModAbs(a.limbs_, b.limbs_, &quot, &rem);
+    return BigInt(a.negative_, std::move(rem));
+}
+
+BigInt BigInt::MulSchoolbook(const BigInt& a, const BigInt& b) {
+    return BigInt(a.negative_ != b.negative_, MulSchoolbookAbs(a.limbs_, b.limbs_));
+}
+
+int BigInt::CompareAbs(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i > 0; --i) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+BigInt::Limbs BigInt::AddAbs(const Limbs& a, const Limbs& b) {
+    const Limbs& longer = a.size() >= b.size() ? a : b;
+    const Limbs& shorter = a.size() >= b.size() ? b : a;
+    Limbs ans(longer.size() + 1, 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i) {
+        uint64_t cur = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+        ans[i] = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    ans[longer.size()] = static_cast<uint32_t>(carry);
+    Trim(&ans);
+    return ans;
+}
+
+BigInt::Limbs BigInt::SubAbs(const Limbs& a, const Limbs& b) {
+    Limbs ans(a.size(), 0);
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int64_t cur = static_cast<int64_t>(a[i]) - borrow - (i < b.size() ? b[i] : 0);
+        borrow = cur < 0;
+        ans[i] = static_cast<uint32_t>(cur + (borrow << 32));
+    }
+    Trim(&ans);
+    return ans;
+}
+
+BigInt::Limbs BigInt::MulSchoolbookAbs(const Limbs& a, const Limbs& b) {
+    Limbs ans(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) * b[j] + ans[i + j] + carry;
+            ans[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        ans[i + b.size()] = static_cast<uint32_t>(carry);
+    }
+    Trim(&ans);
+    return ans;
+}
+
+BigInt::Limbs BigInt::MulAbs(const Limbs& a, const Limbs& b) {
+    if (a.empty() || b.empty()) {
+        return {};
+    }
+    if (std::min(a.size(), b.size()) < kKaratsubaThreshold) {
+        return MulSchoolbookAbs(a, b);
+    }
+    // a = a1 * B^m + a0, b = b1 * B^m + b0,
+    // a * b = z2 * B^2m + ((a0 + a1)(b0 + b1) - z2 - z0) * B^m + z0.
+    size_t m = std::max(a.size(), b.size()) / 2;
+    auto low = [m](const Limbs& x) {
+        Limbs ans(x.begin(), x.begin() + std::min(m, x.size()));
+        Trim(&ans);
+        return ans;
+    };
+    auto high = [m](const Limbs& x) {
+        return x.size() > m ? Limbs(x.begin() + m, x.end()) : Limbs();
+    };
+    Limbs a0 = low(a), a1 = high(a), b0 = low(b), b1 = high(b);
+    Limbs z0 = MulAbs(a0, b0);
+    Limbs z2 = MulAbs(a1, b1);
+    Limbs z1 = SubAbs(SubAbs(MulAbs(AddAbs(a0, a1), AddAbs(b0, b1)), z2), z0);
+
+    Limbs ans(a.size() + b.size() + 1, 0);
+    auto add_shifted = [&ans](const Limbs& x, size_t shift) {
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < x.size() || carry; ++i) {
+            uint64_t cur = carry + ans[i + shift] + (i < x.size() ? x[i] : 0);
+            ans[i + shift] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+    };
+    add_shifted(z0, 0);
+    add_shifted(z1, m);
+    add_shifted(z2, 2 * m);
+    Trim(&ans);
+    return ans;
+}
+
+uint32_t BigInt::DivModSmall(Limbs* a, uint32_t b) {
+    uint64_t rem = 0;
+    for (size_t i = a->size(); i > 0; --i) {
+        uint64_t cur = (rem << 32) | (*a)[i - 1];
+        (*a)[i - 1] = static_cast<uint32_t>(cur / b);
+        rem = cur % b;
+    }
+    Trim(a);
+    return static_cast<uint32_t>(rem);
+}
+
+// Knuth, TAOCP vol. 2, 4.3.1, Algorithm D.
+void BigInt::DivModAbs(const Limbs& a, const Limbs& b, Limbs* quot, Limbs* rem) {
+    if (CompareAbs(a, b) < 0) {
+        *quot = {};
+        *rem = a;
+        return;
+    }
+    if (b.size() == 1) {
+        *quot = a;
+        uint32_t r = DivModSmall(quot, b[0]);
+        *rem = r ? Limbs{r} : Limbs{};
+        return;
+    }
+    int shift = __builtin_clz(b.back());
+    auto normalize = [shift](const Limbs& x, size_t extra) {
+        Limbs ans(x.size() + extra, 0);
+        for (size_t i = 0; i < x.size(); ++i) {
+            uint64_t cur = static_cast<uint64_t>(x[i]) << shift;
+            ans[i] |= static_cast<uint32_t>(cur);
+            if (i + 1 < ans.size()) {
+                ans[i + 1] = static_cast<uint32_t>(cur >> 32);
+            }
+        }
+        return ans;
+    };
+    Limbs u = normalize(a, 1);
+    Limbs v = normalize(b, 0);
+    size_t n = v.size();
+    size_t m = a.size() - n;
+    Limbs q(m + 1, 0);
+    const uint64_t base = uint64_t(1) << 32;
+    for (size_t j = m + 1; j > 0; --j) {
+        size_t k = j - 1;
+        uint64_t num = (static_cast<uint64_t>(u[k + n]) << 32) | u[k + n - 1];
+        uint64_t qhat = num / v[n - 1];
+        uint64_t rhat = num % v[n - 1];
+        while (qhat >= base || qhat * v[n - 2] > ((rhat << 32) | u[k + n - 2])) {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >= base) {
+                break;
+            }
+        }
+        int64_t borrow = 0;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t p = qhat * v[i] + carry;
+            carry = p >> 32;
+            int64_t t = static_cast<int64_t>(u[i + k]) - borrow - static_cast<uint32_t>(p);
+            u[i + k] = static_cast<uint32_t>(t);
+            borrow = t < 0;
+        }
+        int64_t t = static_cast<int64_t>(u[k + n]) - borrow - static_cast<int64_t>(carry);
+        u[k + n] = static_cast<uint32_t>(t);
+        if (t < 0) {
+            // qhat was one too large: add the divisor back.
+            --qhat;
+            uint64_t c = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t s = static_cast<uint64_t>(u[i + k]) + v[i] + c;
+                u[i + k] = static_cast<uint32_t>(s);
+                c = s >> 32;
+            }
+            u[k + n] += static_cast<uint32_t>(c);
+        }
+        q[k] = static_cast<uint32_t>(qhat);
+    }
+    Trim(&q);
+    *quot = std::move(q);
+    Limbs r(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = (u[i] >> shift) | (shift ? static_cast<uint32_t>(
+                                              static_cast<uint64_t>(u[i + 1]) << (32 - shift))
+                                        : 0);
+    }
+    Trim(&r);
+    *rem = std::move(r);
+}
+
+void BigInt::Trim(Limbs* limbs) {
+    while (!limbs->empty() && limbs->back() == 0) {
+        limbs->pop_back();
+    }
+}
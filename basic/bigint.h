@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Arbitrary-precision integer: sign and magnitude in base 2^32, least significant limb first.
+// Zero has no limbs and is never negative.
+class BigInt {
+public:
+    BigInt() : negative_(false), limbs_() {
+    }
+
+    BigInt(int64_t value);
+
+    // `str` is an optional sign followed by decimal digits.
+    static BigInt FromString(const std::string& str);
+
+    std::string ToString() const;
+
+    bool FitsInt64() const;
+    int64_t ToInt64() const;
+
+    // Nearest double, or an infinity past its range.
+    double ToDouble() const;
+
+    bool IsZero() const {
+        return limbs_.empty();
+    }
+
+    bool IsNegative() const {
+        return negative_;
+    }
+
+    size_t LimbCount() const {
+        return limbs_.size();
+    }
+
+    BigInt operator-() const;
+
+    size_t Hash() const;
+
+    // -1, 0 or 1.
+    friend int Compare(const BigInt& a, const BigInt& b);
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b);
+    friend BigInt operator-(const BigInt& a, const BigInt& b);
+    friend BigInt operator*(const BigInt& a, const BigInt& b);
+
+    // Truncates towards zero like int64_t division. `b` must not be zero.
+    friend BigInt operator/(const BigInt& a, const BigInt& b);
+    friend BigInt operator%(const BigInt& a, const BigInt& b);
+
+    // Plain O(n*m) product, exposed to compare against the Karatsuba path.
+    static BigInt MulSchoolbook(const BigInt& a, const BigInt& b);
+
+private:
+    using Limbs = std::vector<uint32_t>;
+
+    BigInt(bool negative, Limbs limbs);
+
+    static int CompareAbs(const Limbs& a, const Limbs& b);
+    static Limbs AddAbs(const Limbs& a, const Limbs& b);
+    // Requires |a| >= |b|.
+    static Limbs SubAbs(const Limbs& a, const Limbs& b);
+    static Limbs MulSchoolbookAbs(const Limbs& a, const Limbs& b);
+    static Limbs MulAbs(const Limbs& a, const Limbs& b);
+    static void DivModAbs(const Limbs& a, const Limbs& b, Limbs* quot, Limbs* rem);
+    static uint32_t DivModSmall(Limbs* a, uint32_t b);
+    static void Trim(Limbs* limbs);
+
+    bool negative_;
+    Limbs limbs_;
+};
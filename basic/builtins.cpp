@@ -0,0 +1,774 @@
+#include "builtins.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// list-tail and list-ref share the walk; list-ref takes the element it ends at.
+template <bool ref>
+ObjectResult ListTail(ArgSpan args) {
+    if (args.size() != 2) {
+        return Error::Runtime("wrong number of arguments");
+    }
+    if (!Is<Number>(args[1])) {
+        return Error::Runtime("not a number");
+    }
+    auto s = args[0];
+    int64_t index = As<Number>(args[1])->GetValue();
+    if (index < 0) {
+        return Error::Runtime("index out of range");
+    }
+    for (int64_t i = 0; i < index; ++i) {
+        if (!Is<Cell>(s)) {
+            return Error::Runtime("list too short");
+        }
+        s = As<Cell>(s)->GetSecond();
+    }
+    if (!ref) {
+        return s;
+    }
+    if (!Is<Cell>(s)) {
+        return Error::Runtime("list too short");
+    }
+    return As<Cell>(s)->GetFirst();
+}
+
+template <Equivalence mode>
+ObjectResult Equivalent(ArgSpan args) {
+    if (args.size() != 2) {
+        return Error::Runtime("wrong number of arguments");
+    }
+    return Make<Bool>(IsEquivalent(args[0], args[1], mode) ? "#t" : "#f");
+}
+
+// Takes any number of keys (key-value pairs for map-set), applied as one transient batch so that
+// shared paths are copied once.
+template <bool set>
+ObjectResult MapUpdate(ArgSpan args) {
+    if (args.empty() || (set && args.size() % 2 == 0)) {
+        return Error::Runtime("wrong number of arguments");
+    }
+    if (!Is<PersistentMap>(args[0])) {
+        return Error::Runtime("not a map");
+    }
+    PersistentMap::Trie::Transient batch(As<PersistentMap>(args[0])->GetTrie());
+    for (size_t i = 1; i < args.size(); i += set ? 2 : 1) {
+        if (set) {
+            batch.Set(args[i], args[i + 1]);
+        } else {
+            batch.Remove(args[i]);
+        }
+    }
+    return Make<PersistentMap>(batch.Persistent());
+}
+
+void AddListBuiltins(BuiltinRegistry* registry) {
+    registry->Add("pair?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(Is<Cell>(args[0]) ? "#t" : "#f");
+    });
+
+    registry->Add("null?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(!args[0] ? "#t" : "#f");
+    });
+
+    registry->Add("list?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        auto s = args[0];
+        while (Is<Cell>(s)) {
+            s = As<Cell>(s)->GetSecond();
+        }
+        return Make<Bool>(!s ? "#t" : "#f");
+    });
+
+    registry->Add("cons", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Cell>(args[0], args[1]);
+    });
+
+    registry->Add("car", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Cell>(args[0])) {
+            return Error::Runtime("not a pair");
+        }
+        return As<Cell>(args[0])->GetFirst();
+    });
+
+    registry->Add("cdr", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Cell>(args[0])) {
+            return Error::Runtime("not a pair");
+        }
+        return As<Cell>(args[0])->GetSecond();
+    });
+
+    registry->Add("list", [](ArgSpan args) -> ObjectResult {
+        return VectorToList(args);
+    });
+
+    registry->Add("list-tail", ListTail<false>);
+    registry->Add("list-ref", ListTail<true>);
+}
+
+void AddVectorBuiltins(BuiltinRegistry* registry) {
+    registry->Add("vector?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(Is<Vector>(args[0]) ? "#t" : "#f");
+    });
+
+    registry->Add("make-vector", [](ArgSpan args) -> ObjectResult {
+        if (args.empty() || args.size() > 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Number>(args[0]) || As<Number>(args[0])->GetValue() < 0) {
+            return Error::Runtime("size is not a non-negative integer");
+        }
+        auto fill = args.size() == 2 ? args[1] : Make<Bool>("#f");
+        return Make<Vector>(As<Number>(args[0])->GetValue(), fill);
+    });
+
+    registry->Add("vector", [](ArgSpan args) -> ObjectResult {
+        return Make<Vector>(args);
+    });
+
+    registry->Add("vector-length", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Vector>(args[0])) {
+            return Error::Runtime("not a vector");
+        }
+        return Make<Number>(int64_t(As<Vector>(args[0])->Size()));
+    });
+
+    registry->Add("vector-ref", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Vector>(args[0])) {
+            return Error::Runtime("not a vector");
+        }
+        auto vec = As<Vector>(args[0]);
+        SCHEME_TRY(int64_t index, IndexArg(args[1], vec->Size()));
+        return vec->Get(index);
+    });
+
+    registry->Add("vector-set!", [](ArgSpan args) -> ObjectResult {
+        // Returns the vector itself, so that updates can be chained.
+        if (args.size() != 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Vector>(args[0])) {
+            return Error::Runtime("not a vector");
+        }
+        auto vec = As<Vector>(args[0]);
+        SCHEME_TRY(int64_t index, IndexArg(args[1], vec->Size()));
+        vec->Set(index, StoredIn(vec.get(), args[2]));
+        return vec;
+    });
+
+    registry->Add("vector->list", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Vector>(args[0])) {
+            return Error::Runtime("not a vector");
+        }
+        auto vec = As<Vector>(args[0]);
+        std::shared_ptr<Object> ans;
+        for (size_t i = vec->Size(); i > 0; --i) {
+            ans = Make<Cell>(vec->Get(i - 1), ans);
+        }
+        return ans;
+    });
+
+    registry->Add("list->vector", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        SCHEME_TRY(auto elems, ListToVector(args[0]));
+        return Make<Vector>(std::move(elems));
+    });
+}
+
+void AddStringBuiltins(BuiltinRegistry* registry) {
+    registry->Add("string?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(Is<String>(args[0]) ? "#t" : "#f");
+    });
+
+    registry->Add("string-length", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<String>(args[0])) {
+            return Error::Runtime("not a string");
+        }
+        return Make<Number>(int64_t(As<String>(args[0])->Size()));
+    });
+
+    registry->Add("string-append", [](ArgSpan args) -> ObjectResult {
+        auto ans = Make<String>("");
+        for (const auto& arg : args) {
+            if (!Is<String>(arg)) {
+                return Error::Runtime("not a string");
+            }
+            ans = String::Concat(ans, As<String>(arg));
+        }
+        return ans;
+    });
+
+    registry->Add("string-ref", [](ArgSpan args) -> ObjectResult {
+        // There is no character type: the character comes back as a string of length 1.
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<String>(args[0])) {
+            return Error::Runtime("not a string");
+        }
+        auto str = As<String>(args[0]);
+        SCHEME_TRY(int64_t index, IndexArg(args[1], str->Size()));
+        return Make<String>(std::string(1, str->Flat()[index]));
+    });
+
+    registry->Add("substring", [](ArgSpan args) -> ObjectResult {
+        if (args.size() < 2 || args.size() > 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<String>(args[0])) {
+            return Error::Runtime("not a string");
+        }
+        auto str = As<String>(args[0]);
+        SCHEME_TRY(int64_t start, IndexArg(args[1], str->Size() + 1));
+        int64_t end = str->Size();
+        if (args.size() == 3) {
+            SCHEME_TRY(end, IndexArg(args[2], str->Size() + 1));
+        }
+        if (start > end) {
+            return Error::Runtime("start is past end");
+        }
+        return Make<String>(str->Flat().substr(start, end - start));
+    });
+
+    registry->Add("string=?", [](ArgSpan args) -> ObjectResult {
+        if (args.empty()) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        for (const auto& arg : args) {
+            if (!Is<String>(arg)) {
+                return Error::Runtime("not a string");
+            }
+        }
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            auto a = As<String>(args[i]);
+            auto b = As<String>(args[i + 1]);
+            if (a->Size() != b->Size() || a->Flat() != b->Flat()) {
+                return Make<Bool>("#f");
+            }
+        }
+        return Make<Bool>("#t");
+    });
+
+    registry->Add("string-contains", [](ArgSpan args) -> ObjectResult {
+        // Index of the first occurrence of the second string in the first, #f if none.
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<String>(args[0])) {
+            return Error::Runtime("not a string");
+        }
+        if (!Is<String>(args[1])) {
+            return Error::Runtime("not a string");
+        }
+        size_t pos = As<String>(args[0])->Find(As<String>(args[1])->Flat());
+        if (pos == std::string::npos) {
+            return Make<Bool>("#f");
+        }
+        return Make<Number>(int64_t(pos));
+    });
+}
+
+void AddBytevectorBuiltins(BuiltinRegistry* registry) {
+    registry->Add("bytevector?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(Is<Bytevector>(args[0]) ? "#t" : "#f");
+    });
+
+    registry->Add("make-bytevector", [](ArgSpan args) -> ObjectResult {
+        if (args.empty() || args.size() > 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Number>(args[0])) {
+            return Error::Runtime("not a number");
+        }
+        int64_t size = As<Number>(args[0])->GetValue();
+        if (size < 0) {
+            return Error::Runtime("negative size");
+        }
+        uint8_t fill = 0;
+        if (args.size() == 2) {
+            SCHEME_TRY(fill, ByteArg(args[1]));
+        }
+        return Make<Bytevector>(size, fill);
+    });
+
+    registry->Add("bytevector", [](ArgSpan args) -> ObjectResult {
+        std::vector<uint8_t> bytes;
+        for (const auto& arg : args) {
+            SCHEME_TRY(uint8_t byte, ByteArg(arg));
+            bytes.push_back(byte);
+        }
+        return Make<Bytevector>(std::move(bytes));
+    });
+
+    registry->Add("bytevector-length", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Bytevector>(args[0])) {
+            return Error::Runtime("not a bytevector");
+        }
+        return Make<Number>(int64_t(As<Bytevector>(args[0])->Size()));
+    });
+
+    registry->Add("bytevector-u8-ref", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Bytevector>(args[0])) {
+            return Error::Runtime("not a bytevector");
+        }
+        auto bytes = As<Bytevector>(args[0]);
+        SCHEME_TRY(int64_t index, IndexArg(args[1], bytes->Size()));
+        return Make<Number>(int64_t(bytes->Get(index)));
+    });
+
+    registry->Add("bytevector-u8-set!", [](ArgSpan args) -> ObjectResult {
+        // Returns the bytevector, like vector-set!.
+        if (args.size() != 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Bytevector>(args[0])) {
+            return Error::Runtime("not a bytevector");
+        }
+        auto bytes = As<Bytevector>(args[0]);
+        SCHEME_TRY(int64_t index, IndexArg(args[1], bytes->Size()));
+        SCHEME_TRY(uint8_t byte, ByteArg(args[2]));
+        bytes->Set(index, byte);
+        return bytes;
+    });
+
+    registry->Add("bytevector-copy", [](ArgSpan args) -> ObjectResult {
+        if (args.empty() || args.size() > 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Bytevector>(args[0])) {
+            return Error::Runtime("not a bytevector");
+        }
+        auto bytes = As<Bytevector>(args[0]);
+        int64_t start = 0;
+        int64_t end = bytes->Size();
+        if (args.size() > 1) {
+            SCHEME_TRY(start, IndexArg(args[1], bytes->Size() + 1));
+        }
+        if (args.size() > 2) {
+            SCHEME_TRY(end, IndexArg(args[2], bytes->Size() + 1));
+        }
+        if (start > end) {
+            return Error::Runtime("start is past end");
+        }
+        return Make<Bytevector>(bytes->Data() + start, end - start);
+    });
+
+    registry->Add("bytevector-fill!", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Bytevector>(args[0])) {
+            return Error::Runtime("not a bytevector");
+        }
+        SCHEME_TRY(uint8_t byte, ByteArg(args[1]));
+        As<Bytevector>(args[0])->Fill(byte);
+        return args[0];
+    });
+
+    registry->Add("bytevector=?", [](ArgSpan args) -> ObjectResult {
+        if (args.empty()) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        for (const auto& arg : args) {
+            if (!Is<Bytevector>(arg)) {
+                return Error::Runtime("not a bytevector");
+            }
+        }
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            if (!As<Bytevector>(args[i])->Equals(*As<Bytevector>(args[i + 1]))) {
+                return Make<Bool>("#f");
+            }
+        }
+        return Make<Bool>("#t");
+    });
+
+    registry->Add("bytevector-index", [](ArgSpan args) -> ObjectResult {
+        // Index of the first occurrence of a byte at or after an optional start, #f if none.
+        if (args.size() < 2 || args.size() > 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<Bytevector>(args[0])) {
+            return Error::Runtime("not a bytevector");
+        }
+        auto bytes = As<Bytevector>(args[0]);
+        SCHEME_TRY(uint8_t byte, ByteArg(args[1]));
+        int64_t start = 0;
+        if (args.size() == 3) {
+            SCHEME_TRY(start, IndexArg(args[2], bytes->Size() + 1));
+        }
+        size_t pos = bytes->Find(byte, start);
+        if (pos == std::string::npos) {
+            return Make<Bool>("#f");
+        }
+        return Make<Number>(int64_t(pos));
+    });
+}
+
+void AddEquivalenceBuiltins(BuiltinRegistry* registry) {
+    registry->Add("eq?", Equivalent<Equivalence::EQ>);
+    registry->Add("eqv?", Equivalent<Equivalence::EQV>);
+    registry->Add("equal?", Equivalent<Equivalence::EQUAL>);
+
+    registry->Add("not", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (Is<Bool>(args[0]) && !As<Bool>(args[0])->GetVal()) {
+            return Make<Bool>("#t");
+        }
+        return Make<Bool>("#f");
+    });
+}
+
+void AddHashTableBuiltins(BuiltinRegistry* registry) {
+    registry->Add("make-hash-table", [](ArgSpan args) -> ObjectResult {
+        // The equivalence is named by a quoted symbol, equal? by default.
+        if (args.size() > 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        auto mode = Equivalence::EQUAL;
+        if (!args.empty()) {
+            std::string kind = Is<Symbol>(args[0]) ? As<Symbol>(args[0])->GetName() : "";
+            if (kind == "eq?") {
+                mode = Equivalence::EQ;
+            } else if (kind == "eqv?") {
+                mode = Equivalence::EQV;
+            } else if (kind != "equal?") {
+                return Error::Runtime("unknown equivalence " + SerialiseExpr(args[0]));
+            }
+        }
+        return Make<HashTable>(mode);
+    });
+
+    registry->Add("hash-table?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(Is<HashTable>(args[0]) ? "#t" : "#f");
+    });
+
+    registry->Add("hash-table-set!", [](ArgSpan args) -> ObjectResult {
+        // Returns the table, like vector-set!, so that updates can be chained.
+        if (args.size() != 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<HashTable>(args[0])) {
+            return Error::Runtime("not a hash table");
+        }
+        auto table = args[0].get();
+        As<HashTable>(args[0])->Set(StoredIn(table, args[1]), StoredIn(table, args[2]));
+        return args[0];
+    });
+
+    registry->Add("hash-table-ref", [](ArgSpan args) -> ObjectResult {
+        // A missing key is an error unless a default is given.
+        if (args.size() < 2 || args.size() > 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<HashTable>(args[0])) {
+            return Error::Runtime("not a hash table");
+        }
+        auto table = As<HashTable>(args[0]);
+        if (table->Contains(args[1])) {
+            return table->Get(args[1]);
+        }
+        if (args.size() == 3) {
+            return args[2];
+        }
+        return Error::Runtime("key not found");
+    });
+
+    registry->Add("hash-table-delete!", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 2) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<HashTable>(args[0])) {
+            return Error::Runtime("not a hash table");
+        }
+        As<HashTable>(args[0])->Erase(args[1]);
+        return args[0];
+    });
+
+    registry->Add("hash-table-count", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<HashTable>(args[0])) {
+            return Error::Runtime("not a hash table");
+        }
+        return Make<Number>(int64_t(As<HashTable>(args[0])->Size()));
+    });
+}
+
+void AddMapBuiltins(BuiltinRegistry* registry) {
+    registry->Add("make-map", [](ArgSpan args) -> ObjectResult {
+        if (!args.empty()) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<PersistentMap>();
+    });
+
+    registry->Add("map?", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        return Make<Bool>(Is<PersistentMap>(args[0]) ? "#t" : "#f");
+    });
+
+    registry->Add("map-set", MapUpdate<true>);
+    registry->Add("map-remove", MapUpdate<false>);
+
+    registry->Add("map-ref", [](ArgSpan args) -> ObjectResult {
+        // A missing key is an error unless a default is given.
+        if (args.size() < 2 || args.size() > 3) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<PersistentMap>(args[0])) {
+            return Error::Runtime("not a map");
+        }
+        if (const ObjectRef* value = As<PersistentMap>(args[0])->Find(args[1])) {
+            return Load(*value);
+        }
+        if (args.size() == 3) {
+            return args[2];
+        }
+        return Error::Runtime("key not found");
+    });
+
+    registry->Add("map-size", [](ArgSpan args) -> ObjectResult {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<PersistentMap>(args[0])) {
+            return Error::Runtime("not a map");
+        }
+        return Make<Number>(int64_t(As<PersistentMap>(args[0])->Size()));
+    });
+
+    registry->Add("map->list", [](ArgSpan args) -> ObjectResult {
+        // Association list in no particular order.
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (!Is<PersistentMap>(args[0])) {
+            return Error::Runtime("not a map");
+        }
+        std::shared_ptr<Object> ans;
+        As<PersistentMap>(args[0])->ForEach(
+            [&](const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& value) {
+                ans = Make<Cell>(Make<Cell>(key, value), ans);
+            });
+        return ans;
+    });
+}
+
+struct Add {
+    static bool Fixnum(int64_t a, int64_t b, int64_t* c) {
+        return __builtin_add_overflow(a, b, c);
+    }
+    static bool Fold(int64_t init, const int64_t* data, size_t size, int64_t* out) {
+        return SumInt64(init, data, size, out);
+    }
+    static BigInt Big(const BigInt& a, const BigInt& b) {
+        return a + b;
+    }
+    static double Flo(double a, double b) {
+        return a + b;
+    }
+};
+
+struct Sub {
+    static bool Fixnum(int64_t a, int64_t b, int64_t* c) {
+        return __builtin_sub_overflow(a, b, c);
+    }
+    static BigInt Big(const BigInt& a, const BigInt& b) {
+        return a - b;
+    }
+    static double Flo(double a, double b) {
+        return a - b;
+    }
+};
+
+struct Mul {
+    static bool Fixnum(int64_t a, int64_t b, int64_t* c) {
+        return __builtin_mul_overflow(a, b, c);
+    }
+    static BigInt Big(const BigInt& a, const BigInt& b) {
+        return a * b;
+    }
+    static double Flo(double a, double b) {
+        return a * b;
+    }
+};
+
+struct Div {
+    // Division by zero is left to the big path, which reports it.
+    static bool Fixnum(int64_t a, int64_t b, int64_t* c) {
+        if (b == 0 || (a == INT64_MIN && b == -1)) {
+            return true;
+        }
+        *c = a / b;
+        return false;
+    }
+    static Result<BigInt> Big(const BigInt& a, const BigInt& b) {
+        if (b.IsZero()) {
+            return Error::Runtime("division by zero");
+        }
+        return a / b;
+    }
+    static double Flo(double a, double b) {
+        return a / b;
+    }
+};
+
+struct Min {
+    static bool Fixnum(int64_t a, int64_t b, int64_t* c) {
+        *c = std::min(a, b);
+        return false;
+    }
+    static bool Fold(int64_t init, const int64_t* data, size_t size, int64_t* out) {
+        *out = MinInt64(init, data, size);
+        return false;
+    }
+    static BigInt Big(const BigInt& a, const BigInt& b) {
+        return Compare(a, b) <= 0 ? a : b;
+    }
+    static double Flo(double a, double b) {
+        return std::fmin(a, b);
+    }
+};
+
+struct Max {
+    static bool Fixnum(int64_t a, int64_t b, int64_t* c) {
+        *c = std::max(a, b);
+        return false;
+    }
+    static bool Fold(int64_t init, const int64_t* data, size_t size, int64_t* out) {
+        *out = MaxInt64(init, data, size);
+        return false;
+    }
+    static BigInt Big(const BigInt& a, const BigInt& b) {
+        return Compare(a, b) >= 0 ? a : b;
+    }
+    static double Flo(double a, double b) {
+        return std::fmax(a, b);
+    }
+};
+
+struct Abs {
+    static bool Fixnum(int64_t a, int64_t* c) {
+        if (a == INT64_MIN) {
+            return true;
+        }
+        *c = std::abs(a);
+        return false;
+    }
+    static BigInt Big(const BigInt& a) {
+        return a.IsNegative() ? -a : a;
+    }
+    static double Flo(double a) {
+        return std::fabs(a);
+    }
+};
+
+void AddNumberBuiltins(BuiltinRegistry* registry) {
+    registry->Add(std::make_unique<IsNumFunc>("number?"));
+    registry->Add(std::make_unique<IsBoolFunc>("boolean?"));
+
+    registry->Add(std::make_unique<CompareFunc<Chain::EQUAL>>("="));
+    registry->Add(std::make_unique<CompareFunc<Chain::GREATER>>(">"));
+    registry->Add(std::make_unique<CompareFunc<Chain::LESS>>("<"));
+    registry->Add(std::make_unique<CompareFunc<Chain::GREATER_EQUAL>>(">="));
+    registry->Add(std::make_unique<CompareFunc<Chain::LESS_EQUAL>>("<="));
+
+    registry->Add(std::make_unique<ArifmFunc<Add>>("+", 0));
+    registry->Add(std::make_unique<ArifmFunc<Sub>>("-"));
+    registry->Add(std::make_unique<ArifmFunc<Mul>>("*", 1));
+    registry->Add(std::make_unique<ArifmFunc<Div>>("/"));
+    registry->Add(std::make_unique<ArifmFunc<Min>>("min"));
+    registry->Add(std::make_unique<ArifmFunc<Max>>("max"));
+    registry->Add(std::make_unique<OneArgsIntFunc<Abs>>("abs"));
+}
+
+}  // namespace
+
+BuiltinRegistry::BuiltinRegistry() {
+    AddListBuiltins(this);
+    AddVectorBuiltins(this);
+    AddStringBuiltins(this);
+    AddBytevectorBuiltins(this);
+    AddEquivalenceBuiltins(this);
+    AddHashTableBuiltins(this);
+    AddMapBuiltins(this);
+    AddNumberBuiltins(this);
+}
+
+const BuiltinRegistry& BuiltinRegistry::Get() {
+    static const BuiltinRegistry registry;
+    return registry;
+}
+
+void BuiltinRegistry::Add(std::unique_ptr<Function> func) {
+    table_.Insert(func->GetName(), func.get());
+    funcs_.push_back(std::move(func));
+}
+
+void BuiltinRegistry::Add(const std::string& name, BuiltinFunc::Impl impl) {
+    Add(std::make_unique<BuiltinFunc>(name, impl));
+}
+
+Function* BuiltinRegistry::Find(const std::string& name) const {
+    Function* const* func = table_.Find(name);
+    return func ? *func : nullptr;
+}
+
+Function* FindBuiltin(const std::string& name) {
+    return BuiltinRegistry::Get().Find(name);
+}
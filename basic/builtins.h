@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flat_table.h"
+#include "object.h"
+
+// Builtin whose body is a plain function of the evaluated arguments.
+class BuiltinFunc : public Function {
+public:
+    using Impl = ObjectResult (*)(ArgSpan args);
+
+    BuiltinFunc(std::string name, Impl impl) : Function(name), impl_(impl) {
+    }
+
+    ObjectResult Apply(ArgSpan args) {
+        return impl_(args);
+    }
+
+private:
+    Impl impl_;
+};
+
+// Procedures known to every interpreter. They are created once, on first use, and looked up by
+// name with a single probe of a flat hash table. New builtins are added in its constructor.
+class BuiltinRegistry {
+public:
+    BuiltinRegistry(const BuiltinRegistry&) = delete;
+    BuiltinRegistry& operator=(const BuiltinRegistry&) = delete;
+
+    static const BuiltinRegistry& Get();
+
+    void Add(std::unique_ptr<Function> func);
+    void Add(const std::string& name, BuiltinFunc::Impl impl);
+
+    // nullptr if `name` is not a builtin.
+    Function* Find(const std::string& name) const;
+
+private:
+    BuiltinRegistry();
+
+    FlatTable<std::string, Function*, std::hash<std::string>, std::equal_to<std::string>> table_;
+    std::vector<std::unique_ptr<Function>> funcs_;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "resolver.h"
+
+// Instructions of the VM in vm.h, each followed by its operands in the next words. Values are
+// passed on an operand stack; `k` is an index into the constants of the code.
+#define SCHEME_OPCODES(X)                                                                        \
+    /* CONST k: push constants[k]. */                                                            \
+    X(CONST)                                                                                     \
+    /* ARG i: push argument i of the current call. */                                            \
+    X(ARG)                                                                                       \
+    /* CAPTURED i: push value i of those that the closure of the current call captured. */       \
+    X(CAPTURED)                                                                                  \
+    /* GLOBAL g: push the value of the global in slot g. */                                      \
+    X(GLOBAL)                                                                                    \
+    /* DEFINE g: bind the global in slot g to the value on top, which becomes its name. */       \
+    X(DEFINE)                                                                                    \
+    /* BUILTIN k n: apply the builtin constants[k] to the n values on top. */                    \
+    X(BUILTIN)                                                                                   \
+    /* NAMED g n: apply the global in slot g, or the record procedure of that name, to the n */  \
+    /* values on top; looked up when it runs since define may come first. */                     \
+    X(NAMED)                                                                                     \
+    /* TAIL_NAMED g n: same, in place of the current call. */                                    \
+    X(TAIL_NAMED)                                                                                \
+    /* ADD k ... GE k: two fixnums on top, or the builtin constants[k] for anything else. */     \
+    X(ADD)                                                                                       \
+    X(SUB)                                                                                       \
+    X(MUL)                                                                                       \
+    X(EQ)                                                                                        \
+    X(LT)                                                                                        \
+    X(GT)                                                                                        \
+    X(LE)                                                                                        \
+    X(GE)                                                                                        \
+    /* CALL n: apply the value below the n values on top to them. */                             \
+    X(CALL)                                                                                      \
+    /* TAIL_CALL n: same, in place of the current call. */                                       \
+    X(TAIL_CALL)                                                                                 \
+    /* RETURN: end the current call with the value on top. */                                    \
+    X(RETURN)                                                                                    \
+    /* JUMP target: continue at the absolute position `target`. */                               \
+    X(JUMP)                                                                                      \
+    /* JUMP_IF_FALSE target: pop, and jump if the value was #f. */                               \
+    X(JUMP_IF_FALSE)                                                                             \
+    /* AND_JUMP target: jump if the value on top is #f, pop it otherwise. */                     \
+    X(AND_JUMP)                                                                                  \
+    /* OR_JUMP target: jump if the value on top is not #f, pop it otherwise. */                  \
+    X(OR_JUMP)                                                                                   \
+    /* POP: drop the value on top. */                                                            \
+    X(POP)                                                                                       \
+    /* CLOSURE i: push a procedure running lambdas[i], with the values it captures. */           \
+    X(CLOSURE)                                                                                   \
+    /* ENTER i: call lambdas[i] with the values on top, one per parameter, for a lambda */       \
+    /* called right where it is made, so no procedure is allocated for it. */                    \
+    X(ENTER)                                                                                     \
+    /* TAIL_ENTER i: same, in place of the current call. */                                      \
+    X(TAIL_ENTER)                                                                                \
+    /* RECORD k: define-record-type with the arguments constants[k]. */                          \
+    X(RECORD)                                                                                    \
+    /* RAISE i: fail with errors[i]. */                                                          \
+    X(RAISE)
+
+enum class Op : uint32_t {
+#define SCHEME_OPCODE_ENUM(name) name,
+    SCHEME_OPCODES(SCHEME_OPCODE_ENUM)
+#undef SCHEME_OPCODE_ENUM
+};
+
+// The instruction among ADD ... GE for a call of the builtin `name` with two arguments.
+bool FixnumOp(const std::string& name, Op* op);
+
+// Result of ADD ... GE on two fixnums; false if it does not fit, for the builtin to compute
+// instead.
+template <Op op>
+inline bool Fixnum(int64_t a, int64_t b, std::shared_ptr<Object>* value) {
+    if constexpr (op == Op::ADD || op == Op::SUB || op == Op::MUL) {
+#if defined(__GNUC__) || defined(__clang__)
+        int64_t result;
+        bool overflow;
+        if constexpr (op == Op::ADD) {
+            overflow = __builtin_add_overflow(a, b, &result);
+        } else if constexpr (op == Op::SUB) {
+            overflow = __builtin_sub_overflow(a, b, &result);
+        } else {
+            overflow = __builtin_mul_overflow(a, b, &result);
+        }
+        if (overflow) {
+            return false;
+        }
+        *value = Make<Number>(result);
+        return true;
+#else
+        return false;
+#endif
+    } else {
+        bool result;
+        if constexpr (op == Op::EQ) {
+            result = a == b;
+        } else if constexpr (op == Op::LT) {
+            result = a < b;
+        } else if constexpr (op == Op::GT) {
+            result = a > b;
+        } else if constexpr (op == Op::LE) {
+            result = a <= b;
+        } else {
+            result = a >= b;
+        }
+        *value = Make<Bool>(result ? "#t" : "#f");
+        return true;
+    }
+}
+
+// Compiled expression or lambda body. Code that would fail to evaluate compiles to a RAISE at the
+// point where the evaluator would have failed, so compiling never fails itself.
+struct Code {
+    std::vector<uint32_t> ops;
+    std::vector<std::shared_ptr<Object>> constants;
+    std::vector<std::shared_ptr<const Code>> lambdas;
+    std::vector<Error> errors;
+    // For a lambda body, the number of parameters and where the values that its closure captures
+    // are in the code around it.
+    size_t arity = 0;
+    std::vector<Address> captures;
+};
+
+// Compiles `expr` to run with the VM. Builtins, variables and globals are resolved here, so
+// running the code looks up no names except those of record procedures.
+std::shared_ptr<const Code> Compile(const std::shared_ptr<Object>& expr);
+
+// Copy of `code` whose constants, and those of its lambdas, survive the reset of `arena`.
+std::shared_ptr<const Code> Promote(const std::shared_ptr<const Code>& code, Arena* arena);
@@ -0,0 +1,539 @@
+#include "bytecode.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "special_forms.h"
+
+namespace {
+
+// One step of the compilation. The steps wait on a stack rather than in native recursion, so that
+// deeply nested source compiles like any other.
+struct Task {
+    // ENTER compiles the call of the lambda `expr`, whose arguments are on the stack.
+    enum class Kind { EXPR, EMIT, JUMP, LABEL, ENTER, END_LAMBDA };
+
+    static Task Expr(std::shared_ptr<Object> expr, bool tail) {
+        return {Kind::EXPR, std::move(expr), tail, Op::POP, 0, 0, 0};
+    }
+
+    static Task Emit(Op op, size_t operands = 0, uint32_t a = 0, uint32_t b = 0) {
+        return {Kind::EMIT, nullptr, false, op, operands, a, b};
+    }
+
+    static Task Jump(Op op, uint32_t label) {
+        return {Kind::JUMP, nullptr, false, op, 1, label, 0};
+    }
+
+    static Task Label(uint32_t label) {
+        return {Kind::LABEL, nullptr, false, Op::POP, 0, label, 0};
+    }
+
+    Kind kind;
+    std::shared_ptr<Object> expr;
+    // The value of `expr` is the value of the code being compiled.
+    bool tail;
+    Op op;
+    size_t operands;
+    // The operands of `op`; the label for JUMP and LABEL.
+    uint32_t a;
+    uint32_t b;
+};
+
+class Compiler {
+public:
+    std::shared_ptr<const Code> Run(const std::shared_ptr<Object>& expr) {
+        auto code = std::make_shared<Code>();
+        code_ = code.get();
+        if (Symbol* symbol = dynamic_cast<Symbol*>(expr.get())) {
+            // Evaluate leaves a symbol outside of any combination to Symbol::Eval, unless it is a
+            // global.
+            if (FindBuiltin(symbol->GetName())) {
+                EmitRaise(Error::Name(symbol->GetName()));
+            } else {
+                Emit(Op::GLOBAL, 1, CurrentGlobals()->Intern(symbol->GetName()));
+                Emit(Op::RETURN);
+            }
+            return code;
+        }
+        tasks_.push_back(Task::Expr(expr, true));
+        while (!tasks_.empty()) {
+            Task task = std::move(tasks_.back());
+            tasks_.pop_back();
+            switch (task.kind) {
+                case Task::Kind::EXPR:
+                    CompileExpr(task.expr, task.tail);
+                    break;
+                case Task::Kind::EMIT:
+                    Emit(task.op, task.operands, task.a, task.b);
+                    break;
+                case Task::Kind::JUMP:
+                    code_->ops.push_back(static_cast<uint32_t>(task.op));
+                    labels_[task.a].push_back(code_->ops.size());
+                    code_->ops.push_back(0);
+                    break;
+                case Task::Kind::LABEL:
+                    for (size_t fixup : labels_[task.a]) {
+                        code_->ops[fixup] = code_->ops.size();
+                    }
+                    break;
+                case Task::Kind::ENTER:
+                    CompileBody(task.expr, task.tail ? Op::TAIL_ENTER : Op::ENTER, false);
+                    break;
+                case Task::Kind::END_LAMBDA:
+                    code_->captures = resolver_.Leave();
+                    code_ = outer_.back();
+                    outer_.pop_back();
+                    break;
+            }
+        }
+        return code;
+    }
+
+private:
+    void Emit(Op op, size_t operands = 0, uint32_t a = 0, uint32_t b = 0) {
+        code_->ops.push_back(static_cast<uint32_t>(op));
+        if (operands > 0) {
+            code_->ops.push_back(a);
+        }
+        if (operands > 1) {
+            code_->ops.push_back(b);
+        }
+    }
+
+    // Tasks run in the order given.
+    void Schedule(std::vector<Task> tasks) {
+        for (auto it = tasks.rbegin(); it != tasks.rend(); ++it) {
+            tasks_.push_back(std::move(*it));
+        }
+    }
+
+    uint32_t Constant(std::shared_ptr<Object> obj) {
+        code_->constants.push_back(std::move(obj));
+        return code_->constants.size() - 1;
+    }
+
+    uint32_t NewLabel() {
+        labels_.emplace_back();
+        return labels_.size() - 1;
+    }
+
+    Task Raise(Error error) {
+        code_->errors.push_back(std::move(error));
+        return Task::Emit(Op::RAISE, 1, code_->errors.size() - 1);
+    }
+
+    void EmitRaise(Error error) {
+        code_->errors.push_back(std::move(error));
+        Emit(Op::RAISE, 1, code_->errors.size() - 1);
+    }
+
+    // Tasks evaluating the non-empty proper list `body` in order, to the last one's value.
+    std::vector<Task> Sequence(std::shared_ptr<Object> body, bool tail) {
+        std::vector<Task> tasks;
+        for (; body; body = As<Cell>(body)->GetSecond()) {
+            bool last = !As<Cell>(body)->GetSecond();
+            tasks.push_back(Task::Expr(As<Cell>(body)->GetFirst(), tail && last));
+            if (!last) {
+                tasks.push_back(Task::Emit(Op::POP));
+            }
+        }
+        return tasks;
+    }
+
+    static std::shared_ptr<Object> BuiltinValue(Function* func) {
+        // Builtins live as long as the program, so the pointer does not need to own them.
+        return std::shared_ptr<Object>(std::shared_ptr<Object>(), func);
+    }
+
+    void CompileExpr(const std::shared_ptr<Object>& expr, bool tail) {
+        Cell* cell = dynamic_cast<Cell*>(expr.get());
+        if (!cell) {
+            if (!expr) {
+                EmitRaise(Error::Runtime("cannot evaluate ()"));
+                return;
+            }
+            if (Symbol* symbol = dynamic_cast<Symbol*>(expr.get())) {
+                CompileVariable(symbol->GetName());
+            } else {
+                Emit(Op::CONST, 1, Constant(expr));
+            }
+            if (tail) {
+                Emit(Op::RETURN);
+            }
+            return;
+        }
+        auto head = cell->GetFirst();
+        auto args = cell->GetSecond();
+        Symbol* symbol = dynamic_cast<Symbol*>(head.get());
+        if (symbol && FindSpecialForm(symbol->GetName())) {
+            CompileForm(symbol->GetName(), args, tail);
+            return;
+        }
+        auto count = ArgCount(args);
+        if (!count) {
+            EmitRaise(std::move(count.GetError()));
+            return;
+        }
+        Address address;
+        if (symbol && !resolver_.Resolve(symbol->GetName(), &address)) {
+            CompileNamedCall(head, args, *count, tail);
+            return;
+        }
+        std::vector<Task> tasks;
+        auto lambda_args = AppliedLambda(head, *count);
+        if (!lambda_args) {
+            // The operator is a value, evaluated before the arguments.
+            tasks.push_back(Task::Expr(head, false));
+        }
+        for (auto curr = args; curr; curr = As<Cell>(curr)->GetSecond()) {
+            tasks.push_back(Task::Expr(As<Cell>(curr)->GetFirst(), false));
+        }
+        if (lambda_args) {
+            tasks.push_back({Task::Kind::ENTER, std::move(lambda_args), tail, Op::POP, 0, 0, 0});
+        } else {
+            tasks.push_back(Task::Emit(tail ? Op::TAIL_CALL : Op::CALL, 1, *count));
+        }
+        Schedule(std::move(tasks));
+    }
+
+    // The arguments of `head` if it is a well-formed lambda with `count` parameters. Such a
+    // procedure cannot escape the call, so it is entered directly instead of being allocated;
+    // making it first has no effect that could be told apart, whatever the arguments do.
+    static std::shared_ptr<Object> AppliedLambda(const std::shared_ptr<Object>& head,
+                                                 size_t count) {
+        Cell* cell = dynamic_cast<Cell*>(head.get());
+        if (!cell || !Is<Symbol>(cell->GetFirst()) ||
+            As<Symbol>(cell->GetFirst())->GetName() != "lambda") {
+            return nullptr;
+        }
+        auto params = LambdaParams(cell->GetSecond());
+        if (!params || params->size() != count) {
+            return nullptr;
+        }
+        return cell->GetSecond();
+    }
+
+    // For a builtin call with the arguments `args`, the arguments of its only argument if that
+    // is a call of the builtin `name` with `count` arguments.
+    std::shared_ptr<Object> InnerCall(const std::shared_ptr<Object>& args, const char* name,
+                                      size_t count) {
+        if (!Is<Cell>(args) || As<Cell>(args)->GetSecond()) {
+            return nullptr;
+        }
+        auto inner = As<Cell>(args)->GetFirst();
+        Cell* cell = dynamic_cast<Cell*>(inner.get());
+        Address address;
+        if (!cell || !Is<Symbol>(cell->GetFirst()) ||
+            As<Symbol>(cell->GetFirst())->GetName() != name ||
+            resolver_.Resolve(name, &address)) {
+            return nullptr;
+        }
+        auto inner_count = ArgCount(cell->GetSecond());
+        if (!inner_count || *inner_count != count) {
+            return nullptr;
+        }
+        return cell->GetSecond();
+    }
+
+    void CompileVariable(const std::string& name) {
+        Address address;
+        if (resolver_.Resolve(name, &address)) {
+            Emit(address.depth == 0 ? Op::ARG : Op::CAPTURED, 1, address.index);
+        } else if (Function* func = FindBuiltin(name)) {
+            Emit(Op::CONST, 1, Constant(BuiltinValue(func)));
+        } else {
+            Emit(Op::GLOBAL, 1, CurrentGlobals()->Intern(name));
+        }
+    }
+
+    void CompileNamedCall(const std::shared_ptr<Object>& head, std::shared_ptr<Object> args,
+                          size_t count, bool tail) {
+        const std::string& name = As<Symbol>(head)->GetName();
+        std::vector<Task> tasks;
+        if (name == "car" || name == "cdr") {
+            // (car (cons a b)) is a pair that nothing else sees: both halves are evaluated, in
+            // order, and the one asked for is kept instead of a pair being allocated.
+            if (auto pair = InnerCall(args, "cons", 2)) {
+                auto first = Task::Expr(As<Cell>(pair)->GetFirst(), false);
+                auto second = Task::Expr(As<Cell>(As<Cell>(pair)->GetSecond())->GetFirst(), false);
+                if (name == "car") {
+                    tasks = {first, second, Task::Emit(Op::POP)};
+                } else {
+                    tasks = {first, Task::Emit(Op::POP), second};
+                }
+                if (tail) {
+                    tasks.push_back(Task::Emit(Op::RETURN));
+                }
+                Schedule(std::move(tasks));
+                return;
+            }
+        }
+        for (; args; args = As<Cell>(args)->GetSecond()) {
+            tasks.push_back(Task::Expr(As<Cell>(args)->GetFirst(), false));
+        }
+        Op op;
+        if (Function* func = FindBuiltin(name)) {
+            uint32_t k = Constant(BuiltinValue(func));
+            if (count == 2 && FixnumOp(name, &op)) {
+                tasks.push_back(Task::Emit(op, 1, k));
+            } else {
+                tasks.push_back(Task::Emit(Op::BUILTIN, 2, k, count));
+            }
+            if (tail) {
+                tasks.push_back(Task::Emit(Op::RETURN));
+            }
+        } else {
+            uint32_t slot = CurrentGlobals()->Intern(name);
+            tasks.push_back(Task::Emit(tail ? Op::TAIL_NAMED : Op::NAMED, 2, slot, count));
+        }
+        Schedule(std::move(tasks));
+    }
+
+    // The checks and error messages are those of the special forms in special_forms.cpp.
+    void CompileForm(const std::string& name, const std::shared_ptr<Object>& args, bool tail) {
+        if (name == "if") {
+            CompileIf(args, tail);
+        } else if (name == "and" || name == "or") {
+            CompileConnective(args, name == "and", tail);
+        } else if (name == "begin") {
+            if (!FormToVector(args)) {
+                EmitRaise(Error::Syntax("begin: improper list of expressions"));
+            } else if (!args) {
+                EmitRaise(Error::Syntax("begin: expected at least one expression"));
+            } else {
+                Schedule(Sequence(args, tail));
+            }
+        } else if (name == "cond") {
+            CompileCond(args, tail);
+        } else if (name == "lambda") {
+            CompileLambda(args, tail);
+        } else if (name == "define") {
+            CompileDefine(args, tail);
+        } else if (name == "quote") {
+            if (!Is<Cell>(args) || As<Cell>(args)->GetSecond()) {
+                EmitRaise(Error::Syntax("quote: expected one datum"));
+                return;
+            }
+            Emit(Op::CONST, 1, Constant(As<Cell>(args)->GetFirst()));
+            if (tail) {
+                Emit(Op::RETURN);
+            }
+        } else {
+            Emit(Op::RECORD, 1, Constant(args));
+            if (tail) {
+                Emit(Op::RETURN);
+            }
+        }
+    }
+
+    void CompileIf(const std::shared_ptr<Object>& args, bool tail) {
+        auto parts = FormToVector(args);
+        if (!parts) {
+            EmitRaise(std::move(parts.GetError()));
+            return;
+        }
+        if (parts->size() != 2 && parts->size() != 3) {
+            EmitRaise(Error::Syntax("if: expected a test and one or two branches"));
+            return;
+        }
+        uint32_t alternative = NewLabel();
+        std::vector<Task> tasks = {Task::Expr((*parts)[0], false)};
+        if (parts->size() == 2) {
+            // A false test is the value, left on the stack.
+            tasks.push_back(Task::Jump(Op::AND_JUMP, alternative));
+            tasks.push_back(Task::Expr((*parts)[1], tail));
+            tasks.push_back(Task::Label(alternative));
+            if (tail) {
+                tasks.push_back(Task::Emit(Op::RETURN));
+            }
+            Schedule(std::move(tasks));
+            return;
+        }
+        uint32_t end = NewLabel();
+        tasks.push_back(Task::Jump(Op::JUMP_IF_FALSE, alternative));
+        tasks.push_back(Task::Expr((*parts)[1], tail));
+        if (!tail) {
+            tasks.push_back(Task::Jump(Op::JUMP, end));
+        }
+        tasks.push_back(Task::Label(alternative));
+        tasks.push_back(Task::Expr((*parts)[2], tail));
+        tasks.push_back(Task::Label(end));
+        Schedule(std::move(tasks));
+    }
+
+    void CompileConnective(const std::shared_ptr<Object>& args, bool is_and, bool tail) {
+        auto parts = FormToVector(args);
+        if (!parts) {
+            EmitRaise(Error::Syntax(is_and ? "and: improper argument list"
+                                           : "or: improper argument list"));
+            return;
+        }
+        if (parts->empty()) {
+            Emit(Op::CONST, 1, Constant(Make<Bool>(is_and ? "#t" : "#f")));
+            if (tail) {
+                Emit(Op::RETURN);
+            }
+            return;
+        }
+        uint32_t end = NewLabel();
+        std::vector<Task> tasks;
+        for (size_t i = 0; i + 1 < parts->size(); ++i) {
+            tasks.push_back(Task::Expr((*parts)[i], false));
+            tasks.push_back(Task::Jump(is_and ? Op::AND_JUMP : Op::OR_JUMP, end));
+        }
+        tasks.push_back(Task::Expr(parts->back(), tail));
+        tasks.push_back(Task::Label(end));
+        if (tail) {
+            tasks.push_back(Task::Emit(Op::RETURN));
+        }
+        Schedule(std::move(tasks));
+    }
+
+    // Clauses are checked in order, and a malformed one fails only once it is reached.
+    void CompileCond(const std::shared_ptr<Object>& args, bool tail) {
+        auto clauses = FormToVector(args);
+        if (!clauses) {
+            EmitRaise(Error::Syntax("cond: improper list of clauses"));
+            return;
+        }
+        uint32_t end = NewLabel();
+        std::vector<Task> tasks;
+        bool exhaustive = false;
+        for (size_t i = 0; i < clauses->size(); ++i) {
+            const auto& clause = (*clauses)[i];
+            auto parts = FormToVector(clause);
+            if (!parts) {
+                tasks.push_back(Raise(std::move(parts.GetError())));
+                exhaustive = true;
+                break;
+            }
+            if (parts->empty()) {
+                tasks.push_back(Raise(Error::Syntax("cond: empty clause")));
+                exhaustive = true;
+                break;
+            }
+            auto body = As<Cell>(clause)->GetSecond();
+            if (Is<Symbol>((*parts)[0]) && As<Symbol>((*parts)[0])->GetName() == "else") {
+                if (i + 1 != clauses->size() || !body) {
+                    tasks.push_back(Raise(Error::Syntax("cond: misplaced or empty else clause")));
+                } else {
+                    auto sequence = Sequence(body, tail);
+                    tasks.insert(tasks.end(), sequence.begin(), sequence.end());
+                }
+                exhaustive = true;
+                break;
+            }
+            tasks.push_back(Task::Expr((*parts)[0], false));
+            if (!body) {
+                // A clause without expressions yields its test value.
+                tasks.push_back(Task::Jump(Op::OR_JUMP, end));
+                continue;
+            }
+            uint32_t next = NewLabel();
+            tasks.push_back(Task::Jump(Op::JUMP_IF_FALSE, next));
+            auto sequence = Sequence(body, tail);
+            tasks.insert(tasks.end(), sequence.begin(), sequence.end());
+            if (!tail) {
+                tasks.push_back(Task::Jump(Op::JUMP, end));
+            }
+            tasks.push_back(Task::Label(next));
+        }
+        if (!exhaustive) {
+            tasks.push_back(Task::Emit(Op::CONST, 1, Constant(Make<Bool>("#f"))));
+            if (tail) {
+                tasks.push_back(Task::Emit(Op::RETURN));
+            }
+        }
+        tasks.push_back(Task::Label(end));
+        if (tail) {
+            tasks.push_back(Task::Emit(Op::RETURN));
+        }
+        Schedule(std::move(tasks));
+    }
+
+    void CompileDefine(const std::shared_ptr<Object>& args, bool tail) {
+        if (!resolver_.AtTopLevel()) {
+            EmitRaise(Error::Syntax("define: only allowed at top level"));
+            return;
+        }
+        auto definition = DefineParts(args);
+        if (!definition) {
+            EmitRaise(std::move(definition.GetError()));
+            return;
+        }
+        std::vector<Task> tasks = {Task::Expr(definition->value, false),
+                                   Task::Emit(Op::DEFINE, 1,
+                                              CurrentGlobals()->Intern(definition->name))};
+        if (tail) {
+            tasks.push_back(Task::Emit(Op::RETURN));
+        }
+        Schedule(std::move(tasks));
+    }
+
+    void CompileLambda(const std::shared_ptr<Object>& args, bool tail) {
+        if (auto params = LambdaParams(args); !params) {
+            EmitRaise(std::move(params.GetError()));
+            return;
+        }
+        CompileBody(args, Op::CLOSURE, tail);
+    }
+
+    // The body of the lambda with the checked arguments `args` becomes a Code of its own, which
+    // `op` refers to and which is compiled right after it, once `op` is followed by a RETURN if
+    // `ret` is set. The captures of the lambda are known once the body is.
+    void CompileBody(const std::shared_ptr<Object>& args, Op op, bool ret) {
+        auto params = LambdaParams(args);
+        auto body = std::make_shared<Code>();
+        body->arity = params->size();
+        code_->lambdas.push_back(body);
+        Emit(op, 1, code_->lambdas.size() - 1);
+        if (ret) {
+            Emit(Op::RETURN);
+        }
+        outer_.push_back(code_);
+        code_ = body.get();
+        resolver_.Enter(std::move(*params));
+        tasks_.push_back({Task::Kind::END_LAMBDA, nullptr, false, Op::POP, 0, 0, 0});
+        Schedule(Sequence(As<Cell>(args)->GetSecond(), true));
+    }
+
+    Code* code_ = nullptr;
+    std::vector<Task> tasks_;
+    // The positions of the jumps waiting for each label.
+    std::vector<std::vector<size_t>> labels_;
+    // The code of the enclosing lambdas, innermost last.
+    std::vector<Code*> outer_;
+    Resolver resolver_;
+};
+
+}  // namespace
+
+bool FixnumOp(const std::string& name, Op* op) {
+    static const std::pair<const char*, Op> kOps[] = {
+        {"+", Op::ADD}, {"-", Op::SUB}, {"*", Op::MUL}, {"=", Op::EQ},
+        {"<", Op::LT},  {">", Op::GT},  {"<=", Op::LE}, {">=", Op::GE}};
+    for (const auto& [op_name, op_code] : kOps) {
+        if (name == op_name) {
+            *op = op_code;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<const Code> Compile(const std::shared_ptr<Object>& expr) {
+    return Compiler().Run(expr);
+}
+
+std::shared_ptr<const Code> Promote(const std::shared_ptr<const Code>& code, Arena* arena) {
+    auto copy = std::make_shared<Code>(*code);
+    for (auto& constant : copy->constants) {
+        constant = Promote(constant, arena);
+    }
+    for (auto& lambda : copy->lambdas) {
+        lambda = Promote(lambda, arena);
+    }
+    return copy;
+}
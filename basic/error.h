@@ -1,6 +1,10 @@
 #pragma once
 
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
 
 struct SyntaxError : public std::runtime_error {
     using std::runtime_error::runtime_error;
@@ -13,3 +17,127 @@ struct RuntimeError : public std::runtime_error {
 struct NameError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
+
+// Failure that the tokenizer, the reader and the evaluator pass back as a value. It becomes one
+// of the exceptions above only at the public API boundary.
+struct Error {
+    enum class Kind { SYNTAX, RUNTIME, NAME };
+
+    static Error Syntax(std::string message) {
+        return {Kind::SYNTAX, std::move(message)};
+    }
+
+    static Error Runtime(std::string message) {
+        return {Kind::RUNTIME, std::move(message)};
+    }
+
+    static Error Name(std::string message) {
+        return {Kind::NAME, std::move(message)};
+    }
+
+    Kind kind;
+    std::string message;
+};
+
+[[noreturn]] inline void Raise(const Error& error) {
+    switch (error.kind) {
+        case Error::Kind::SYNTAX:
+            throw SyntaxError(error.message);
+        case Error::Kind::RUNTIME:
+            throw RuntimeError(error.message);
+        case Error::Kind::NAME:
+            throw NameError(error.message);
+    }
+    throw RuntimeError(error.message);
+}
+
+// A T or the Error that prevented computing it, in the manner of C++23 std::expected.
+template <class T>
+class Result {
+public:
+    template <class U>
+        requires std::is_convertible_v<U&&, T>
+    Result(U&& value) : data_(std::in_place_index<0>, std::forward<U>(value)) {
+    }
+
+    Result(Error error) : data_(std::in_place_index<1>, std::move(error)) {
+    }
+
+    explicit operator bool() const {
+        return data_.index() == 0;
+    }
+
+    T& operator*() {
+        return std::get<0>(data_);
+    }
+
+    T* operator->() {
+        return &std::get<0>(data_);
+    }
+
+    Error& GetError() {
+        return std::get<1>(data_);
+    }
+
+    // The value, or the error thrown as its exception type.
+    T ValueOrRaise() && {
+        if (data_.index() == 1) {
+            Raise(std::get<1>(data_));
+        }
+        return std::move(std::get<0>(data_));
+    }
+
+private:
+    std::variant<T, Error> data_;
+};
+
+// Success with no value, or an Error.
+template <>
+class Result<void> {
+public:
+    Result() : error_() {
+    }
+
+    Result(Error error) : error_(std::move(error)) {
+    }
+
+    explicit operator bool() const {
+        return error_.index() == 0;
+    }
+
+    Error& GetError() {
+        return std::get<1>(error_);
+    }
+
+    void ValueOrRaise() && {
+        if (error_.index() == 1) {
+            Raise(std::get<1>(error_));
+        }
+    }
+
+private:
+    std::variant<std::monostate, Error> error_;
+};
+
+#define SCHEME_CONCAT_IMPL(a, b) a##b
+#define SCHEME_CONCAT(a, b) SCHEME_CONCAT_IMPL(a, b)
+
+// `SCHEME_TRY(auto x, expr);` evaluates the Result `expr` and either moves its value into `x` or
+// returns its error from the enclosing function.
+#define SCHEME_TRY(decl, expr) SCHEME_TRY_IMPL(SCHEME_CONCAT(try_result_, __LINE__), decl, expr)
+#define SCHEME_TRY_IMPL(result, decl, expr)  \
+    auto result = (expr);                    \
+    if (!result) {                           \
+        return std::move(result.GetError()); \
+    }                                        \
+    decl = std::move(*result)
+
+// `SCHEME_CHECK(expr);` returns the error of the Result<void> `expr`, if any.
+#define SCHEME_CHECK(expr) SCHEME_CHECK_IMPL(SCHEME_CONCAT(check_result_, __LINE__), expr)
+#define SCHEME_CHECK_IMPL(result, expr)          \
+    do {                                         \
+        auto result = (expr);                    \
+        if (!result) {                           \
+            return std::move(result.GetError()); \
+        }                                        \
+    } while (false)
@@ -0,0 +1,272 @@
+#include "eval.h"
+
+#include <string>
+#include <vector>
+
+#include "arg_stack.h"
+#include "special_forms.h"
+
+namespace {
+
+// Step that is waiting for the value of a subexpression: either a procedure call that is
+// evaluating its arguments, or a special form that resumes with the value. Either one continues in
+// the environment it was started in.
+struct Frame {
+    Frame(std::shared_ptr<Object> head, std::shared_ptr<Object> rest, size_t count,
+          std::shared_ptr<Environment> env)
+        : head(std::move(head)),
+          rest(std::move(rest)),
+          resume(nullptr),
+          args(count),
+          next(0),
+          env(std::move(env)) {
+    }
+
+    Frame(FormStep::Resume resume, std::shared_ptr<Object> state, std::shared_ptr<Environment> env)
+        : rest(std::move(state)), resume(resume), args(0), next(0), env(std::move(env)) {
+    }
+
+    // The symbol naming the procedure, or null if the procedure is the value in the first argument
+    // slot.
+    std::shared_ptr<Object> head;
+    // Arguments still to be evaluated, or the state of the special form.
+    std::shared_ptr<Object> rest;
+    FormStep::Resume resume;
+    ArgFrame args;
+    size_t next;
+    std::shared_ptr<Environment> env;
+};
+
+class Evaluator {
+public:
+    static Evaluator& Get() {
+        thread_local Evaluator evaluator;
+        return evaluator;
+    }
+
+    // Evaluations may nest, e.g. through Cell::Eval; each one starts in the null environment and
+    // only unwinds its own frames.
+    ObjectResult Run(std::shared_ptr<Object> head, std::shared_ptr<Object> tail, size_t limit) {
+        size_t base = frames_.size();
+        auto env = std::move(env_);
+        auto result = Loop(std::move(head), std::move(tail), base, base + limit);
+        // One at a time, newest first, as the argument frames have to be popped in that order.
+        while (frames_.size() > base) {
+            frames_.pop_back();
+        }
+        env_ = std::move(env);
+        return result;
+    }
+
+private:
+    ObjectResult Loop(std::shared_ptr<Object> head, std::shared_ptr<Object> tail, size_t base,
+                      size_t limit) {
+        std::shared_ptr<Object> expr;
+        std::shared_ptr<Object> value;
+        while (true) {
+            // Start the combination (head . tail): either `value` is known or `expr` is next.
+            Symbol* symbol = dynamic_cast<Symbol*>(head.get());
+            bool has_value = false;
+            if (SpecialForm form = symbol ? FindSpecialForm(symbol->GetName()) : nullptr) {
+                SCHEME_TRY(FormStep step, form(tail, env_));
+                has_value = Take(std::move(step), &expr, &value);
+            } else {
+                SCHEME_TRY(size_t count, ArgCount(tail));
+                // A global called with no arguments has nothing to be looked up after, so it is
+                // evaluated as the operator right away.
+                if (symbol && !(env_ && env_->Find(symbol->GetName())) &&
+                    (count > 0 || !FindGlobal(symbol->GetName()))) {
+                    if (count == 0) {
+                        SCHEME_TRY(value, ApplyByName(symbol->GetName(), {}));
+                        has_value = true;
+                    } else {
+                        auto cell = As<Cell>(tail);
+                        frames_.emplace_back(std::move(head), cell->GetSecond(), count, env_);
+                        expr = cell->GetFirst();
+                    }
+                } else {
+                    // The operator is evaluated like the arguments, into the first slot.
+                    frames_.emplace_back(nullptr, std::move(tail), count + 1, env_);
+                    expr = std::move(head);
+                }
+            }
+
+            // Evaluate `expr` or hand `value` to the newest frame until another combination
+            // has to be started.
+            while (true) {
+                if (frames_.size() > limit) {
+                    return Error::Runtime("maximum evaluation depth exceeded");
+                }
+                if (!has_value) {
+                    if (!expr) {
+                        return Error::Runtime("cannot evaluate ()");
+                    }
+                    if (Cell* cell = dynamic_cast<Cell*>(expr.get())) {
+                        head = cell->GetFirst();
+                        tail = cell->GetSecond();
+                        break;
+                    }
+                    if (Symbol* symbol = dynamic_cast<Symbol*>(expr.get())) {
+                        SCHEME_TRY(value, Lookup(symbol->GetName()));
+                    } else {
+                        SCHEME_TRY(value, expr->Eval());
+                    }
+                }
+                if (frames_.size() == base) {
+                    return value;
+                }
+                Frame& top = frames_.back();
+                if (top.resume) {
+                    auto resume = top.resume;
+                    auto state = std::move(top.rest);
+                    env_ = std::move(top.env);
+                    frames_.pop_back();
+                    SCHEME_TRY(FormStep step, resume(state, std::move(value)));
+                    has_value = Take(std::move(step), &expr, &value);
+                    continue;
+                }
+                top.args[top.next++] = std::move(value);
+                if (top.rest) {
+                    auto cell = As<Cell>(top.rest);
+                    expr = cell->GetFirst();
+                    top.rest = cell->GetSecond();
+                    if (env_ != top.env) {
+                        env_ = top.env;
+                    }
+                    has_value = false;
+                    continue;
+                }
+                const std::shared_ptr<Object>* callee;
+                ArgSpan args;
+                if (top.head) {
+                    // A global is looked up once the arguments are evaluated, like a record
+                    // procedure.
+                    const auto& name = static_cast<Symbol*>(top.head.get())->GetName();
+                    callee = FindGlobal(name);
+                    if (!callee) {
+                        auto result = ApplyByName(name, top.args.Args());
+                        frames_.pop_back();
+                        SCHEME_TRY(value, std::move(result));
+                        has_value = true;
+                        continue;
+                    }
+                    args = top.args.Args();
+                } else {
+                    callee = &top.args[0];
+                    args = top.args.Args().subspan(1);
+                }
+                if (Closure* closure = dynamic_cast<Closure*>(callee->get())) {
+                    // A tail call: the body replaces the call, so the caller's frame is gone
+                    // before the body starts and a loop of calls runs in constant space.
+                    if (args.size() != closure->GetArity()) {
+                        return Error::Runtime("procedure expects " +
+                                              std::to_string(closure->GetArity()) +
+                                              " arguments, got " + std::to_string(args.size()));
+                    }
+                    auto env = Make<Environment>(closure->GetParams(), args, closure->GetEnv());
+                    auto body = closure->GetBody();
+                    frames_.pop_back();
+                    env_ = std::move(env);
+                    SCHEME_TRY(FormStep step, Sequence(body));
+                    has_value = Take(std::move(step), &expr, &value);
+                    continue;
+                }
+                if (Function* func = dynamic_cast<Function*>(callee->get())) {
+                    auto result = WithName(func->Apply(args), func->GetName());
+                    frames_.pop_back();
+                    SCHEME_TRY(value, std::move(result));
+                    has_value = true;
+                    continue;
+                }
+                return Error::Runtime("cannot apply " + SerialiseExpr(*callee));
+            }
+        }
+    }
+
+    // Variables of the current environment shadow the builtins and the globals, which are values
+    // as well.
+    ObjectResult Lookup(const std::string& name) {
+        if (env_) {
+            if (const std::shared_ptr<Object>* value = env_->Find(name)) {
+                return *value;
+            }
+        }
+        if (Function* func = FindBuiltin(name)) {
+            // Builtins live as long as the program, so the pointer does not need to own them.
+            return std::shared_ptr<Object>(std::shared_ptr<Object>(), func);
+        }
+        if (const std::shared_ptr<Object>* value = FindGlobal(name)) {
+            return *value;
+        }
+        return Error::Name(name);
+    }
+
+    static const std::shared_ptr<Object>* FindGlobal(const std::string& name) {
+        GlobalRegistry* globals = CurrentGlobals();
+        return globals ? globals->Find(name) : nullptr;
+    }
+
+    // Sets `value` and returns true if the form is done; otherwise sets the next `expr`.
+    bool Take(FormStep step, std::shared_ptr<Object>* expr, std::shared_ptr<Object>* value) {
+        switch (step.kind) {
+            case FormStep::Kind::VALUE:
+                *value = std::move(step.object);
+                return true;
+            case FormStep::Kind::THEN:
+                frames_.emplace_back(step.resume, std::move(step.state), env_);
+                [[fallthrough]];
+            case FormStep::Kind::EVAL:
+                *expr = std::move(step.object);
+                return false;
+        }
+        return false;
+    }
+
+    std::vector<Frame> frames_;
+    // Where variables of the expression being evaluated are looked up.
+    std::shared_ptr<Environment> env_;
+};
+
+}  // namespace
+
+ObjectResult WithName(ObjectResult result, const std::string& name) {
+    if (!result) {
+        result.GetError().message = name + ": " + result.GetError().message;
+    }
+    return result;
+}
+
+ObjectResult ApplyByName(const std::string& name, ArgSpan args) {
+    if (Function* func = FindBuiltin(name)) {
+        return WithName(func->Apply(args), name);
+    }
+    if (CurrentRecords()) {
+        if (const RecordProc* proc = CurrentRecords()->FindProc(name)) {
+            return WithName(ApplyRecordProc(*proc, args), name);
+        }
+    }
+    return Error::Name(name);
+}
+
+ObjectResult Evaluate(const std::shared_ptr<Object>& expr, size_t depth_limit) {
+    if (!expr) {
+        return Error::Runtime("cannot evaluate ()");
+    }
+    if (Cell* cell = dynamic_cast<Cell*>(expr.get())) {
+        return Evaluator::Get().Run(cell->GetFirst(), cell->GetSecond(), depth_limit);
+    }
+    if (Symbol* symbol = dynamic_cast<Symbol*>(expr.get()); symbol && CurrentGlobals()) {
+        if (const std::shared_ptr<Object>* value = CurrentGlobals()->Find(symbol->GetName())) {
+            return *value;
+        }
+    }
+    return expr->Eval();
+}
+
+ObjectResult EvalExpr(const std::shared_ptr<Object>& obj) {
+    return Evaluate(obj, kDefaultEvalDepthLimit);
+}
+
+ObjectResult EvalCall(const std::shared_ptr<Object>& head, const std::shared_ptr<Object>& tail) {
+    return Evaluator::Get().Run(head, tail, kDefaultEvalDepthLimit);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "object.h"
+
+// Nesting depth at which evaluation fails unless the interpreter sets another limit.
+constexpr size_t kDefaultEvalDepthLimit = 1 << 20;
+
+// Evaluates `expr` with a loop over an explicit stack of pending steps, so nesting costs heap
+// memory instead of native stack. Fails with a runtime error once more than `depth_limit` steps
+// are pending. The empty list is represented by nullptr, and it is not self-evaluating.
+ObjectResult Evaluate(const std::shared_ptr<Object>& expr, size_t depth_limit);
+
+// Prefixes the error of a failed call with the name of the procedure.
+ObjectResult WithName(ObjectResult result, const std::string& name);
+
+// Applies the builtin or the record procedure called `name`; a name error if there is none.
+ObjectResult ApplyByName(const std::string& name, ArgSpan args);
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Open-addressing hash map with one control byte per slot. The control bytes of a group of 16
+// slots are matched against the 7 low bits of the hash at once, so a lookup compares full keys
+// only for likely hits and stops at the first group that has an empty slot.
+template <class Key, class Value, class Hash, class Eq>
+class FlatTable {
+public:
+    FlatTable(Hash hash = Hash(), Eq eq = Eq()) : hash_(hash), eq_(eq), size_(0), deleted_(0) {
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    Value* Find(const Key& key) {
+        return const_cast<Value*>(std::as_const(*this).Find(key));
+    }
+
+    const Value* Find(const Key& key) const {
+        if (size_ == 0) {
+            return nullptr;
+        }
+        size_t slot = FindSlot(key, hash_(key));
+        return slot == kNotFound ? nullptr : &slots_[slot].value;
+    }
+
+    // Inserts `key` or overwrites its value.
+    void Insert(const Key& key, Value value) {
+        size_t hash = hash_(key);
+        size_t slot = size_ ? FindSlot(key, hash) : kNotFound;
+        if (slot != kNotFound) {
+            slots_[slot].value = std::move(value);
+            return;
+        }
+        if ((size_ + deleted_ + 1) * 8 > Capacity() * 7) {
+            Rehash(size_ * 2 + 1 > Capacity() * 7 / 8 ? Capacity() * 2 : Capacity());
+        }
+        slot = FreeSlot(hash);
+        deleted_ -= ctrl_[slot] == kDeleted;
+        ctrl_[slot] = H2(hash);
+        slots_[slot] = {key, std::move(value)};
+        ++size_;
+    }
+
+    bool Erase(const Key& key) {
+        if (size_ == 0) {
+            return false;
+        }
+        size_t slot = FindSlot(key, hash_(key));
+        if (slot == kNotFound) {
+            return false;
+        }
+        // No probe has gone past a group with an empty slot, so this one can become empty too.
+        if (MatchEmpty(&ctrl_[slot & ~(kGroupSize - 1)])) {
+            ctrl_[slot] = kEmpty;
+        } else {
+            ctrl_[slot] = kDeleted;
+            ++deleted_;
+        }
+        slots_[slot] = {};
+        --size_;
+        return true;
+    }
+
+    template <class F>
+    void ForEach(F&& f) const {
+        for (size_t i = 0; i < ctrl_.size(); ++i) {
+            if (ctrl_[i] >= 0) {
+                f(slots_[i].key, slots_[i].value);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kGroupSize = 16;
+    static constexpr size_t kNotFound = size_t(-1);
+    static constexpr int8_t kEmpty = -128;
+    static constexpr int8_t kDeleted = -2;
+
+    struct Slot {
+        Key key;
+        Value value;
+    };
+
+    size_t Capacity() const {
+        return ctrl_.size();
+    }
+
+    static int8_t H2(size_t hash) {
+        return static_cast<int8_t>(hash & 0x7f);
+    }
+
+    // Groups are visited in triangular order, which covers all of them for a power of two count.
+    size_t FirstGroup(size_t hash) const {
+        return (hash >> 7) & (Capacity() / kGroupSize - 1);
+    }
+
+    static uint32_t Match(const int8_t* group, int8_t h2) {
+#ifdef __SSE2__
+        auto ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            mask |= uint32_t(group[i] == h2) << i;
+        }
+        return mask;
+#endif
+    }
+
+    static uint32_t MatchEmpty(const int8_t* group) {
+        return Match(group, kEmpty);
+    }
+
+    // Empty and deleted bytes are the only negative ones.
+    static uint32_t MatchFree(const int8_t* group) {
+#ifdef __SSE2__
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; ++i) {
+            mask |= uint32_t(group[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+
+    size_t FindSlot(const Key& key, size_t hash) const {
+        size_t groups_mask = Capacity() / kGroupSize - 1;
+        size_t group = FirstGroup(hash);
+        for (size_t step = 1;; ++step) {
+            const int8_t* ctrl = &ctrl_[group * kGroupSize];
+            for (uint32_t mask = Match(ctrl, H2(hash)); mask; mask &= mask - 1) {
+                size_t slot = group * kGroupSize + __builtin_ctz(mask);
+                if (eq_(slots_[slot].key, key)) {
+                    return slot;
+                }
+            }
+            if (MatchEmpty(ctrl) || step > groups_mask) {
+                return kNotFound;
+            }
+            group = (group + step) & groups_mask;
+        }
+    }
+
+    size_t FreeSlot(size_t hash) const {
+        size_t groups_mask = Capacity() / kGroupSize - 1;
+        size_t group = FirstGroup(hash);
+        for (size_t step = 1;; ++step) {
+            if (uint32_t mask = MatchFree(&ctrl_[group * kGroupSize])) {
+                return group * kGroupSize + __builtin_ctz(mask);
+            }
+            group = (group + step) & groups_mask;
+        }
+    }
+
+    void Rehash(size_t capacity) {
+        capacity = capacity < kGroupSize ? kGroupSize : capacity;
+        std::vector<int8_t> old_ctrl(capacity, kEmpty);
+        std::vector<Slot> old_slots(capacity);
+        old_ctrl.swap(ctrl_);
+        old_slots.swap(slots_);
+        deleted_ = 0;
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+            if (old_ctrl[i] >= 0) {
+                size_t hash = hash_(old_slots[i].key);
+                size_t slot = FreeSlot(hash);
+                ctrl_[slot] = H2(hash);
+                slots_[slot] = std::move(old_slots[i]);
+            }
+        }
+    }
+
+    Hash hash_;
+    Eq eq_;
+    std::vector<int8_t> ctrl_;
+    std::vector<Slot> slots_;
+    size_t size_;
+    size_t deleted_;
+};
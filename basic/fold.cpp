@@ -0,0 +1,416 @@
+#include "fold.h"
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "arg_stack.h"
+#include "flat_table.h"
+#include "special_forms.h"
+
+namespace {
+
+// The builtin called `name` if its value depends on its arguments alone and it changes none of
+// them, nullptr otherwise.
+Function* FindPure(const std::string& name) {
+    using Table =
+        FlatTable<std::string, Function*, std::hash<std::string>, std::equal_to<std::string>>;
+    static const Table table = [] {
+        Table table;
+        for (const char* name :
+             {"+", "-", "*", "/", "min", "max", "abs", "=", "<", ">", "<=", ">=", "not",
+              "number?", "boolean?", "pair?", "null?", "list?", "vector?", "string?",
+              "bytevector?", "hash-table?", "map?", "eq?", "eqv?", "equal?", "string-length",
+              "string=?", "vector-length", "bytevector-length", "bytevector=?"}) {
+            table.Insert(name, FindBuiltin(name));
+        }
+        return table;
+    }();
+    Function* const* func = table.Find(name);
+    return func ? *func : nullptr;
+}
+
+bool IsSymbol(const std::shared_ptr<Object>& obj, const char* name) {
+    Symbol* symbol = dynamic_cast<Symbol*>(obj.get());
+    return symbol && symbol->GetName() == name;
+}
+
+bool IsQuote(const std::shared_ptr<Object>& expr) {
+    Cell* cell = dynamic_cast<Cell*>(expr.get());
+    if (!cell || !IsSymbol(cell->GetFirst(), "quote")) {
+        return false;
+    }
+    Cell* args = dynamic_cast<Cell*>(cell->GetSecond().get());
+    return args && !args->GetSecond();
+}
+
+// Self-evaluating objects and quoted data.
+bool IsConstant(const std::shared_ptr<Object>& expr) {
+    if (!expr || dynamic_cast<Symbol*>(expr.get())) {
+        return false;
+    }
+    return !dynamic_cast<Cell*>(expr.get()) || IsQuote(expr);
+}
+
+std::shared_ptr<Object> ConstantValue(const std::shared_ptr<Object>& expr) {
+    if (IsQuote(expr)) {
+        return As<Cell>(As<Cell>(expr)->GetSecond())->GetFirst();
+    }
+    return expr;
+}
+
+// Values that may stand for themselves in an expression: they evaluate to themselves and cannot
+// be mutated, so sharing one between evaluations is not observable.
+bool IsFoldedValue(const std::shared_ptr<Object>& value) {
+    Object* obj = value.get();
+    return dynamic_cast<Number*>(obj) || dynamic_cast<BigNumber*>(obj) ||
+           dynamic_cast<Flonum*>(obj) || dynamic_cast<Bool*>(obj);
+}
+
+bool IsProperList(const std::shared_ptr<Object>& list) {
+    Object* curr = list.get();
+    while (Cell* cell = dynamic_cast<Cell*>(curr)) {
+        curr = cell->GetSecond().get();
+    }
+    return !curr;
+}
+
+// A combination whose elements are being folded; it is simplified once they all are.
+struct Frame {
+    // LAMBDA folds the body only, COND folds each of its clauses as a CLAUSE, which is folded
+    // element by element like a CALL but never simplified.
+    enum class Kind { CALL, LAMBDA, COND, CLAUSE };
+
+    Kind kind;
+    std::shared_ptr<Object> form;
+    // Where the elements folded so far start on the parts stack.
+    size_t begin;
+    // The elements still to fold.
+    std::shared_ptr<Object> rest;
+    // The element being folded, to tell whether folding changed it.
+    std::shared_ptr<Object> current;
+    bool changed;
+    // Bound names to keep when the frame is done.
+    size_t scope;
+};
+
+// Post-order walk over an explicit stack, so that deep nesting does not use native stack. The
+// stacks are kept from one expression to the next.
+class Folder {
+public:
+    static Folder& Get() {
+        thread_local Folder folder;
+        return folder;
+    }
+
+    std::shared_ptr<Object> Run(const std::shared_ptr<Object>& expr, size_t depth_limit,
+                                FoldStats* stats) {
+        depth_limit_ = depth_limit;
+        stats_ = stats;
+        return Loop(expr);
+    }
+
+private:
+    std::shared_ptr<Object> Loop(const std::shared_ptr<Object>& expr) {
+        std::shared_ptr<Object> value;
+        bool done = Open(expr, Frame::Kind::CALL, &value);
+        while (true) {
+            if (done) {
+                if (frames_.empty()) {
+                    return value;
+                }
+                Frame& top = frames_.back();
+                top.changed |= value != top.current;
+                parts_.push_back(std::move(value));
+            }
+            Frame& top = frames_.back();
+            if (top.rest) {
+                // Only proper lists get a frame.
+                Cell* cell = static_cast<Cell*>(top.rest.get());
+                top.current = cell->GetFirst();
+                top.rest = cell->GetSecond();
+                auto kind = top.kind == Frame::Kind::COND ? Frame::Kind::CLAUSE : Frame::Kind::CALL;
+                done = Open(top.current, kind, &value);
+                continue;
+            }
+            value = Close();
+            done = true;
+        }
+    }
+
+    // Either sets `value` to `expr` as it is and returns true, or pushes a frame to fold it.
+    bool Open(const std::shared_ptr<Object>& expr, Frame::Kind kind, std::shared_ptr<Object>* value) {
+        *value = expr;
+        Cell* cell = dynamic_cast<Cell*>(expr.get());
+        if (!cell || !IsProperList(expr) || frames_.size() >= depth_limit_) {
+            return true;
+        }
+        if (kind == Frame::Kind::CLAUSE) {
+            Push(kind, expr, {}, expr);
+            return false;
+        }
+        auto head = cell->GetFirst();
+        auto args = cell->GetSecond();
+        Symbol* symbol = dynamic_cast<Symbol*>(head.get());
+        if (!symbol || !FindSpecialForm(symbol->GetName())) {
+            Push(Frame::Kind::CALL, expr, {}, expr);
+            return false;
+        }
+        const std::string& name = symbol->GetName();
+        if (name == "quote" || name == "define-record-type") {
+            return true;
+        }
+        if (name == "lambda" || name == "define") {
+            if (!args || !As<Cell>(args)->GetSecond()) {
+                return true;
+            }
+            auto params = As<Cell>(args)->GetFirst();
+            if (name == "define") {
+                // Only (define (name params...) body...) binds names; the value of a plain define
+                // folds like any argument.
+                if (!Is<Cell>(params)) {
+                    Push(Frame::Kind::CALL, expr, {}, expr);
+                    return false;
+                }
+                params = As<Cell>(params)->GetSecond();
+            }
+            if (!IsProperList(params)) {
+                return true;
+            }
+            size_t scope = scope_.size();
+            for (auto curr = params; curr; curr = As<Cell>(curr)->GetSecond()) {
+                auto param = As<Symbol>(As<Cell>(curr)->GetFirst());
+                if (!param) {
+                    scope_.resize(scope);
+                    return true;
+                }
+                scope_.push_back(param->GetName());
+            }
+            Push(Frame::Kind::LAMBDA, expr, {head, As<Cell>(args)->GetFirst()},
+                 As<Cell>(args)->GetSecond());
+            frames_.back().scope = scope;
+            return false;
+        }
+        if (name == "cond") {
+            Push(Frame::Kind::COND, expr, {head}, args);
+            return false;
+        }
+        Push(Frame::Kind::CALL, expr, {}, expr);
+        return false;
+    }
+
+    // `parts` are the elements that are kept as they are.
+    void Push(Frame::Kind kind, const std::shared_ptr<Object>& form,
+              std::initializer_list<std::shared_ptr<Object>> parts, std::shared_ptr<Object> rest) {
+        frames_.push_back({kind, form, parts_.size(), std::move(rest), nullptr, false, scope_.size()});
+        parts_.insert(parts_.end(), parts);
+    }
+
+    // Pops the newest frame and its parts and returns the folded form.
+    std::shared_ptr<Object> Close() {
+        const Frame& frame = frames_.back();
+        ArgSpan parts(parts_.data() + frame.begin, parts_.size() - frame.begin);
+        std::shared_ptr<Object> result;
+        switch (frame.kind) {
+            case Frame::Kind::CALL:
+                result = Simplify(frame, parts);
+                break;
+            case Frame::Kind::COND:
+                result = SimplifyCond(frame, parts);
+                break;
+            case Frame::Kind::LAMBDA:
+            case Frame::Kind::CLAUSE:
+                result = Rebuild(frame, parts);
+                break;
+        }
+        parts_.resize(frame.begin);
+        scope_.resize(frame.scope);
+        frames_.pop_back();
+        return result;
+    }
+
+    static std::shared_ptr<Object> Rebuild(const Frame& frame, ArgSpan parts) {
+        return frame.changed ? VectorToList(parts) : frame.form;
+    }
+
+    static std::shared_ptr<Object> Combination(const char* head,
+                                               std::vector<std::shared_ptr<Object>> args) {
+        args.insert(args.begin(), Make<Symbol>(head));
+        return VectorToList(args);
+    }
+
+    bool IsBound(const std::string& name) const {
+        for (const auto& bound : scope_) {
+            if (bound == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void CountFolded() {
+        if (stats_) {
+            ++stats_->folded;
+        }
+    }
+
+    void CountPruned() {
+        if (stats_) {
+            ++stats_->pruned;
+        }
+    }
+
+    std::shared_ptr<Object> Simplify(const Frame& frame, ArgSpan parts) {
+        Symbol* symbol = dynamic_cast<Symbol*>(parts[0].get());
+        if (!symbol) {
+            return Rebuild(frame, parts);
+        }
+        const std::string& name = symbol->GetName();
+        if (name == "if") {
+            return SimplifyIf(frame, parts);
+        }
+        if (name == "and" || name == "or") {
+            return SimplifyConnective(frame, parts, name == "and");
+        }
+        if (name == "begin") {
+            return SimplifyBegin(frame, parts);
+        }
+        Function* func = FindPure(name);
+        if (!func || IsBound(name)) {
+            return Rebuild(frame, parts);
+        }
+        for (size_t i = 1; i < parts.size(); ++i) {
+            if (!IsConstant(parts[i])) {
+                return Rebuild(frame, parts);
+            }
+        }
+        ArgFrame args(parts.size() - 1);
+        for (size_t i = 1; i < parts.size(); ++i) {
+            args[i - 1] = ConstantValue(parts[i]);
+        }
+        auto result = func->Apply(args.Args());
+        if (!result || !IsFoldedValue(*result)) {
+            return Rebuild(frame, parts);
+        }
+        CountFolded();
+        return std::move(*result);
+    }
+
+    // (if test consequent [alternative]) with a constant test is the branch it selects.
+    std::shared_ptr<Object> SimplifyIf(const Frame& frame, ArgSpan parts) {
+        if ((parts.size() != 3 && parts.size() != 4) || !IsConstant(parts[1])) {
+            return Rebuild(frame, parts);
+        }
+        CountPruned();
+        if (!IsFalse(ConstantValue(parts[1]))) {
+            return parts[2];
+        }
+        return parts.size() == 4 ? parts[3] : parts[1];
+    }
+
+    // Constant operands that cannot end the evaluation are dropped, and so is everything after
+    // one that always does.
+    std::shared_ptr<Object> SimplifyConnective(const Frame& frame, ArgSpan parts, bool is_and) {
+        std::vector<std::shared_ptr<Object>> kept;
+        for (size_t i = 1; i < parts.size(); ++i) {
+            if (i + 1 < parts.size() && IsConstant(parts[i])) {
+                if (IsFalse(ConstantValue(parts[i])) != is_and) {
+                    continue;
+                }
+                kept.push_back(parts[i]);
+                break;
+            }
+            kept.push_back(parts[i]);
+        }
+        if (kept.size() == 1) {
+            CountPruned();
+            return kept[0];
+        }
+        if (kept.size() + 1 == parts.size()) {
+            return Rebuild(frame, parts);
+        }
+        CountPruned();
+        if (kept.empty()) {
+            return Make<Bool>(is_and ? "#t" : "#f");
+        }
+        return Combination(is_and ? "and" : "or", std::move(kept));
+    }
+
+    // Constants before the last expression have no effect.
+    std::shared_ptr<Object> SimplifyBegin(const Frame& frame, ArgSpan parts) {
+        std::vector<std::shared_ptr<Object>> kept;
+        for (size_t i = 1; i < parts.size(); ++i) {
+            if (i + 1 == parts.size() || !IsConstant(parts[i])) {
+                kept.push_back(parts[i]);
+            }
+        }
+        if (kept.size() + 1 == parts.size() && kept.size() != 1) {
+            return Rebuild(frame, parts);
+        }
+        CountPruned();
+        return kept.size() == 1 ? kept[0] : Combination("begin", std::move(kept));
+    }
+
+    // Clauses with a constant false test are dropped, and so are the ones after a constant true
+    // test. Left alone if some clause is malformed, so that evaluation reports it.
+    std::shared_ptr<Object> SimplifyCond(const Frame& frame, ArgSpan parts) {
+        std::vector<std::shared_ptr<Object>> kept;
+        for (size_t i = 1; i < parts.size(); ++i) {
+            if (!Is<Cell>(parts[i]) || !IsProperList(parts[i])) {
+                return Rebuild(frame, parts);
+            }
+            auto test = As<Cell>(parts[i])->GetFirst();
+            auto body = As<Cell>(parts[i])->GetSecond();
+            if (IsSymbol(test, "else")) {
+                if (i + 1 != parts.size() || !body) {
+                    return Rebuild(frame, parts);
+                }
+                kept.push_back(parts[i]);
+                break;
+            }
+            if (!IsConstant(test)) {
+                kept.push_back(parts[i]);
+                continue;
+            }
+            if (IsFalse(ConstantValue(test))) {
+                continue;
+            }
+            if (kept.empty()) {
+                CountPruned();
+                if (!body) {
+                    return test;
+                }
+                if (!As<Cell>(body)->GetSecond()) {
+                    return As<Cell>(body)->GetFirst();
+                }
+                return Make<Cell>(Make<Symbol>("begin"), body);
+            }
+            kept.push_back(parts[i]);
+            break;
+        }
+        if (kept.size() + 1 == parts.size()) {
+            return Rebuild(frame, parts);
+        }
+        CountPruned();
+        if (kept.empty()) {
+            return Make<Bool>("#f");
+        }
+        return Combination("cond", std::move(kept));
+    }
+
+    size_t depth_limit_ = 0;
+    FoldStats* stats_ = nullptr;
+    std::vector<Frame> frames_;
+    // The folded elements of all the frames, newest last.
+    std::vector<std::shared_ptr<Object>> parts_;
+    // Names bound by the enclosing lambdas, which shadow the builtins.
+    std::vector<std::string> scope_;
+};
+
+}  // namespace
+
+std::shared_ptr<Object> FoldConstants(const std::shared_ptr<Object>& expr, size_t depth_limit,
+                                      FoldStats* stats) {
+    return Folder::Get().Run(expr, depth_limit, stats);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "object.h"
+
+// What FoldConstants changed in one expression.
+struct FoldStats {
+    // Builtin calls replaced by their value.
+    size_t folded = 0;
+    // if, cond, and, or and begin forms reduced because some of their operands were constant.
+    size_t pruned = 0;
+};
+
+// Rewrites `expr` before it is evaluated: calls of pure builtins on constant arguments become
+// their values, and the operands and branches that constant tests rule out are dropped. A call
+// that fails is kept, so it fails when evaluated, and so are forms nested deeper than
+// `depth_limit`, for the evaluator to reject. Unchanged subexpressions are shared with `expr`.
+// The counts of the changes are added to `stats` if it is set.
+std::shared_ptr<Object> FoldConstants(const std::shared_ptr<Object>& expr, size_t depth_limit,
+                                      FoldStats* stats = nullptr);
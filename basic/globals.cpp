@@ -0,0 +1,34 @@
+#include "globals.h"
+
+namespace {
+
+thread_local GlobalRegistry* current_globals = nullptr;
+
+}  // namespace
+
+size_t GlobalRegistry::Intern(const std::string& name) {
+    if (const size_t* slot = slots_.Find(name)) {
+        return *slot;
+    }
+    slots_.Insert(name, names_.size());
+    names_.push_back(name);
+    values_.emplace_back();
+    return names_.size() - 1;
+}
+
+const std::shared_ptr<Object>* GlobalRegistry::Find(const std::string& name) const {
+    const size_t* slot = slots_.Find(name);
+    return slot && values_[*slot] ? &values_[*slot] : nullptr;
+}
+
+GlobalRegistry* CurrentGlobals() {
+    return current_globals;
+}
+
+GlobalScope::GlobalScope(GlobalRegistry* globals) : prev_(current_globals) {
+    current_globals = globals;
+}
+
+GlobalScope::~GlobalScope() {
+    current_globals = prev_;
+}
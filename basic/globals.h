@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flat_table.h"
+
+class Object;
+
+// Variables defined at top level by one Interpreter. A name gets its slot the first time code
+// refers to it, defined or not, so that compiled code reaches a global by index. Slots are never
+// freed, and their values outlive the arena of the Run that defined them.
+class GlobalRegistry {
+public:
+    // The slot of `name`, added unbound if there is none yet.
+    size_t Intern(const std::string& name);
+
+    // The value of `name`, nullptr if it is not defined.
+    const std::shared_ptr<Object>* Find(const std::string& name) const;
+
+    const std::string& GetName(size_t slot) const {
+        return names_[slot];
+    }
+
+    // Empty if the global is not defined.
+    const std::shared_ptr<Object>& Get(size_t slot) const {
+        return values_[slot];
+    }
+
+    // Replaces the value that the global had, if any.
+    void Set(size_t slot, std::shared_ptr<Object> value) {
+        values_[slot] = std::move(value);
+    }
+
+private:
+    FlatTable<std::string, size_t, std::hash<std::string>, std::equal_to<std::string>> slots_;
+    std::vector<std::string> names_;
+    std::vector<std::shared_ptr<Object>> values_;
+};
+
+// Registry that define adds to and that globals are looked up in while set, nullptr otherwise.
+// Compile and CompileNodes need it to be set.
+GlobalRegistry* CurrentGlobals();
+
+// Makes `globals` current for the lifetime of the scope.
+class GlobalScope {
+public:
+    GlobalScope(GlobalRegistry* globals);
+    GlobalScope(const GlobalScope&) = delete;
+    GlobalScope& operator=(const GlobalScope&) = delete;
+    ~GlobalScope();
+
+private:
+    GlobalRegistry* prev_;
+};
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Persistent hash map: a hash-array-mapped trie that consumes 5 bits of the hash per level.
+// Every node is a single allocation holding its entries and its children, compacted by two
+// bitmaps. Updates copy only the path from the root, so all earlier versions stay valid and
+// share the rest. Not thread-safe: nodes are reference counted without atomics.
+template <class Key, class Value, class Hash, class Eq>
+class Hamt {
+    struct Node;
+
+    // Owning handle of a node; the count lives in the node itself.
+    class NodePtr {
+    public:
+        NodePtr() : node_(nullptr) {
+        }
+
+        // Adopts a node that was created with one reference.
+        explicit NodePtr(Node* node) : node_(node) {
+        }
+
+        NodePtr(const NodePtr& other) : node_(other.node_) {
+            if (node_) {
+                ++node_->refs;
+            }
+        }
+
+        NodePtr(NodePtr&& other) noexcept : node_(std::exchange(other.node_, nullptr)) {
+        }
+
+        NodePtr& operator=(NodePtr other) noexcept {
+            std::swap(node_, other.node_);
+            return *this;
+        }
+
+        ~NodePtr() {
+            if (node_ && --node_->refs == 0) {
+                Node::Destroy(node_);
+            }
+        }
+
+        Node* operator->() const {
+            return node_;
+        }
+
+        Node* get() const {
+            return node_;
+        }
+
+        bool operator==(const NodePtr& other) const {
+            return node_ == other.node_;
+        }
+
+    private:
+        Node* node_;
+    };
+
+public:
+    class Transient;
+
+    Hamt(Hash hash = Hash(), Eq eq = Eq())
+        : root_(Node::Allocate(0, 0, 0, 0, 0)), size_(0), hash_(hash), eq_(eq) {
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    const Value* Find(const Key& key) const {
+        size_t hash = hash_(key);
+        const Node* node = root_.get();
+        for (size_t shift = 0; shift < kHashBits; shift += kBits) {
+            uint32_t bit = Bit(hash, shift);
+            if (node->datamap & bit) {
+                const Entry& entry = node->Entries()[Index(node->datamap, bit)];
+                return entry.hash == hash && eq_(entry.key, key) ? &entry.value : nullptr;
+            }
+            if (!(node->nodemap & bit)) {
+                return nullptr;
+            }
+            node = node->Children()[Index(node->nodemap, bit)].get();
+        }
+        for (size_t i = 0; i < node->entry_count; ++i) {
+            const Entry& entry = node->Entries()[i];
+            if (entry.hash == hash && eq_(entry.key, key)) {
+                return &entry.value;
+            }
+        }
+        return nullptr;
+    }
+
+    Hamt Set(const Key& key, Value value) const {
+        Hamt ans = *this;
+        bool added = false;
+        Entry entry{key, std::move(value), hash_(key)};
+        ans.root_ = ans.SetIn(root_, 0, &entry, 0, &added);
+        ans.size_ += added;
+        return ans;
+    }
+
+    Hamt Remove(const Key& key) const {
+        Hamt ans = *this;
+        bool removed = false;
+        ans.root_ = ans.RemoveIn(root_, 0, key, hash_(key), 0, &removed);
+        ans.size_ -= removed;
+        return ans;
+    }
+
+    template <class F>
+    void ForEach(F&& f) const {
+        std::vector<const Node*> stack{root_.get()};
+        while (!stack.empty()) {
+            const Node* node = stack.back();
+            stack.pop_back();
+            for (size_t i = 0; i < node->entry_count; ++i) {
+                f(node->Entries()[i].key, node->Entries()[i].value);
+            }
+            for (size_t i = 0; i < node->child_count; ++i) {
+                stack.push_back(node->Children()[i].get());
+            }
+        }
+    }
+
+    // Batch of updates on top of `map`. Nodes the batch has created are updated in place, so
+    // most steps down a path only swap a child pointer. The map it was made from is untouched.
+    class Transient {
+    public:
+        Transient(const Hamt& map) : map_(map), edit_(NextEdit()) {
+        }
+
+        void Set(const Key& key, Value value) {
+            bool added = false;
+            Entry entry{key, std::move(value), map_.hash_(key)};
+            map_.root_ = map_.SetIn(map_.root_, 0, &entry, edit_, &added);
+            map_.size_ += added;
+        }
+
+        void Remove(const Key& key) {
+            bool removed = false;
+            map_.root_ = map_.RemoveIn(map_.root_, 0, key, map_.hash_(key), edit_, &removed);
+            map_.size_ -= removed;
+        }
+
+        // The nodes handed out become shared, so further updates of the batch copy them again.
+        Hamt Persistent() {
+            edit_ = NextEdit();
+            return map_;
+        }
+
+    private:
+        Hamt map_;
+        uint64_t edit_;
+    };
+
+private:
+    static constexpr size_t kBits = 5;
+    // Below this depth all hash bits are used up and colliding keys share a flat node.
+    static constexpr size_t kHashBits = 64;
+    static constexpr size_t kNone = size_t(-1);
+
+    struct Entry {
+        Key key;
+        Value value;
+        size_t hash;
+    };
+
+    // Followed in the same allocation by `entry_count` entries and `child_count` children.
+    struct Node {
+        size_t refs;
+        // The transient allowed to update this node in place; 0 for none.
+        uint64_t edit;
+        uint32_t datamap;
+        uint32_t nodemap;
+        uint32_t entry_count;
+        uint32_t child_count;
+
+        static constexpr size_t EntriesOffset() {
+            return (sizeof(Node) + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry);
+        }
+
+        size_t ChildrenOffset() const {
+            size_t end = EntriesOffset() + entry_count * sizeof(Entry);
+            return (end + alignof(NodePtr) - 1) / alignof(NodePtr) * alignof(NodePtr);
+        }
+
+        Entry* Entries() const {
+            return reinterpret_cast<Entry*>(reinterpret_cast<char*>(const_cast<Node*>(this)) +
+                                            EntriesOffset());
+        }
+
+        NodePtr* Children() const {
+            return reinterpret_cast<NodePtr*>(reinterpret_cast<char*>(const_cast<Node*>(this)) +
+                                              ChildrenOffset());
+        }
+
+        // The entries and children are left for the caller to construct.
+        static Node* Allocate(size_t entry_count, size_t child_count, uint64_t edit,
+                              uint32_t datamap, uint32_t nodemap) {
+            static_assert(alignof(Entry) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+            Node header{1, edit, datamap, nodemap, uint32_t(entry_count), uint32_t(child_count)};
+            void* memory = ::operator new(header.ChildrenOffset() + child_count * sizeof(NodePtr));
+            return new (memory) Node(header);
+        }
+
+        static void Destroy(Node* node) {
+            for (size_t i = 0; i < node->entry_count; ++i) {
+                node->Entries()[i].~Entry();
+            }
+            for (size_t i = 0; i < node->child_count; ++i) {
+                node->Children()[i].~NodePtr();
+            }
+            ::operator delete(node);
+        }
+    };
+
+    static uint64_t NextEdit() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    static uint32_t Bit(size_t hash, size_t shift) {
+        return uint32_t(1) << ((hash >> shift) & 31);
+    }
+
+    static size_t Index(uint32_t bitmap, uint32_t bit) {
+        return __builtin_popcount(bitmap & (bit - 1));
+    }
+
+    // Copies `count` elements of `src` into raw `dst`, leaving out src[drop] and moving `*extra`
+    // to dst[add] if given.
+    template <class T>
+    static void CopyInto(T* dst, const T* src, size_t count, size_t drop, size_t add, T* extra) {
+        size_t out = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (i == drop) {
+                continue;
+            }
+            if (extra && out == add) {
+                new (dst + out++) T(std::move(*extra));
+                extra = nullptr;
+            }
+            new (dst + out++) T(src[i]);
+        }
+        if (extra) {
+            new (dst + out) T(std::move(*extra));
+        }
+    }
+
+    // Copy of `src` with new bitmaps, one entry and one child dropped or added at the given
+    // positions; kNone and nullptr mean no change.
+    static NodePtr Rebuild(const Node* src, uint64_t edit, uint32_t datamap, uint32_t nodemap,
+                           size_t drop_entry, size_t add_entry, Entry* entry, size_t drop_child,
+                           size_t add_child, NodePtr* child) {
+        size_t entry_count = src->entry_count - (drop_entry != kNone) + (entry != nullptr);
+        size_t child_count = src->child_count - (drop_child != kNone) + (child != nullptr);
+        Node* node = Node::Allocate(entry_count, child_count, edit, datamap, nodemap);
+        CopyInto(node->Entries(), src->Entries(), src->entry_count, drop_entry, add_entry, entry);
+        CopyInto(node->Children(), src->Children(), src->child_count, drop_child, add_child, child);
+        return NodePtr(node);
+    }
+
+    static NodePtr Editable(const NodePtr& node, uint64_t edit) {
+        if (edit && node->edit == edit) {
+            return node;
+        }
+        return Rebuild(node.get(), edit, node->datamap, node->nodemap, kNone, kNone, nullptr,
+                       kNone, kNone, nullptr);
+    }
+
+    static NodePtr Merge(Entry* first, Entry* second, size_t shift, uint64_t edit) {
+        if (shift >= kHashBits) {
+            Node* node = Node::Allocate(2, 0, edit, 0, 0);
+            new (node->Entries()) Entry(std::move(*first));
+            new (node->Entries() + 1) Entry(std::move(*second));
+            return NodePtr(node);
+        }
+        uint32_t first_bit = Bit(first->hash, shift);
+        uint32_t second_bit = Bit(second->hash, shift);
+        if (first_bit == second_bit) {
+            Node* node = Node::Allocate(0, 1, edit, 0, first_bit);
+            new (node->Children()) NodePtr(Merge(first, second, shift + kBits, edit));
+            return NodePtr(node);
+        }
+        if (first_bit > second_bit) {
+            std::swap(first, second);
+        }
+        Node* node = Node::Allocate(2, 0, edit, first_bit | second_bit, 0);
+        new (node->Entries()) Entry(std::move(*first));
+        new (node->Entries() + 1) Entry(std::move(*second));
+        return NodePtr(node);
+    }
+
+    NodePtr SetIn(const NodePtr& node, size_t shift, Entry* entry, uint64_t edit,
+                  bool* added) const {
+        if (shift >= kHashBits) {
+            for (size_t i = 0; i < node->entry_count; ++i) {
+                if (eq_(node->Entries()[i].key, entry->key)) {
+                    auto ans = Editable(node, edit);
+                    ans->Entries()[i].value = std::move(entry->value);
+                    return ans;
+                }
+            }
+            *added = true;
+            return Rebuild(node.get(), edit, 0, 0, kNone, node->entry_count, entry, kNone, kNone,
+                           nullptr);
+        }
+        uint32_t bit = Bit(entry->hash, shift);
+        if (node->datamap & bit) {
+            size_t i = Index(node->datamap, bit);
+            const Entry& curr = node->Entries()[i];
+            if (curr.hash == entry->hash && eq_(curr.key, entry->key)) {
+                auto ans = Editable(node, edit);
+                ans->Entries()[i].value = std::move(entry->value);
+                return ans;
+            }
+            Entry moved = curr;
+            auto child = Merge(&moved, entry, shift + kBits, edit);
+            uint32_t nodemap = node->nodemap | bit;
+            *added = true;
+            return Rebuild(node.get(), edit, node->datamap ^ bit, nodemap, i, kNone, nullptr,
+                           kNone, Index(nodemap, bit), &child);
+        }
+        if (node->nodemap & bit) {
+            size_t i = Index(node->nodemap, bit);
+            auto child = SetIn(node->Children()[i], shift + kBits, entry, edit, added);
+            if (child == node->Children()[i]) {
+                return node;
+            }
+            auto ans = Editable(node, edit);
+            ans->Children()[i] = std::move(child);
+            return ans;
+        }
+        uint32_t datamap = node->datamap | bit;
+        *added = true;
+        return Rebuild(node.get(), edit, datamap, node->nodemap, kNone, Index(datamap, bit), entry,
+                       kNone, kNone, nullptr);
+    }
+
+    // A node left with a single entry and no children is pulled up into its parent, so the
+    // shape of the trie depends only on its contents.
+    NodePtr RemoveIn(const NodePtr& node, size_t shift, const Key& key, size_t hash,
+                     uint64_t edit, bool* removed) const {
+        if (shift >= kHashBits) {
+            for (size_t i = 0; i < node->entry_count; ++i) {
+                if (eq_(node->Entries()[i].key, key)) {
+                    *removed = true;
+                    return Rebuild(node.get(), edit, 0, 0, i, kNone, nullptr, kNone, kNone,
+                                   nullptr);
+                }
+            }
+            return node;
+        }
+        uint32_t bit = Bit(hash, shift);
+        if (node->datamap & bit) {
+            size_t i = Index(node->datamap, bit);
+            const Entry& curr = node->Entries()[i];
+            if (curr.hash != hash || !eq_(curr.key, key)) {
+                return node;
+            }
+            *removed = true;
+            return Rebuild(node.get(), edit, node->datamap ^ bit, node->nodemap, i, kNone, nullptr,
+                           kNone, kNone, nullptr);
+        }
+        if (!(node->nodemap & bit)) {
+            return node;
+        }
+        size_t i = Index(node->nodemap, bit);
+        auto child = RemoveIn(node->Children()[i], shift + kBits, key, hash, edit, removed);
+        if (!*removed) {
+            return node;
+        }
+        if (child->child_count == 0 && child->entry_count <= 1) {
+            uint32_t nodemap = node->nodemap ^ bit;
+            if (child->entry_count == 0) {
+                return Rebuild(node.get(), edit, node->datamap, nodemap, kNone, kNone, nullptr, i,
+                               kNone, nullptr);
+            }
+            Entry last = child->Entries()[0];
+            uint32_t datamap = node->datamap | bit;
+            return Rebuild(node.get(), edit, datamap, nodemap, kNone, Index(datamap, bit), &last, i,
+                           kNone, nullptr);
+        }
+        auto ans = Editable(node, edit);
+        ans->Children()[i] = std::move(child);
+        return ans;
+    }
+
+    NodePtr root_;
+    size_t size_;
+    Hash hash_;
+    Eq eq_;
+};
@@ -0,0 +1,149 @@
+#include "heap.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace {
+
+size_t RoundUp(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+void* MapAligned(size_t size, int prot) {
+    // Over-map by one huge page and trim, so that the mapping starts on a huge page boundary.
+    size_t mapped = size + ObjectHeap::kHugePageSize;
+    void* raw = mmap(nullptr, mapped, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    auto begin = reinterpret_cast<uintptr_t>(raw);
+    auto aligned = RoundUp(begin, ObjectHeap::kHugePageSize);
+    if (aligned > begin) {
+        munmap(raw, aligned - begin);
+    }
+    if (aligned + size < begin + mapped) {
+        munmap(reinterpret_cast<void*>(aligned + size), begin + mapped - aligned - size);
+    }
+    return reinterpret_cast<void*>(aligned);
+}
+
+}  // namespace
+
+ObjectHeap::ObjectHeap(size_t region_size, size_t reserve)
+    : region_size_(RoundUp(region_size, kHugePageSize)),
+      huge_pages_(true),
+      base_(nullptr),
+      reserved_(RoundUp(reserve, kHugePageSize)),
+      committed_(0),
+      regions_(),
+      free_blocks_() {
+    if (reserved_) {
+        base_ = static_cast<char*>(MapAligned(reserved_, PROT_NONE));
+    }
+}
+
+ObjectHeap::~ObjectHeap() {
+    if (reserved_) {
+        munmap(base_, reserved_);
+        return;
+    }
+    for (auto& region : regions_) {
+        munmap(region.data, region.size);
+    }
+}
+
+void* ObjectHeap::Allocate(size_t size) {
+    std::lock_guard guard(mutex_);
+    size = RoundUp(size, 16);
+    for (size_t i = 0; i < free_blocks_.size(); ++i) {
+        if (free_blocks_[i].size >= size) {
+            void* ans = free_blocks_[i].data;
+            free_blocks_.erase(free_blocks_.begin() + i);
+            return ans;
+        }
+    }
+    if (regions_.empty() || regions_.back().used + size > regions_.back().size) {
+        MapRegion(size);
+    }
+    auto& region = regions_.back();
+    void* ans = region.data + region.used;
+    region.used += size;
+    return ans;
+}
+
+void ObjectHeap::Release(void* ptr, size_t size) {
+    std::lock_guard guard(mutex_);
+    free_blocks_.push_back({ptr, RoundUp(size, 16)});
+}
+
+void ObjectHeap::MapRegion(size_t min_size) {
+    size_t size = std::max(region_size_, RoundUp(min_size, kHugePageSize));
+    char* data;
+    if (reserved_) {
+        if (committed_ + size > reserved_) {
+            throw std::bad_alloc();
+        }
+        data = base_ + committed_;
+        if (mprotect(data, size, PROT_READ | PROT_WRITE) != 0) {
+            throw std::bad_alloc();
+        }
+        committed_ += size;
+    } else {
+        data = static_cast<char*>(MapAligned(size, PROT_READ | PROT_WRITE));
+    }
+    // Offset 0 of a reserved heap stands for the null reference.
+    size_t used = data == base_ ? 16 : 0;
+    regions_.push_back({data, size, used, false});
+    Advise(&regions_.back());
+}
+
+void ObjectHeap::Advise(Region* region) {
+    region->huge = false;
+#ifdef MADV_HUGEPAGE
+    if (huge_pages_) {
+        region->huge = madvise(region->data, region->size, MADV_HUGEPAGE) == 0;
+    } else {
+        madvise(region->data, region->size, MADV_NOHUGEPAGE);
+    }
+#endif
+}
+
+void ObjectHeap::SetHugePages(bool enabled) {
+    std::lock_guard guard(mutex_);
+    huge_pages_ = enabled;
+    for (auto& region : regions_) {
+        Advise(&region);
+    }
+}
+
+bool ObjectHeap::Owns(const void* ptr) const {
+    std::lock_guard guard(mutex_);
+    auto p = static_cast<const char*>(ptr);
+    for (const auto& region : regions_) {
+        if (region.data <= p && p < region.data + region.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HeapStats ObjectHeap::GetStats() const {
+    std::lock_guard guard(mutex_);
+    HeapStats stats;
+    for (const auto& region : regions_) {
+        ++stats.regions_mapped;
+        stats.huge_page_regions += region.huge;
+        stats.bytes_mapped += region.size;
+        stats.bytes_used += region.used;
+    }
+    return stats;
+}
+
+ObjectHeap* CompressedHeap() {
+    // Never destroyed: objects in it may be referenced until the very end of the process.
+    static ObjectHeap* heap = new ObjectHeap(ObjectHeap::kDefaultRegionSize, ObjectHeap::kCompressedRange);
+    return heap;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+struct HeapStats {
+    size_t regions_mapped = 0;
+    size_t huge_page_regions = 0;
+    size_t bytes_mapped = 0;
+    size_t bytes_used = 0;
+};
+
+// Source of object storage: large anonymous mappings aligned to the huge page size, optionally
+// advised with MADV_HUGEPAGE so that the object graph is covered by few TLB entries.
+class ObjectHeap {
+public:
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+    static constexpr size_t kDefaultRegionSize = 16 * kHugePageSize;
+    // Span addressable by a 32-bit offset in units of 8 bytes.
+    static constexpr size_t kCompressedRange = size_t(1) << 35;
+
+    // With `reserve` set, the address range is reserved up front and regions are committed from
+    // it in order, so that every allocation is at a fixed offset from GetBase().
+    ObjectHeap(size_t region_size = kDefaultRegionSize, size_t reserve = 0);
+    ObjectHeap(const ObjectHeap&) = delete;
+    ObjectHeap& operator=(const ObjectHeap&) = delete;
+    ~ObjectHeap();
+
+    // Carves `size` bytes aligned to 16 from the last region, mapping a new one if needed.
+    void* Allocate(size_t size);
+
+    // Returns a block obtained from Allocate for reuse by later allocations of at most its size.
+    void Release(void* ptr, size_t size);
+
+    char* GetBase() const {
+        return base_;
+    }
+
+    // Applies to the regions already mapped as well as to the future ones.
+    void SetHugePages(bool enabled);
+
+    bool GetHugePages() const {
+        return huge_pages_;
+    }
+
+    bool Owns(const void* ptr) const;
+
+    HeapStats GetStats() const;
+
+private:
+    struct Region {
+        char* data;
+        size_t size;
+        size_t used;
+        bool huge;
+    };
+
+    void MapRegion(size_t min_size);
+    void Advise(Region* region);
+
+    struct Block {
+        void* data;
+        size_t size;
+    };
+
+    // Several interpreters may share CompressedHeap(); chunk-sized requests make this cheap.
+    mutable std::mutex mutex_;
+    size_t region_size_;
+    bool huge_pages_;
+    char* base_;
+    size_t reserved_;
+    size_t committed_;
+    std::vector<Region> regions_;
+    std::vector<Block> free_blocks_;
+};
+
+// The single heap that backs all arenas when objects are addressed by CompressedRef.
+ObjectHeap* CompressedHeap();
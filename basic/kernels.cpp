@@ -0,0 +1,188 @@
+#include "kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCHEME_X86_KERNELS
+#endif
+
+namespace {
+
+bool SumScalar(int64_t init, const int64_t* data, size_t size, int64_t* out) {
+    for (size_t i = 0; i < size; ++i) {
+        if (__builtin_add_overflow(init, data[i], &init)) {
+            return true;
+        }
+    }
+    *out = init;
+    return false;
+}
+
+template <Chain chain>
+bool IsChainScalar(const int64_t* data, size_t size) {
+    for (size_t i = 0; i + 1 < size; ++i) {
+        if (!Holds<chain>(data[i], data[i + 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef SCHEME_X86_KERNELS
+
+constexpr size_t kLanes = 4;
+
+__attribute__((target("avx2"))) __m256i Load(const int64_t* data) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+// Each lane keeps its own partial sum; a lane overflowed if the signs of both operands differ
+// from the sign of the result.
+__attribute__((target("avx2"))) bool SumAvx2(int64_t init, const int64_t* data, size_t size,
+                                             int64_t* out) {
+    __m256i acc = _mm256_setzero_si256();
+    __m256i overflow = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + kLanes <= size; i += kLanes) {
+        __m256i value = Load(data + i);
+        __m256i sum = _mm256_add_epi64(acc, value);
+        overflow = _mm256_or_si256(
+            overflow,
+            _mm256_and_si256(_mm256_xor_si256(acc, sum), _mm256_xor_si256(value, sum)));
+        acc = sum;
+    }
+    if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow))) {
+        return true;
+    }
+    alignas(32) int64_t lanes[kLanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return SumScalar(init, lanes, kLanes, &init) || SumScalar(init, data + i, size - i, out);
+}
+
+template <bool min>
+__attribute__((target("avx2"))) int64_t MinMaxAvx2(int64_t init, const int64_t* data,
+                                                   size_t size) {
+    __m256i acc = _mm256_set1_epi64x(init);
+    size_t i = 0;
+    for (; i + kLanes <= size; i += kLanes) {
+        __m256i value = Load(data + i);
+        __m256i replace = min ? _mm256_cmpgt_epi64(acc, value) : _mm256_cmpgt_epi64(value, acc);
+        acc = _mm256_blendv_epi8(acc, value, replace);
+    }
+    alignas(32) int64_t lanes[kLanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int64_t ans = init;
+    for (int64_t lane : lanes) {
+        ans = min ? std::min(ans, lane) : std::max(ans, lane);
+    }
+    for (; i < size; ++i) {
+        ans = min ? std::min(ans, data[i]) : std::max(ans, data[i]);
+    }
+    return ans;
+}
+
+// Compares data[i..i + 4) with data[i + 1..i + 5) lane by lane and stops at the first block with
+// a pair out of order.
+template <Chain chain>
+__attribute__((target("avx2"))) bool IsChainAvx2(const int64_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + kLanes < size; i += kLanes) {
+        __m256i a = Load(data + i);
+        __m256i b = Load(data + i + 1);
+        __m256i holds;
+        if constexpr (chain == Chain::EQUAL) {
+            holds = _mm256_cmpeq_epi64(a, b);
+        } else if constexpr (chain == Chain::LESS) {
+            holds = _mm256_cmpgt_epi64(b, a);
+        } else if constexpr (chain == Chain::GREATER) {
+            holds = _mm256_cmpgt_epi64(a, b);
+        } else if constexpr (chain == Chain::LESS_EQUAL) {
+            holds = _mm256_xor_si256(_mm256_cmpgt_epi64(a, b), _mm256_set1_epi64x(-1));
+        } else {
+            holds = _mm256_xor_si256(_mm256_cmpgt_epi64(b, a), _mm256_set1_epi64x(-1));
+        }
+        if (_mm256_movemask_pd(_mm256_castsi256_pd(holds)) != 0xf) {
+            return false;
+        }
+    }
+    return IsChainScalar<chain>(data + i, size - i);
+}
+
+bool HasAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+bool use_avx2 = HasAvx2();
+
+#else
+
+bool use_avx2 = false;
+
+#endif
+
+template <Chain chain>
+bool IsChain(const int64_t* data, size_t size) {
+#ifdef SCHEME_X86_KERNELS
+    if (use_avx2) {
+        return IsChainAvx2<chain>(data, size);
+    }
+#endif
+    return IsChainScalar<chain>(data, size);
+}
+
+}  // namespace
+
+bool SumInt64(int64_t init, const int64_t* data, size_t size, int64_t* out) {
+#ifdef SCHEME_X86_KERNELS
+    if (use_avx2) {
+        return SumAvx2(init, data, size, out);
+    }
+#endif
+    return SumScalar(init, data, size, out);
+}
+
+int64_t MinInt64(int64_t init, const int64_t* data, size_t size) {
+#ifdef SCHEME_X86_KERNELS
+    if (use_avx2) {
+        return MinMaxAvx2<true>(init, data, size);
+    }
+#endif
+    return std::min(init, size ? *std::min_element(data, data + size) : init);
+}
+
+int64_t MaxInt64(int64_t init, const int64_t* data, size_t size) {
+#ifdef SCHEME_X86_KERNELS
+    if (use_avx2) {
+        return MinMaxAvx2<false>(init, data, size);
+    }
+#endif
+    return std::max(init, size ? *std::max_element(data, data + size) : init);
+}
+
+bool IsChainInt64(Chain chain, const int64_t* data, size_t size) {
+    switch (chain) {
+        case Chain::EQUAL:
+            return IsChain<Chain::EQUAL>(data, size);
+        case Chain::LESS:
+            return IsChain<Chain::LESS>(data, size);
+        case Chain::GREATER:
+            return IsChain<Chain::GREATER>(data, size);
+        case Chain::LESS_EQUAL:
+            return IsChain<Chain::LESS_EQUAL>(data, size);
+        case Chain::GREATER_EQUAL:
+            return IsChain<Chain::GREATER_EQUAL>(data, size);
+    }
+    return true;
+}
+
+bool SimdKernelsEnabled() {
+    return use_avx2;
+}
+
+void SetSimdKernels(bool enabled) {
+#ifdef SCHEME_X86_KERNELS
+    use_avx2 = enabled && HasAvx2();
+#endif
+}
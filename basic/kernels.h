@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Loops over unboxed fixnums for the variadic numeric builtins. Each has an AVX2 version, used
+// when the CPU supports it, and a portable one; the choice is made once, at runtime.
+
+// Stores `init` + data[0] + ... + data[size - 1] in `out`. Returns true, like
+// __builtin_add_overflow, if a partial sum overflowed; that may happen even though the total
+// fits, so the caller redoes the sum exactly.
+bool SumInt64(int64_t init, const int64_t* data, size_t size, int64_t* out);
+
+int64_t MinInt64(int64_t init, const int64_t* data, size_t size);
+
+int64_t MaxInt64(int64_t init, const int64_t* data, size_t size);
+
+enum class Chain { EQUAL, LESS, GREATER, LESS_EQUAL, GREATER_EQUAL };
+
+template <Chain chain>
+constexpr bool Holds(int64_t a, int64_t b) {
+    switch (chain) {
+        case Chain::EQUAL:
+            return a == b;
+        case Chain::LESS:
+            return a < b;
+        case Chain::GREATER:
+            return a > b;
+        case Chain::LESS_EQUAL:
+            return a <= b;
+        case Chain::GREATER_EQUAL:
+            return a >= b;
+    }
+    return false;
+}
+
+// Whether every pair data[i], data[i + 1] is in the relation `chain`. Stops at the first that is
+// not.
+bool IsChainInt64(Chain chain, const int64_t* data, size_t size);
+
+// Whether the AVX2 versions are in use. They can be switched off to compare against the portable
+// ones; switching them on has no effect on a CPU without AVX2.
+bool SimdKernelsEnabled();
+void SetSimdKernels(bool enabled);
@@ -0,0 +1,910 @@
+#include "nodes.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arg_stack.h"
+#include "bytecode.h"
+#include "eval.h"
+#include "resolver.h"
+#include "special_forms.h"
+
+namespace {
+
+// Per-thread state of the nodes that are running.
+struct NodeState {
+    size_t depth = 0;
+    size_t limit = 0;
+    NodeStats* stats = nullptr;
+    // The call that a node in tail position leaves to the closure application below it.
+    std::shared_ptr<Object> tail_callee;
+    std::vector<std::shared_ptr<Object>> tail_args;
+};
+
+NodeState& State() {
+    thread_local NodeState state;
+    return state;
+}
+
+// Counts a node running inside another for the lifetime of the scope.
+class DepthGuard {
+public:
+    DepthGuard() : state_(State()) {
+        ++state_.depth;
+    }
+
+    DepthGuard(const DepthGuard&) = delete;
+    DepthGuard& operator=(const DepthGuard&) = delete;
+
+    ~DepthGuard() {
+        --state_.depth;
+    }
+
+    bool Exceeded() const {
+        return state_.depth > state_.limit;
+    }
+
+private:
+    NodeState& state_;
+};
+
+Error DepthError() {
+    return Error::Runtime("maximum evaluation depth exceeded");
+}
+
+// Returned instead of a value by a call in tail position, which has left its callee and arguments
+// in State().
+class TailCall : public Object {
+public:
+    std::string Serialise() {
+        return "#<tail call>";
+    }
+
+    ObjectResult Eval() {
+        return Self();
+    }
+};
+
+TailCall tail_call;
+
+std::shared_ptr<Object> TailCallMarker() {
+    return std::shared_ptr<Object>(std::shared_ptr<Object>(), &tail_call);
+}
+
+bool IsTailCall(const std::shared_ptr<Object>& value) {
+    return value.get() == &tail_call;
+}
+
+// Procedure made by a lambda node. Its environment holds just the values that it captured.
+class NodeClosure : public Procedure {
+public:
+    NodeClosure(size_t arity, std::shared_ptr<Node> body, std::shared_ptr<Environment> env)
+        : arity_(arity), body_(std::move(body)), env_(std::move(env)) {
+    }
+
+    // The environment of a call with `args`.
+    Result<std::shared_ptr<Environment>> Bind(ArgSpan args) const {
+        if (args.size() != arity_) {
+            return Error::Runtime("procedure expects " + std::to_string(arity_) +
+                                  " arguments, got " + std::to_string(args.size()));
+        }
+        return Make<Environment>(args, env_);
+    }
+
+    Node& GetBody() const {
+        return *body_;
+    }
+
+    std::shared_ptr<Object> Promote(Arena* arena) override {
+        return Make<NodeClosure>(arity_, body_, ::Promote(env_, arena));
+    }
+
+private:
+    size_t arity_;
+    std::shared_ptr<Node> body_;
+    std::shared_ptr<Environment> env_;
+};
+
+// Applies `callee`, which is not a closure of nodes.
+ObjectResult ApplyValue(const std::shared_ptr<Object>& callee, ArgSpan args) {
+    if (Function* func = dynamic_cast<Function*>(callee.get())) {
+        return WithName(func->Apply(args), func->GetName());
+    }
+    return Error::Runtime("cannot apply " + SerialiseExpr(callee));
+}
+
+// Applies `callee` and then every call that its body leaves in tail position, in a loop.
+ObjectResult Apply(std::shared_ptr<Object> callee, ArgSpan args) {
+    NodeState& state = State();
+    while (true) {
+        auto closure = dynamic_cast<NodeClosure*>(callee.get());
+        if (!closure) {
+            return ApplyValue(callee, args);
+        }
+        SCHEME_TRY(auto env, closure->Bind(args));
+        SCHEME_TRY(auto value, closure->GetBody().Execute(env));
+        if (!IsTailCall(value)) {
+            return value;
+        }
+        callee = std::move(state.tail_callee);
+        args = state.tail_args;
+    }
+}
+
+using NodePtr = std::unique_ptr<Node>;
+
+class ConstNode : public Node {
+public:
+    explicit ConstNode(std::shared_ptr<Object> value) : value_(std::move(value)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>&) override {
+        return value_;
+    }
+
+private:
+    std::shared_ptr<Object> value_;
+};
+
+class RaiseNode : public Node {
+public:
+    explicit RaiseNode(Error error) : error_(std::move(error)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>&) override {
+        return error_;
+    }
+
+private:
+    Error error_;
+};
+
+// Variable of an enclosing lambda, at its lexical address.
+class LoadNode : public Node {
+public:
+    LoadNode(size_t depth, size_t index) : depth_(depth), index_(index) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        return env->Get(depth_, index_);
+    }
+
+private:
+    size_t depth_;
+    size_t index_;
+};
+
+// Call of a builtin by its name.
+class BuiltinNode : public Node {
+public:
+    BuiltinNode(Function* func, std::vector<NodePtr> args) : func_(func), args_(std::move(args)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        ArgFrame args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            SCHEME_TRY(args[i], args_[i]->Execute(env));
+        }
+        return WithName(func_->Apply(args.Args()), func_->GetName());
+    }
+
+private:
+    Function* func_;
+    std::vector<NodePtr> args_;
+};
+
+// Call of +, -, *, =, <, >, <= or >= with two arguments, which rewrites itself after its first
+// run: to a version for fixnums alone if both operands were fixnums, to the generic call
+// otherwise. The fixnum version checks its operands and, on anything else, goes back to the
+// generic call for good, so a node that sees mixed types does not flip back and forth.
+template <Op op>
+class ArithmeticNode : public Node {
+public:
+    ArithmeticNode(Function* func, NodePtr left, NodePtr right)
+        : func_(func), left_(std::move(left)), right_(std::move(right)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        std::shared_ptr<Object> args[2];
+        SCHEME_TRY(args[0], left_->Execute(env));
+        SCHEME_TRY(args[1], right_->Execute(env));
+        return (this->*run_)(args);
+    }
+
+private:
+    using Run = ObjectResult (ArithmeticNode::*)(const std::shared_ptr<Object>* args);
+
+    ObjectResult Uninitialized(const std::shared_ptr<Object>* args) {
+        if (Is<Number>(args[0]) && Is<Number>(args[1])) {
+            run_ = &ArithmeticNode::FixnumOnly;
+            if (NodeStats* stats = State().stats) {
+                ++stats->specialized;
+            }
+            return FixnumOnly(args);
+        }
+        run_ = &ArithmeticNode::Generic;
+        return Generic(args);
+    }
+
+    ObjectResult FixnumOnly(const std::shared_ptr<Object>* args) {
+        auto* a = dynamic_cast<Number*>(args[0].get());
+        auto* b = dynamic_cast<Number*>(args[1].get());
+        std::shared_ptr<Object> value;
+        if (a && b && Fixnum<op>(a->GetValue(), b->GetValue(), &value)) {
+            return value;
+        }
+        run_ = &ArithmeticNode::Generic;
+        if (NodeStats* stats = State().stats) {
+            ++stats->guard_failures;
+        }
+        return Generic(args);
+    }
+
+    ObjectResult Generic(const std::shared_ptr<Object>* args) {
+        return WithName(func_->Apply(ArgSpan(args, 2)), func_->GetName());
+    }
+
+    Function* func_;
+    NodePtr left_;
+    NodePtr right_;
+    Run run_ = &ArithmeticNode::Uninitialized;
+};
+
+class GlobalNode : public Node {
+public:
+    explicit GlobalNode(size_t slot) : slot_(slot) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>&) override {
+        GlobalRegistry* globals = CurrentGlobals();
+        if (const auto& value = globals->Get(slot_)) {
+            return value;
+        }
+        return Error::Name(globals->GetName(slot_));
+    }
+
+private:
+    size_t slot_;
+};
+
+class DefineNode : public Node {
+public:
+    DefineNode(size_t slot, NodePtr value) : slot_(slot), value_(std::move(value)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        SCHEME_TRY(auto value, value_->Execute(env));
+        return DefineGlobal(slot_, value);
+    }
+
+private:
+    size_t slot_;
+    NodePtr value_;
+};
+
+// In tail position a closure is left to the caller's Apply, so the call does not nest in the
+// current one.
+ObjectResult Call(std::shared_ptr<Object> callee, ArgSpan args, bool tail) {
+    if (!tail || !dynamic_cast<NodeClosure*>(callee.get())) {
+        return Apply(std::move(callee), args);
+    }
+    NodeState& state = State();
+    state.tail_callee = std::move(callee);
+    state.tail_args.assign(args.begin(), args.end());
+    return TailCallMarker();
+}
+
+// Call of a procedure value.
+class CallNode : public Node {
+public:
+    CallNode(NodePtr callee, std::vector<NodePtr> args, bool tail)
+        : callee_(std::move(callee)), args_(std::move(args)), tail_(tail) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        SCHEME_TRY(auto callee, callee_->Execute(env));
+        ArgFrame args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            SCHEME_TRY(args[i], args_[i]->Execute(env));
+        }
+        return Call(std::move(callee), args.Args(), tail_);
+    }
+
+private:
+    NodePtr callee_;
+    std::vector<NodePtr> args_;
+    bool tail_;
+};
+
+// Call of a name that is neither a variable nor a builtin: a global, or a record procedure,
+// looked up once the arguments are evaluated since define may come first.
+class NamedNode : public Node {
+public:
+    NamedNode(size_t slot, std::vector<NodePtr> args, bool tail)
+        : slot_(slot), args_(std::move(args)), tail_(tail) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        ArgFrame args(args_.size());
+        for (size_t i = 0; i < args_.size(); ++i) {
+            SCHEME_TRY(args[i], args_[i]->Execute(env));
+        }
+        GlobalRegistry* globals = CurrentGlobals();
+        if (const auto& callee = globals->Get(slot_)) {
+            return Call(callee, args.Args(), tail_);
+        }
+        return ApplyByName(globals->GetName(slot_), args.Args());
+    }
+
+private:
+    size_t slot_;
+    std::vector<NodePtr> args_;
+    bool tail_;
+};
+
+// Without an alternative, a false test is the value.
+class IfNode : public Node {
+public:
+    IfNode(NodePtr test, NodePtr consequent, NodePtr alternative)
+        : test_(std::move(test)),
+          consequent_(std::move(consequent)),
+          alternative_(std::move(alternative)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        SCHEME_TRY(auto test, test_->Execute(env));
+        if (!IsFalse(test)) {
+            return consequent_->Execute(env);
+        }
+        if (alternative_) {
+            return alternative_->Execute(env);
+        }
+        return test;
+    }
+
+private:
+    NodePtr test_;
+    NodePtr consequent_;
+    NodePtr alternative_;
+};
+
+// and or or with at least one operand.
+template <bool is_and>
+class ConnectiveNode : public Node {
+public:
+    explicit ConnectiveNode(std::vector<NodePtr> operands) : operands_(std::move(operands)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        for (size_t i = 0; i + 1 < operands_.size(); ++i) {
+            SCHEME_TRY(auto value, operands_[i]->Execute(env));
+            if (IsFalse(value) == is_and) {
+                return value;
+            }
+        }
+        return operands_.back()->Execute(env);
+    }
+
+private:
+    std::vector<NodePtr> operands_;
+};
+
+// Two or more expressions, to the last one's value.
+class SequenceNode : public Node {
+public:
+    explicit SequenceNode(std::vector<NodePtr> body) : body_(std::move(body)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        for (size_t i = 0; i + 1 < body_.size(); ++i) {
+            SCHEME_TRY(auto value, body_[i]->Execute(env));
+        }
+        return body_.back()->Execute(env);
+    }
+
+private:
+    std::vector<NodePtr> body_;
+};
+
+class CondNode : public Node {
+public:
+    // No test for else; no body for a clause that yields its test value.
+    struct Clause {
+        NodePtr test;
+        NodePtr body;
+    };
+
+    explicit CondNode(std::vector<Clause> clauses) : clauses_(std::move(clauses)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        DepthGuard guard;
+        if (guard.Exceeded()) {
+            return DepthError();
+        }
+        for (const auto& clause : clauses_) {
+            if (!clause.test) {
+                return clause.body->Execute(env);
+            }
+            SCHEME_TRY(auto test, clause.test->Execute(env));
+            if (!IsFalse(test)) {
+                return clause.body ? clause.body->Execute(env) : test;
+            }
+        }
+        return Make<Bool>("#f");
+    }
+
+private:
+    std::vector<Clause> clauses_;
+};
+
+// `captures` are where the values that the closure captures are in `env`.
+class LambdaNode : public Node {
+public:
+    LambdaNode(size_t arity, std::shared_ptr<Node> body, std::vector<Address> captures)
+        : arity_(arity), body_(std::move(body)), captures_(std::move(captures)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>& env) override {
+        if (captures_.empty()) {
+            return Make<NodeClosure>(arity_, body_, nullptr);
+        }
+        ArgFrame values(captures_.size());
+        for (size_t i = 0; i < captures_.size(); ++i) {
+            values[i] = env->Get(captures_[i].depth, captures_[i].index);
+        }
+        return Make<NodeClosure>(arity_, body_, Make<Environment>(values.Args(), nullptr));
+    }
+
+private:
+    size_t arity_;
+    std::shared_ptr<Node> body_;
+    std::vector<Address> captures_;
+};
+
+class RecordNode : public Node {
+public:
+    explicit RecordNode(std::shared_ptr<Object> form) : form_(std::move(form)) {
+    }
+
+    ObjectResult Execute(const std::shared_ptr<Environment>&) override {
+        return DefineRecordType(form_);
+    }
+
+private:
+    std::shared_ptr<Object> form_;
+};
+
+// A form whose subexpressions are being compiled; its node is built once they all are.
+struct BuildFrame {
+    enum class Kind { CALL, BUILTIN, NAMED, IF, AND, OR, SEQUENCE, COND, LAMBDA, DEFINE };
+
+    // A subexpression, or a node that is already built.
+    struct Child {
+        std::shared_ptr<Object> expr;
+        bool tail;
+        NodePtr ready;
+    };
+
+    // For COND, how many of the parts each clause takes.
+    struct Clause {
+        bool has_test;
+        size_t body;
+    };
+
+    Kind kind;
+    bool tail;
+    std::vector<Child> children;
+    size_t next = 0;
+    // Where the nodes of the children start on the parts stack.
+    size_t begin = 0;
+    // The builtin of BUILTIN, the global of NAMED and DEFINE.
+    Function* func = nullptr;
+    size_t slot = 0;
+    // The number of parameters of LAMBDA.
+    size_t arity = 0;
+    std::vector<Clause> clauses;
+};
+
+// Post-order walk over an explicit stack, like the folder's. Forms nested deeper than
+// kNodeDepthLimit become a node that fails as running that deep would, which also bounds the
+// native stack that running and destroying the nodes take. The checks and error messages of the
+// special forms are those in special_forms.cpp.
+class NodeBuilder {
+public:
+    NodePtr Run(const std::shared_ptr<Object>& expr) {
+        NodePtr node = Open(expr, true);
+        while (true) {
+            if (node) {
+                if (frames_.empty()) {
+                    return node;
+                }
+                parts_.push_back(std::move(node));
+            }
+            BuildFrame& top = frames_.back();
+            if (top.next < top.children.size()) {
+                BuildFrame::Child& child = top.children[top.next++];
+                node = child.ready ? std::move(child.ready) : Open(child.expr, child.tail);
+                continue;
+            }
+            node = Close();
+        }
+    }
+
+private:
+    // Either returns the node of `expr` or pushes a frame to build it.
+    NodePtr Open(const std::shared_ptr<Object>& expr, bool tail) {
+        Cell* cell = dynamic_cast<Cell*>(expr.get());
+        if (!cell) {
+            if (!expr) {
+                return Raise(Error::Runtime("cannot evaluate ()"));
+            }
+            if (Symbol* symbol = dynamic_cast<Symbol*>(expr.get())) {
+                return Variable(symbol->GetName());
+            }
+            return Constant(expr);
+        }
+        if (frames_.size() >= kNodeDepthLimit) {
+            return Raise(DepthError());
+        }
+        auto head = cell->GetFirst();
+        auto args = cell->GetSecond();
+        Symbol* symbol = dynamic_cast<Symbol*>(head.get());
+        if (symbol && FindSpecialForm(symbol->GetName())) {
+            return OpenForm(symbol->GetName(), args, tail);
+        }
+        auto count = ArgCount(args);
+        if (!count) {
+            return Raise(std::move(count.GetError()));
+        }
+        Address address;
+        BuildFrame& frame = Push(BuildFrame::Kind::CALL, tail);
+        if (symbol && !resolver_.Resolve(symbol->GetName(), &address)) {
+            if (Function* func = FindBuiltin(symbol->GetName())) {
+                frame.kind = BuildFrame::Kind::BUILTIN;
+                frame.func = func;
+            } else {
+                frame.kind = BuildFrame::Kind::NAMED;
+                frame.slot = CurrentGlobals()->Intern(symbol->GetName());
+            }
+        } else {
+            // The operator is a value, evaluated before the arguments.
+            AddChild(head, false);
+        }
+        for (auto curr = args; curr; curr = As<Cell>(curr)->GetSecond()) {
+            AddChild(As<Cell>(curr)->GetFirst(), false);
+        }
+        return nullptr;
+    }
+
+    NodePtr OpenForm(const std::string& name, const std::shared_ptr<Object>& args, bool tail) {
+        if (name == "quote") {
+            if (!Is<Cell>(args) || As<Cell>(args)->GetSecond()) {
+                return Raise(Error::Syntax("quote: expected one datum"));
+            }
+            return Constant(As<Cell>(args)->GetFirst());
+        }
+        if (name == "if") {
+            auto parts = FormToVector(args);
+            if (!parts) {
+                return Raise(std::move(parts.GetError()));
+            }
+            if (parts->size() != 2 && parts->size() != 3) {
+                return Raise(Error::Syntax("if: expected a test and one or two branches"));
+            }
+            Push(BuildFrame::Kind::IF, tail);
+            for (size_t i = 0; i < parts->size(); ++i) {
+                AddChild((*parts)[i], tail && i > 0);
+            }
+            return nullptr;
+        }
+        if (name == "and" || name == "or") {
+            bool is_and = name == "and";
+            auto parts = FormToVector(args);
+            if (!parts) {
+                return Raise(Error::Syntax(is_and ? "and: improper argument list"
+                                                  : "or: improper argument list"));
+            }
+            if (parts->empty()) {
+                return Constant(Make<Bool>(is_and ? "#t" : "#f"));
+            }
+            Push(is_and ? BuildFrame::Kind::AND : BuildFrame::Kind::OR, tail);
+            AddSequence(args, tail);
+            return nullptr;
+        }
+        if (name == "begin") {
+            if (!FormToVector(args)) {
+                return Raise(Error::Syntax("begin: improper list of expressions"));
+            }
+            if (!args) {
+                return Raise(Error::Syntax("begin: expected at least one expression"));
+            }
+            Push(BuildFrame::Kind::SEQUENCE, tail);
+            AddSequence(args, tail);
+            return nullptr;
+        }
+        if (name == "cond") {
+            return OpenCond(args, tail);
+        }
+        if (name == "lambda") {
+            auto params = LambdaParams(args);
+            if (!params) {
+                return Raise(std::move(params.GetError()));
+            }
+            BuildFrame& frame = Push(BuildFrame::Kind::LAMBDA, tail);
+            frame.arity = params->size();
+            AddSequence(As<Cell>(args)->GetSecond(), true);
+            resolver_.Enter(std::move(*params));
+            return nullptr;
+        }
+        if (name == "define") {
+            if (!resolver_.AtTopLevel()) {
+                return Raise(Error::Syntax("define: only allowed at top level"));
+            }
+            auto definition = DefineParts(args);
+            if (!definition) {
+                return Raise(std::move(definition.GetError()));
+            }
+            BuildFrame& frame = Push(BuildFrame::Kind::DEFINE, tail);
+            frame.slot = CurrentGlobals()->Intern(definition->name);
+            AddChild(definition->value, false);
+            return nullptr;
+        }
+        return std::make_unique<RecordNode>(Promote(args));
+    }
+
+    // A malformed clause becomes one whose test fails, as it fails only once it is reached.
+    NodePtr OpenCond(const std::shared_ptr<Object>& args, bool tail) {
+        auto clauses = FormToVector(args);
+        if (!clauses) {
+            return Raise(Error::Syntax("cond: improper list of clauses"));
+        }
+        BuildFrame& frame = Push(BuildFrame::Kind::COND, tail);
+        for (size_t i = 0; i < clauses->size(); ++i) {
+            const auto& clause = (*clauses)[i];
+            auto parts = FormToVector(clause);
+            if (!parts || parts->empty()) {
+                Error error = parts ? Error::Syntax("cond: empty clause") : parts.GetError();
+                frame.children.push_back({nullptr, false, Raise(std::move(error))});
+                frame.clauses.push_back({true, 0});
+                break;
+            }
+            auto body = As<Cell>(clause)->GetSecond();
+            if (Is<Symbol>((*parts)[0]) && As<Symbol>((*parts)[0])->GetName() == "else") {
+                if (i + 1 != clauses->size() || !body) {
+                    frame.children.push_back(
+                        {nullptr, false,
+                         Raise(Error::Syntax("cond: misplaced or empty else clause"))});
+                    frame.clauses.push_back({true, 0});
+                } else {
+                    frame.clauses.push_back({false, AddSequence(body, tail)});
+                }
+                break;
+            }
+            AddChild((*parts)[0], false);
+            frame.clauses.push_back({true, AddSequence(body, tail)});
+        }
+        return nullptr;
+    }
+
+    BuildFrame& Push(BuildFrame::Kind kind, bool tail) {
+        frames_.push_back({kind, tail, {}});
+        frames_.back().begin = parts_.size();
+        return frames_.back();
+    }
+
+    void AddChild(std::shared_ptr<Object> expr, bool tail) {
+        frames_.back().children.push_back({std::move(expr), tail, nullptr});
+    }
+
+    // Adds the elements of the proper list `body`, the last one in tail position if the form is;
+    // returns their number.
+    size_t AddSequence(std::shared_ptr<Object> body, bool tail) {
+        size_t count = 0;
+        for (; body; body = As<Cell>(body)->GetSecond(), ++count) {
+            AddChild(As<Cell>(body)->GetFirst(), tail && !As<Cell>(body)->GetSecond());
+        }
+        return count;
+    }
+
+    // Pops the newest frame and its parts and returns its node.
+    NodePtr Close() {
+        BuildFrame& frame = frames_.back();
+        std::vector<NodePtr> parts;
+        parts.reserve(parts_.size() - frame.begin);
+        for (size_t i = frame.begin; i < parts_.size(); ++i) {
+            parts.push_back(std::move(parts_[i]));
+        }
+        parts_.resize(frame.begin);
+        NodePtr node;
+        switch (frame.kind) {
+            case BuildFrame::Kind::CALL: {
+                auto callee = std::move(parts[0]);
+                parts.erase(parts.begin());
+                node = std::make_unique<CallNode>(std::move(callee), std::move(parts), frame.tail);
+                break;
+            }
+            case BuildFrame::Kind::BUILTIN:
+                node = Builtin(frame.func, std::move(parts));
+                break;
+            case BuildFrame::Kind::NAMED:
+                node = std::make_unique<NamedNode>(frame.slot, std::move(parts), frame.tail);
+                break;
+            case BuildFrame::Kind::IF:
+                node = std::make_unique<IfNode>(std::move(parts[0]), std::move(parts[1]),
+                                                parts.size() == 3 ? std::move(parts[2]) : nullptr);
+                break;
+            case BuildFrame::Kind::AND:
+                node = std::make_unique<ConnectiveNode<true>>(std::move(parts));
+                break;
+            case BuildFrame::Kind::OR:
+                node = std::make_unique<ConnectiveNode<false>>(std::move(parts));
+                break;
+            case BuildFrame::Kind::SEQUENCE:
+                node = Sequence(std::move(parts));
+                break;
+            case BuildFrame::Kind::COND:
+                node = Cond(frame.clauses, std::move(parts));
+                break;
+            case BuildFrame::Kind::LAMBDA:
+                node = std::make_unique<LambdaNode>(frame.arity, Sequence(std::move(parts)),
+                                                    resolver_.Leave());
+                break;
+            case BuildFrame::Kind::DEFINE:
+                node = std::make_unique<DefineNode>(frame.slot, std::move(parts[0]));
+                break;
+        }
+        frames_.pop_back();
+        return node;
+    }
+
+    static NodePtr Builtin(Function* func, std::vector<NodePtr> args) {
+        Op op;
+        if (args.size() != 2 || !FixnumOp(func->GetName(), &op)) {
+            return std::make_unique<BuiltinNode>(func, std::move(args));
+        }
+        switch (op) {
+            case Op::ADD:
+                return Arithmetic<Op::ADD>(func, std::move(args));
+            case Op::SUB:
+                return Arithmetic<Op::SUB>(func, std::move(args));
+            case Op::MUL:
+                return Arithmetic<Op::MUL>(func, std::move(args));
+            case Op::EQ:
+                return Arithmetic<Op::EQ>(func, std::move(args));
+            case Op::LT:
+                return Arithmetic<Op::LT>(func, std::move(args));
+            case Op::GT:
+                return Arithmetic<Op::GT>(func, std::move(args));
+            case Op::LE:
+                return Arithmetic<Op::LE>(func, std::move(args));
+            default:
+                return Arithmetic<Op::GE>(func, std::move(args));
+        }
+    }
+
+    template <Op op>
+    static NodePtr Arithmetic(Function* func, std::vector<NodePtr> args) {
+        return std::make_unique<ArithmeticNode<op>>(func, std::move(args[0]), std::move(args[1]));
+    }
+
+    static NodePtr Sequence(std::vector<NodePtr> body) {
+        if (body.size() == 1) {
+            return std::move(body[0]);
+        }
+        return std::make_unique<SequenceNode>(std::move(body));
+    }
+
+    static NodePtr Cond(const std::vector<BuildFrame::Clause>& shapes, std::vector<NodePtr> parts) {
+        std::vector<CondNode::Clause> clauses;
+        size_t next = 0;
+        for (const auto& shape : shapes) {
+            CondNode::Clause clause;
+            if (shape.has_test) {
+                clause.test = std::move(parts[next++]);
+            }
+            if (shape.body) {
+                auto first = parts.begin() + next;
+                clause.body = Sequence(std::vector<NodePtr>(
+                    std::make_move_iterator(first), std::make_move_iterator(first + shape.body)));
+                next += shape.body;
+            }
+            clauses.push_back(std::move(clause));
+        }
+        return std::make_unique<CondNode>(std::move(clauses));
+    }
+
+    static NodePtr Raise(Error error) {
+        return std::make_unique<RaiseNode>(std::move(error));
+    }
+
+    static NodePtr Constant(const std::shared_ptr<Object>& value) {
+        return std::make_unique<ConstNode>(Promote(value));
+    }
+
+    NodePtr Variable(const std::string& name) {
+        Address address;
+        if (resolver_.Resolve(name, &address)) {
+            return std::make_unique<LoadNode>(address.depth, address.index);
+        }
+        if (Function* func = FindBuiltin(name)) {
+            // Builtins live as long as the program, so the pointer does not need to own them.
+            return std::make_unique<ConstNode>(
+                std::shared_ptr<Object>(std::shared_ptr<Object>(), func));
+        }
+        return std::make_unique<GlobalNode>(CurrentGlobals()->Intern(name));
+    }
+
+    std::vector<BuildFrame> frames_;
+    // The nodes of the children of all the frames, newest last.
+    std::vector<NodePtr> parts_;
+    Resolver resolver_;
+};
+
+}  // namespace
+
+std::shared_ptr<Node> CompileNodes(const std::shared_ptr<Object>& expr) {
+    if (Symbol* symbol = dynamic_cast<Symbol*>(expr.get())) {
+        // Evaluate leaves a symbol outside of any combination to Symbol::Eval, unless it is a
+        // global.
+        if (FindBuiltin(symbol->GetName())) {
+            return std::make_shared<RaiseNode>(Error::Name(symbol->GetName()));
+        }
+        return std::make_shared<GlobalNode>(CurrentGlobals()->Intern(symbol->GetName()));
+    }
+    return NodeBuilder().Run(expr);
+}
+
+ObjectResult ExecuteNodes(Node& node, size_t depth_limit, NodeStats* stats) {
+    NodeState& state = State();
+    size_t depth = state.depth;
+    size_t limit = state.limit;
+    NodeStats* prev_stats = state.stats;
+    state.limit = depth + std::min(depth_limit, kNodeDepthLimit);
+    state.stats = stats;
+    auto result = node.Execute(nullptr);
+    if (result && IsTailCall(*result)) {
+        result = Apply(std::move(state.tail_callee), state.tail_args);
+    }
+    state.depth = depth;
+    state.limit = limit;
+    state.stats = prev_stats;
+    state.tail_callee.reset();
+    state.tail_args.clear();
+    return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "object.h"
+
+// Nesting depth past which executable nodes fail even if the interpreter allows more: unlike the
+// evaluator and the VM, they recurse on the native stack.
+constexpr size_t kNodeDepthLimit = 2048;
+
+// How the nodes that specialize on the types they see have fared.
+struct NodeStats {
+    // Nodes rewritten to a version for the operand types of their first run.
+    size_t specialized = 0;
+    // Runs in which such a version met other operands and the node went back to the generic one.
+    size_t guard_failures = 0;
+};
+
+// Expression turned by CompileNodes into a tree of objects that each know how to run one form.
+// Special forms are recognised, builtins looked up, variables given their lexical address and
+// argument lists counted once, when the node is built; running it compares no names.
+class Node {
+public:
+    virtual ~Node() = default;
+
+    // The value of the expression with `env` holding the variables of the enclosing lambdas.
+    virtual ObjectResult Execute(const std::shared_ptr<Environment>& env) = 0;
+};
+
+// Compiles `expr`. Like Compile for the VM, it never fails: code that would fail to evaluate
+// becomes a node that fails in the same way. The nodes keep no object of the current arena, so
+// they can be cached and run again after it is reset. Globals get their slot in CurrentGlobals,
+// which must be the registry that the nodes later run with.
+std::shared_ptr<Node> CompileNodes(const std::shared_ptr<Object>& expr);
+
+// Runs the top-level node `node`. Fails with a runtime error once more than `depth_limit`, or
+// kNodeDepthLimit, nodes are running inside each other; calls in tail position do not count.
+// What the nodes that specialize do while running is added to `stats` if it is set.
+ObjectResult ExecuteNodes(Node& node, size_t depth_limit, NodeStats* stats = nullptr);
@@ -1,16 +1,136 @@
 #pragma once
+#include "arena.h"
+#include "arg_stack.h"
+#include "bigint.h"
+#include "flat_table.h"
+#include "globals.h"
+#include "hamt.h"
+#include "kernels.h"
+#include "records.h"
 #include "tokenizer.h"
 #include "error.h"
 #include <memory>
+#include <optional>
 #include <vector>
-#include <unordered_set>
 #include <functional>
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+class Object;
+
+// Result of reading or evaluating an expression.
+using ObjectResult = Result<std::shared_ptr<Object>>;
+
+#ifdef SCHEME_COMPRESSED_REFS
+class Object {
+#else
 class Object : public std::enable_shared_from_this<Object> {
+#endif
 public:
     virtual std::string Serialise() = 0;
-    virtual std::shared_ptr<Object> Eval() = 0;
+    virtual ObjectResult Eval() = 0;
     virtual ~Object() = default;
+
+    std::shared_ptr<Object> Self() {
+#ifdef SCHEME_COMPRESSED_REFS
+        return std::shared_ptr<Object>(std::shared_ptr<Object>(), this);
+#else
+        return shared_from_this();
+#endif
+    }
+};
+
+// Reference to an object of CompressedHeap(), stored as its offset from the heap base in units
+// of 8 bytes. Offset 0 is null.
+class CompressedRef {
+public:
+    CompressedRef() : offset_(0) {
+    }
+
+    CompressedRef(const std::shared_ptr<Object>& obj) : offset_(0) {
+        if (obj) {
+            auto diff = reinterpret_cast<char*>(obj.get()) - Base();
+            assert(diff > 0 && diff % 8 == 0 && size_t(diff) < ObjectHeap::kCompressedRange);
+            offset_ = static_cast<uint32_t>(diff >> 3);
+        }
+    }
+
+    explicit operator bool() const {
+        return offset_ != 0;
+    }
+
+    Object* Get() const {
+        if (!offset_) {
+            return nullptr;
+        }
+        return reinterpret_cast<Object*>(Base() + (uint64_t(offset_) << 3));
+    }
+
+private:
+    static char* Base() {
+        static char* base = CompressedHeap()->GetBase();
+        return base;
+    }
+
+    uint32_t offset_;
+};
+
+// What pairs and vectors hold: an owning pointer, or a 4-byte offset into the shared heap.
+#ifdef SCHEME_COMPRESSED_REFS
+using ObjectRef = CompressedRef;
+#else
+using ObjectRef = std::shared_ptr<Object>;
+
+// Frees the children of pairs and vectors iteratively: their implicit destructors recurse once per
+// level of nesting. The outermost destructor drains the queue; the ones it triggers only add to it.
+class ReleaseQueue {
+public:
+    static ReleaseQueue& Get() {
+        thread_local ReleaseQueue queue;
+        return queue;
+    }
+
+    // Objects that are still referenced elsewhere are released right away.
+    void Defer(std::shared_ptr<Object>&& obj) {
+        if (obj.use_count() == 1) {
+            pending_.push_back(std::move(obj));
+        } else {
+            obj.reset();
+        }
+    }
+
+    void Drain() {
+        if (draining_) {
+            return;
+        }
+        draining_ = true;
+        while (!pending_.empty()) {
+            // Moved out first: freeing it defers more objects, which must not happen in the middle
+            // of the pop.
+            auto obj = std::move(pending_.back());
+            pending_.pop_back();
+        }
+        draining_ = false;
+    }
+
+private:
+    std::vector<std::shared_ptr<Object>> pending_;
+    bool draining_ = false;
 };
+#endif
+
+inline std::shared_ptr<Object> Load(const std::shared_ptr<Object>& ref) {
+    return ref;
+}
+
+// Objects are owned by their arena, so the pointer does not need to share ownership.
+inline std::shared_ptr<Object> Load(CompressedRef ref) {
+    return std::shared_ptr<Object>(std::shared_ptr<Object>(), ref.Get());
+}
 
 template <class T>
 std::shared_ptr<T> As(const std::shared_ptr<Object>& obj);
@@ -18,7 +138,52 @@ std::shared_ptr<T> As(const std::shared_ptr<Object>& obj);
 template <class T>
 bool Is(const std::shared_ptr<Object>& obj);
 
-std::vector<std::shared_ptr<Object>> ArgsToVector(std::shared_ptr<Object> curr);
+ObjectResult EvalExpr(const std::shared_ptr<Object>& obj);
+
+std::string SerialiseExpr(const std::shared_ptr<Object>& obj);
+
+class Vector;
+
+// Writes nested lists and vectors with an explicit stack, so that their depth is limited only by
+// memory. Other objects are written by their own Serialise.
+class Serialiser {
+public:
+    explicit Serialiser(std::string* out) : out_(out) {
+    }
+
+    // Writes `obj`, or starts writing it if it is a list or a vector.
+    void Open(const std::shared_ptr<Object>& obj);
+    void OpenList(const std::shared_ptr<Object>& first, std::shared_ptr<Object> rest);
+    // `holder` keeps `vec` alive, if anything needs to.
+    void OpenVector(const Vector* vec, std::shared_ptr<Object> holder);
+
+    // Finishes everything that has been started.
+    void Run();
+
+private:
+    struct Frame {
+        // The first element of a list until it is written.
+        std::shared_ptr<Object> first;
+        // The rest of a list, or the holder of a vector.
+        std::shared_ptr<Object> rest;
+        const Vector* vec;
+        // Elements written so far.
+        size_t index;
+    };
+
+    std::string* out_;
+    std::vector<Frame> stack_;
+};
+
+Result<size_t> ArgCount(std::shared_ptr<Object> curr);
+
+Result<std::vector<std::shared_ptr<Object>>> ListToVector(std::shared_ptr<Object> curr);
+
+std::shared_ptr<Object> VectorToList(ArgSpan elems);
+
+std::shared_ptr<Object> Promote(const std::shared_ptr<Object>& obj, Arena* arena = CurrentArena());
+
+std::shared_ptr<Object> StoredIn(const Object* container, const std::shared_ptr<Object>& value);
 
 class Symbol : public Object {
 public:
@@ -38,28 +203,13 @@ public:
     }
 
     std::string Serialise() {
-        if (name_ == "=" || name_ == ">" || name_ == "<" || name_ == ">=" || name_ == "<=" ||
-            name_ == "and") {
-            return "#t";
-        }
-
-        if (name_ == "or") {
-            return "#f";
-        }
-        if (name_ == "+") {
-            return "0";
-        }
-        if (name_ == "*") {
-            return "1";
-        }
-        if (name_ == "/" || name_ == "-" || name_ == "min" || name_ == "max" || name_ == "abs") {
-            throw RuntimeError("");
-        }
         return name_;
     }
 
-    std::shared_ptr<Object> Eval() {
-        return std::shared_ptr<Object>(new Symbol(GetName()));
+    ObjectResult Eval() {
+        // Variables are looked up by the evaluator, which knows the environment; outside of it
+        // every symbol is unbound.
+        return Error::Name(name_);
     }
 
 private:
@@ -86,8 +236,8 @@ public:
         return name_;
     }
 
-    std::shared_ptr<Object> Eval() {
-        return std::shared_ptr<Object>(new Bool(GetName()));
+    ObjectResult Eval() {
+        return Self();
     }
 
 private:
@@ -106,11 +256,11 @@ public:
         return std::to_string(value_);
     }
 
-    std::shared_ptr<Object> Eval() {
-        return std::shared_ptr<Object>(new Number(GetValue()));
+    ObjectResult Eval() {
+        return Self();
     }
 
-    int GetValue() const {
+    int64_t GetValue() const {
         return value_;
     }
 
@@ -118,708 +268,899 @@ private:
     int64_t value_;
 };
 
-class Function : public Object {
+// Integer outside of the int64_t range. Results that fit are demoted back to Number.
+class BigNumber : public Object {
 public:
-    Function(std::string name) : name_(name) {
+    BigNumber(BigInt value) : value_(std::move(value)) {
     }
+
     std::string Serialise() {
-        return name_;
+        return value_.ToString();
     }
 
-    std::shared_ptr<Object> Eval() {
-        return std::shared_ptr<Object>(new Symbol(name_));
+    ObjectResult Eval() {
+        return Self();
     }
 
-    virtual std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) = 0;
+    const BigInt& GetValue() const {
+        return value_;
+    }
 
 private:
-    std::string name_;
+    BigInt value_;
 };
 
-class IsNumFunc : public Function {
+// Inexact real. Folds over flonums run on plain doubles, so only the final result is boxed.
+class Flonum : public Object {
 public:
-    IsNumFunc(std::string name) : Function(name) {
+    Flonum(double v) : value_(v) {
     }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.size() > 1) {
-            return std::shared_ptr<Object>(new Bool("#f"));
+
+    // Shortest representation that reads back to the same double, always with a `.` or exponent.
+    std::string Serialise() {
+        if (std::isnan(value_)) {
+            return "+nan.0";
+        }
+        if (std::isinf(value_)) {
+            return value_ > 0 ? "+inf.0" : "-inf.0";
         }
-        if (Is<Number>(args[0])) {
-            return std::shared_ptr<Object>(new Bool("#t"));
+        char buf[32];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value_);
+        std::string ans(buf, res.ptr);
+        if (ans.find_first_of(".e") == std::string::npos) {
+            ans += ".0";
         }
-        return std::shared_ptr<Object>(new Bool("#f"));
+        return ans;
     }
-};
 
-class IsBoolFunc : public Function {
-public:
-    IsBoolFunc(std::string name) : Function(name) {
+    ObjectResult Eval() {
+        return Self();
     }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.size() > 1) {
-            return std::shared_ptr<Object>(new Bool("#f"));
-        }
-        if (Is<Bool>(args[0])) {
-            return std::shared_ptr<Object>(new Bool("#t"));
-        }
-        return std::shared_ptr<Object>(new Bool("#f"));
+
+    double GetValue() const {
+        return value_;
     }
+
+private:
+    double value_;
 };
 
-class CompareFunc : public Function {
+bool IsInteger(const std::shared_ptr<Object>& obj);
+
+bool IsReal(const std::shared_ptr<Object>& obj);
+
+double ToDouble(const std::shared_ptr<Object>& obj);
+
+BigInt ToBigInt(const std::shared_ptr<Object>& obj);
+
+std::shared_ptr<Object> MakeInteger(BigInt value);
+
+// Contiguous storage for the `#(...)` type: O(1) access by index instead of walking Cells.
+class Vector : public Object {
 public:
-    CompareFunc(std::string name, const std::function<bool(int64_t, int64_t)> f)
-        : Function(name), f_(f) {
+    Vector(std::vector<std::shared_ptr<Object>> elems)
+        : elems_(std::make_move_iterator(elems.begin()), std::make_move_iterator(elems.end())) {
     }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.empty()) {
-            throw RuntimeError("");
-        }
-        if (!Is<Number>(args[0])) {
-            throw RuntimeError("");
-        }
-        if (args.size() == 1) {
-            return std::shared_ptr<Object>(new Bool("#t"));
-        }
-        for (int64_t i = 0; i < args.size() - 1; ++i) {
-            if (!Is<Number>(args[i]) || !Is<Number>(args[i + 1])) {
-                throw RuntimeError("");
-            }
-            if (!f_(As<Number>(args[i])->GetValue(), As<Number>(args[i + 1])->GetValue())) {
-                return std::shared_ptr<Object>(new Bool("#f"));
-            }
+
+    Vector(ArgSpan elems) : elems_(elems.begin(), elems.end()) {
+    }
+
+    Vector(size_t size, const std::shared_ptr<Object>& fill) : elems_(size, ObjectRef(fill)) {
+    }
+
+#ifndef SCHEME_COMPRESSED_REFS
+    ~Vector() {
+        auto& queue = ReleaseQueue::Get();
+        for (auto& elem : elems_) {
+            queue.Defer(std::move(elem));
         }
-        return std::shared_ptr<Object>(new Bool("#t"));
+        queue.Drain();
     }
+#endif
 
-private:
-    const std::function<bool(int64_t, int64_t)> f_;
-};
+    size_t Size() const {
+        return elems_.size();
+    }
 
-class ArifmFunc : public Function {
-public:
-    ArifmFunc(std::string name, const std::function<int64_t(int64_t, int64_t)> f)
-        : Function(name), f_(f) {
+    std::shared_ptr<Object> Get(size_t i) const {
+        return Load(elems_[i]);
     }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.empty()) {
-            throw RuntimeError("");
-        }
-        if (!Is<Number>(args[0])) {
-            throw RuntimeError("");
-        }
-        if (args.size() == 1) {
-            return args[0];
-        }
-        int64_t ans = As<Number>(args[0])->GetValue();
-        for (int64_t i = 1; i < args.size(); ++i) {
-            if (!Is<Number>(args[i])) {
-                throw RuntimeError("");
-            }
-            ans = f_(ans, As<Number>(args[i])->GetValue());
-        }
-        return std::shared_ptr<Object>(new Number(ans));
+
+    void Set(size_t i, const std::shared_ptr<Object>& value) {
+        elems_[i] = value;
+    }
+
+    std::string Serialise() {
+        std::string ans;
+        Serialiser serialiser(&ans);
+        serialiser.OpenVector(this, nullptr);
+        serialiser.Run();
+        return ans;
+    }
+
+    // Vector literals are self-evaluating.
+    ObjectResult Eval() {
+        return Self();
     }
 
 private:
-    const std::function<int64_t(int64_t, int64_t)> f_;
+    std::vector<ObjectRef> elems_;
 };
 
-class AndFunc : public Function {
+// Byte string. Short contents sit in std::string's inline buffer; string-append of longer ones
+// builds a rope node in O(1), which is flattened once, on the first access to the bytes.
+class String : public Object {
 public:
-    AndFunc(std::string name1, std::string name) : Function(name1) {
+    // Pieces shorter than this together are copied rather than linked.
+    static constexpr size_t kMinRopeSize = 64;
+
+    String(std::string value) : flat_(std::move(value)), size_(flat_.size()) {
     }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.empty()) {
-            throw RuntimeError("");
+
+    String(const std::shared_ptr<String>& left, const std::shared_ptr<String>& right)
+        : left_(left), right_(right), size_(left->Size() + right->Size()) {
+    }
+
+#ifndef SCHEME_COMPRESSED_REFS
+    // Releases the children iteratively: a rope built by repeated appends is as deep as it is long.
+    ~String() {
+        if (!left_) {
+            return;
         }
-        if (args.size() == 1) {
-            auto s = args[0];
-            if (Is<Bool>(s)) {
-                if (As<Bool>(s)->GetVal()) {
-                    return s;
+        std::vector<std::shared_ptr<Object>> pending{std::move(left_), std::move(right_)};
+        while (!pending.empty()) {
+            auto curr = std::move(pending.back());
+            pending.pop_back();
+            if (curr.use_count() == 1) {
+                auto str = static_cast<String*>(curr.get());
+                if (str->left_) {
+                    pending.push_back(std::move(str->left_));
+                    pending.push_back(std::move(str->right_));
                 }
-                return std::shared_ptr<Object>(new Bool("#f"));
             }
-            return s;
         }
-        for (int64_t i = 0; i < args.size(); ++i) {
-            auto s = args[i];
-            if (Is<Bool>(s)) {
-                if (!As<Bool>(s)->GetVal()) {
-                    return std::shared_ptr<Object>(new Bool("#f"));
-                }
-            }
+    }
+#endif
+
+    static std::shared_ptr<String> Concat(const std::shared_ptr<String>& left,
+                                          const std::shared_ptr<String>& right) {
+        if (left->Size() + right->Size() < kMinRopeSize) {
+            return Make<String>(left->Flat() + right->Flat());
         }
-        return args.back();
+        return Make<String>(left, right);
     }
-};
 
-class OrFunc : public Function {
-public:
-    OrFunc(std::string name1, std::string name) : Function(name1) {
+    size_t Size() const {
+        return size_;
     }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.empty()) {
-            throw RuntimeError("");
-        }
-        if (args.size() == 1) {
-            auto s = args[0];
-            if (Is<Bool>(s)) {
-                if (As<Bool>(s)->GetVal()) {
-                    return std::shared_ptr<Object>(new Bool("#t"));
-                }
-                return s;
-            }
-            return s;
+
+    const std::string& Flat() {
+        if (!left_) {
+            return flat_;
         }
-        for (int64_t i = 0; i < args.size(); ++i) {
-            auto s = args[i];
-            if (Is<Bool>(s)) {
-                if (As<Bool>(s)->GetVal()) {
-                    return std::shared_ptr<Object>(new Bool("#t"));
-                }
+        std::string ans;
+        ans.reserve(size_);
+        std::vector<String*> stack{Child(right_), Child(left_)};
+        while (!stack.empty()) {
+            String* curr = stack.back();
+            stack.pop_back();
+            if (curr->left_) {
+                stack.push_back(Child(curr->right_));
+                stack.push_back(Child(curr->left_));
+            } else {
+                ans += curr->flat_;
             }
         }
-        return args.back();
+        flat_ = std::move(ans);
+        left_ = ObjectRef();
+        right_ = ObjectRef();
+        return flat_;
     }
-};
 
-class OneArgsIntFunc : public Function {
-public:
-    OneArgsIntFunc(std::string name, const std::function<int64_t(int64_t)> f)
-        : Function(name), f_(f) {
-    }
-    std::shared_ptr<Object> Apply(std::vector<std::shared_ptr<Object>> args) {
-        if (args.empty()) {
-            throw RuntimeError("");
+    // Position of the first occurrence of `pattern`, or npos. memchr skips to the candidates
+    // for the first byte, so only those are compared in full.
+    size_t Find(const std::string& pattern) {
+        const std::string& text = Flat();
+        if (pattern.empty()) {
+            return 0;
+        }
+        if (pattern.size() > text.size()) {
+            return std::string::npos;
         }
-        if (!Is<Number>(args[0])) {
-            throw RuntimeError("");
+        const char* begin = text.data();
+        const char* last = begin + (text.size() - pattern.size());
+        const char* curr = begin;
+        while (curr <= last) {
+            curr = static_cast<const char*>(memchr(curr, pattern[0], last - curr + 1));
+            if (!curr) {
+                break;
+            }
+            if (memcmp(curr + 1, pattern.data() + 1, pattern.size() - 1) == 0) {
+                return curr - begin;
+            }
+            ++curr;
         }
-        if (args.size() > 1) {
-            throw RuntimeError("");
+        return std::string::npos;
+    }
+
+    std::string Serialise() {
+        std::string ans = "\"";
+        for (char c : Flat()) {
+            if (c == '"' || c == '\\') {
+                ans += '\\';
+                ans += c;
+            } else if (c == '\n') {
+                ans += "\\n";
+            } else if (c == '\t') {
+                ans += "\\t";
+            } else if (c == '\r') {
+                ans += "\\r";
+            } else {
+                ans += c;
+            }
         }
-        int64_t ans = f_(As<Number>(args[0])->GetValue());
-        return std::shared_ptr<Object>(new Number(ans));
+        return ans + "\"";
+    }
+
+    // String literals are self-evaluating.
+    ObjectResult Eval() {
+        return Self();
     }
 
 private:
-    const std::function<int64_t(int64_t)> f_;
+    static String* Child(const ObjectRef& ref) {
+        return static_cast<String*>(Load(ref).get());
+    }
+
+    std::string flat_;
+    ObjectRef left_;
+    ObjectRef right_;
+    size_t size_;
 };
 
-class CloseBracket : public Object {
+// Raw bytes, one per element. Copy, fill, compare and search go through the C library's
+// memcpy, memset, memcmp and memchr, which process a vector register of bytes per step.
+class Bytevector : public Object {
 public:
-    CloseBracket(Token* token) {
+    Bytevector(std::vector<uint8_t> bytes) : bytes_(std::move(bytes)) {
     }
-    CloseBracket() {
+
+    Bytevector(size_t size, uint8_t fill) : bytes_(size, fill) {
+    }
+
+    Bytevector(const uint8_t* data, size_t size) : bytes_(data, data + size) {
+    }
+
+    size_t Size() const {
+        return bytes_.size();
+    }
+
+    const uint8_t* Data() const {
+        return bytes_.data();
+    }
+
+    uint8_t Get(size_t i) const {
+        return bytes_[i];
+    }
+
+    void Set(size_t i, uint8_t value) {
+        bytes_[i] = value;
+    }
+
+    void Fill(uint8_t value) {
+        memset(bytes_.data(), value, bytes_.size());
+    }
+
+    bool Equals(const Bytevector& other) const {
+        return bytes_.size() == other.bytes_.size() &&
+               (bytes_.empty() || memcmp(bytes_.data(), other.bytes_.data(), bytes_.size()) == 0);
+    }
+
+    // Position of the first `value` at or after `start`, or npos.
+    size_t Find(uint8_t value, size_t start) const {
+        if (start >= bytes_.size()) {
+            return std::string::npos;
+        }
+        auto found = static_cast<const uint8_t*>(
+            memchr(bytes_.data() + start, value, bytes_.size() - start));
+        return found ? found - bytes_.data() : std::string::npos;
     }
 
     std::string Serialise() {
-        return ")";
+        std::string ans = "#u8(";
+        for (size_t i = 0; i < bytes_.size(); ++i) {
+            if (i > 0) {
+                ans += " ";
+            }
+            ans += std::to_string(bytes_[i]);
+        }
+        return ans + ")";
     }
 
-    std::shared_ptr<Object> Eval() {
-        return std::shared_ptr<Object>(new CloseBracket());
+    // Bytevector literals are self-evaluating.
+    ObjectResult Eval() {
+        return Self();
     }
+
+private:
+    std::vector<uint8_t> bytes_;
 };
 
-class Cell : public Object {
+// Instance of a define-record-type, with one slot per field fixed at construction.
+class Record : public Object {
 public:
-    Cell(std::shared_ptr<Object> a, std::shared_ptr<Object> b) : first_(a), second_(b) {
+    Record(const RecordType* type, const std::vector<std::shared_ptr<Object>>& slots)
+        : type_(type), slots_(slots.begin(), slots.end()) {
     }
 
-    std::shared_ptr<Object> GetFirst() const {
-        return first_;
+    const RecordType* GetType() const {
+        return type_;
     }
-    std::shared_ptr<Object> GetSecond() const {
-        return second_;
+
+    size_t Size() const {
+        return slots_.size();
     }
 
-    void GetFirst(std::shared_ptr<Object> f) {
-        first_ = f;
+    std::shared_ptr<Object> Get(size_t i) const {
+        return Load(slots_[i]);
     }
-    void SetSecond(std::shared_ptr<Object> s) {
-        second_ = s;
+
+    void Set(size_t i, const std::shared_ptr<Object>& value) {
+        slots_[i] = value;
     }
 
     std::string Serialise() {
-        if (!first_ && !second_) {
-            return "()";
-        }
-        if (!first_) {
-            throw RuntimeError("");
-        }
-        if (second_) {
-            if (!Is<Cell>(first_) && !Is<Cell>(second_)) {
-                return first_->Serialise() + " . " + second_->Serialise();
-            }
-        }
-        std::string ans;
-        auto curr = std::shared_ptr<Object>(new Cell{first_, second_});
-        while (curr) {
-            if (Is<Cell>(curr)) {
-                auto f = As<Cell>(curr)->GetFirst();
-                auto s = As<Cell>(curr)->GetSecond();
-                if (s) {
-                    if (!Is<Cell>(f) && !Is<Cell>(s)) {
-                        ans += (f->Serialise() + " . " + s->Serialise());
-                        curr = nullptr;
-                    } else {
-                        curr = As<Cell>(curr)->GetSecond();
-                        ans += f->Serialise();
-                    }
-                } else {
-                    ans += f->Serialise();
-                    curr = nullptr;
-                }
-                if (curr) {
-                    ans += " ";
-                }
-            } else {
-                ans += curr->Serialise();
-                curr = nullptr;
-            }
+        std::string ans = "#<" + type_->name;
+        for (const auto& slot : slots_) {
+            ans += " " + SerialiseExpr(Load(slot));
         }
-        return ans;
+        return ans + ">";
     }
 
-    std::shared_ptr<Object> Eval() {
-        if (!first_) {
-            throw RuntimeError("");
-        }
-        if (Is<Cell>(first_)) {
-            return first_;
-        }
-        auto f = first_->Eval();
-        if (Is<Cell>(second_)) {
-            if (Is<Symbol>(As<Cell>(second_)->GetFirst())) {
-                second_ = second_->Eval();
-            }
-        }
-        if (Is<Number>(f)) {
-            throw RuntimeError("");
-            if (second_) {
-                throw RuntimeError("");
-                //                auto s = second_->Eval();
-                //                return std::shared_ptr<Object>(new Cell{f, s});
-            } else {
-                return f;
-            }
-        }
-        if (Is<Bool>(f)) {
-            if (second_) {
-                throw RuntimeError("");
-                //                auto s = second_->Eval();
-                //                return std::shared_ptr<Object>(new Cell{f, s});
-            } else {
-                return f;
-            }
-        }
-        if (Is<Symbol>(f)) {
-            auto name = As<Symbol>(f)->GetName();
-            if (name == "quote") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                //                if (Is<Number>(second_)) {
-                //                    return std::shared_ptr<Object>(new
-                //                    Number(As<Number>(second_)->GetValue()));
-                //                }
-                //                if (Is<Symbol>(second_)) {
-                //                    return std::shared_ptr<Object>(new
-                //                    Symbol(As<Symbol>(second_)->GetName()));
-                //                }
-                //                if (Is<Bool>(second_)) {
-                //                    return std::shared_ptr<Object>(new
-                //                    Bool(As<Bool>(second_)->GetName()));
-                //                }
-                //
-                //                throw RuntimeError("");
-                if (Is<Cell>(second_)) {
-                    if (!As<Cell>(second_)->GetSecond() &&
-                        Is<Cell>(As<Cell>(second_)->GetFirst())) {
-                        return As<Cell>(second_)->GetFirst();
-                    }
-                }
-                return second_;
+    ObjectResult Eval() {
+        return Self();
+    }
 
-                //            auto ans = As<Symbol>(f)->GetName();
-                //            ans += " ";
-                //            ans += second_->Serialise();
-                //            return std::shared_ptr<Object>(new Symbol(ans));
-            }
-            if (name == "number?") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto args = ArgsToVector(second_);
-                auto func = IsNumFunc("number?");
-                auto ans = func.Apply(args);
-                return ans;
-            }
-            if (name == "boolean?") {
-                if (!second_) {
-                    // return std::shared_ptr<Bool>(new Bool("#f"));
-                    throw RuntimeError("");
-                }
-                auto s = ArgsToVector(second_);
-                if (s.size() > 1) {
-                    throw RuntimeError("");
-                }
-                if (s.empty()) {
-                    return std::shared_ptr<Bool>(new Bool("#f"));
-                }
-                if (!Is<Bool>(s[0])) {
-                    return std::shared_ptr<Bool>(new Bool("#f"));
-                }
-                return std::shared_ptr<Bool>(new Bool("#t"));
-            }
-            if (name == "pair?") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = ArgsToVector(second_);
-                if (s.size() == 2) {
-                    return std::shared_ptr<Bool>(new Bool("#t"));
-                }
+private:
+    const RecordType* type_;
+    std::vector<ObjectRef> slots_;
+};
 
-                return std::shared_ptr<Bool>(new Bool("#f"));
-            }
-            if (name == "null?") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = ArgsToVector(second_);
-                if (!s.empty()) {
-                    return std::shared_ptr<Bool>(new Bool("#f"));
-                }
+ObjectResult DefineRecordType(const std::shared_ptr<Object>& form);
 
-                return std::shared_ptr<Bool>(new Bool("#t"));
-            }
-            if (name == "list?") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = second_;
-                while (Is<Cell>(s)) {
-                    if (Is<Cell>(As<Cell>(s)->GetFirst())) {
-                        return std::shared_ptr<Bool>(new Bool("#f"));
-                    }
-                    s = As<Cell>(s)->GetSecond();
-                }
-                if (!s) {
-                    return std::shared_ptr<Bool>(new Bool("#t"));
-                }
-                return std::shared_ptr<Bool>(new Bool("#f"));
-            }
-            if (name == "cons") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = ArgsToVector(second_);
-                if (s.size() != 2) {
-                    throw RuntimeError("");
-                }
+ObjectResult ApplyRecordProc(const RecordProc& proc, ArgSpan args);
 
-                return std::shared_ptr<Object>(new Cell{s[0], s[1]});
-            }
-            if (name == "car") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = ArgsToVector(second_);
-                if (s.empty()) {
-                    throw RuntimeError("");
-                }
+// The equivalences of eq?, eqv? and equal?. Symbols, booleans and fixnums are not interned, so
+// eq? compares them by value as well; everything else is compared by identity.
+enum class Equivalence { EQ, EQV, EQUAL };
 
-                return s[0];
-            }
-            if (name == "cdr") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = second_;
-                if (!Is<Cell>(s)) {
-                    throw RuntimeError("");
-                }
-                if (!As<Cell>(s)->GetFirst() && !As<Cell>(s)->GetSecond()) {
-                    throw RuntimeError("");
-                }
-                if (!Is<Cell>(As<Cell>(s)->GetSecond())) {
-                    if (!As<Cell>(s)->GetSecond()) {
-                        return std::shared_ptr<Object>(new Cell{nullptr, nullptr});
-                    }
-                    if (!Is<Cell>(s)) {
-                        throw RuntimeError("");
-                    }
-                    return As<Cell>(s)->GetSecond();
-                }
-                if (Is<Cell>(As<Cell>(s)->GetSecond())) {
-                    if (!Is<Cell>(s)) {
-                        throw RuntimeError("");
-                    }
-                    s = As<Cell>(s)->GetSecond();
-                }
+bool IsEquivalent(const std::shared_ptr<Object>& a, const std::shared_ptr<Object>& b,
+                  Equivalence mode);
 
-                return s;
-            }
-            if (name == "list-tail") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = second_;
-                if (!Is<Cell>(s)) {
-                    throw RuntimeError("");
-                }
-                if (!As<Cell>(s)->GetFirst() && !As<Cell>(s)->GetSecond()) {
-                    throw RuntimeError("");
-                }
-                while (Is<Cell>(As<Cell>(s)->GetSecond())) {
-                    s = As<Cell>(s)->GetSecond();
-                }
-                if (!Is<Cell>(s)) {
-                    throw RuntimeError("");
-                }
-                int64_t index = As<Number>((As<Cell>(s)->GetFirst()))->GetValue();
-                s = As<Cell>(second_)->GetFirst();
-                for (int64_t i = 0; i < index; ++i) {
-                    if (!Is<Cell>(s)) {
-                        throw RuntimeError("");
-                    }
-                    s = As<Cell>(s)->GetSecond();
-                }
-                if (!s) {
-                    return std::shared_ptr<Object>(new Cell{nullptr, nullptr});
-                }
-                return s;
-            }
-            if (name == "list-ref") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto s = second_;
-                if (!Is<Cell>(s)) {
-                    throw RuntimeError("");
-                }
-                if (!As<Cell>(s)->GetFirst() && !As<Cell>(s)->GetSecond()) {
-                    throw RuntimeError("");
-                }
-                while (Is<Cell>(As<Cell>(s)->GetSecond())) {
-                    s = As<Cell>(s)->GetSecond();
-                }
-                int64_t index = As<Number>((As<Cell>(s)->GetFirst()))->GetValue();
-                if (!Is<Cell>(s)) {
-                    throw RuntimeError("");
-                }
-                s = As<Cell>(second_)->GetFirst();
-                for (int64_t i = 0; i < index; ++i) {
-                    if (!Is<Cell>(s)) {
-                        throw RuntimeError("");
-                    }
-                    s = As<Cell>(s)->GetSecond();
-                }
-                if (!s) {
-                    throw RuntimeError("");
-                }
-                if (!Is<Cell>(s)) {
-                    throw RuntimeError("");
-                }
-                return As<Cell>(s)->GetFirst();
-            }
-            if (name == "list") {
-                if (!second_) {
-                    return std::shared_ptr<Object>(new Cell{nullptr, nullptr});
-                }
-                auto s = second_;
-                if (!Is<Cell>(s)) {
-                    return std::shared_ptr<Object>(new Cell{s, nullptr});
-                }
+// Consistent with IsEquivalent for the same mode; equal? hashes lists and vectors by contents.
+size_t HashObject(const std::shared_ptr<Object>& obj, Equivalence mode);
 
-                return s;
-            }
-            if (name == "=") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a == b; };
-                auto func = CompareFunc("=", f);
-                auto ans = func.Apply(args);
-                return ans;
-            }
-            if (name == ">") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a > b; };
-                auto func = CompareFunc("=", f);
-                auto ans = func.Apply(args);
-                return ans;
-            }
-            if (name == "<") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a < b; };
-                auto func = CompareFunc("=", f);
-                auto ans = func.Apply(args);
-                return ans;
-            }
-            if (name == ">=") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a >= b; };
-                auto func = CompareFunc("=", f);
-                auto ans = func.Apply(args);
-                return ans;
-            }
-            if (name == "<=") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a <= b; };
-                auto func = CompareFunc("=", f);
-                auto ans = func.Apply(args);
-                return ans;
-            }
-            if (name == "+") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a + b; };
-                auto func = ArifmFunc("+", f);
-                auto ans = func.Apply(args);
-                return ans;
+struct ObjectHash {
+    Equivalence mode;
+    size_t operator()(const ObjectRef& key) const {
+        return HashObject(Load(key), mode);
+    }
+};
+
+struct ObjectEq {
+    Equivalence mode;
+    bool operator()(const ObjectRef& a, const ObjectRef& b) const {
+        return IsEquivalent(Load(a), Load(b), mode);
+    }
+};
+
+class HashTable : public Object {
+public:
+    HashTable(Equivalence mode) : table_(ObjectHash{mode}, ObjectEq{mode}), mode_(mode) {
+    }
+
+    size_t Size() const {
+        return table_.Size();
+    }
+
+    std::shared_ptr<Object> Get(const std::shared_ptr<Object>& key) {
+        ObjectRef* value = table_.Find(key);
+        return value ? Load(*value) : nullptr;
+    }
+
+    bool Contains(const std::shared_ptr<Object>& key) {
+        return table_.Find(key) != nullptr;
+    }
+
+    void Set(const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& value) {
+        table_.Insert(key, value);
+    }
+
+    bool Erase(const std::shared_ptr<Object>& key) {
+        return table_.Erase(key);
+    }
+
+    template <class F>
+    void ForEach(F&& f) const {
+        table_.ForEach([&](const ObjectRef& key, const ObjectRef& value) { f(Load(key), Load(value)); });
+    }
+
+    Equivalence GetMode() const {
+        return mode_;
+    }
+
+    std::string Serialise() {
+        return "#<hash-table>";
+    }
+
+    ObjectResult Eval() {
+        return Self();
+    }
+
+private:
+    FlatTable<ObjectRef, ObjectRef, ObjectHash, ObjectEq> table_;
+    Equivalence mode_;
+};
+
+// Immutable map keyed by equal?. Every update returns a new map sharing most of the old one.
+class PersistentMap : public Object {
+public:
+    using Trie = Hamt<ObjectRef, ObjectRef, ObjectHash, ObjectEq>;
+
+    PersistentMap() : map_(ObjectHash{Equivalence::EQUAL}, ObjectEq{Equivalence::EQUAL}) {
+    }
+
+    PersistentMap(Trie map) : map_(std::move(map)) {
+    }
+
+    const Trie& GetTrie() const {
+        return map_;
+    }
+
+    size_t Size() const {
+        return map_.Size();
+    }
+
+    // nullptr if `key` is missing.
+    const ObjectRef* Find(const std::shared_ptr<Object>& key) const {
+        return map_.Find(key);
+    }
+
+    template <class F>
+    void ForEach(F&& f) const {
+        map_.ForEach([&](const ObjectRef& key, const ObjectRef& value) { f(Load(key), Load(value)); });
+    }
+
+    std::string Serialise() {
+        return "#<map>";
+    }
+
+    ObjectResult Eval() {
+        return Self();
+    }
+
+private:
+    Trie map_;
+};
+
+class Function : public Object {
+public:
+    Function(std::string name) : name_(name) {
+    }
+
+    const std::string& GetName() const {
+        return name_;
+    }
+
+    std::string Serialise() {
+        return name_;
+    }
+
+    ObjectResult Eval() {
+        return Make<Symbol>(name_);
+    }
+
+    virtual ObjectResult Apply(ArgSpan args) = 0;
+
+private:
+    std::string name_;
+};
+
+// Variables bound by one procedure call, chained to the environment that the procedure was
+// created in. Top-level expressions run in the null environment, where only builtins and globals
+// are seen.
+class Environment {
+public:
+    // `params` is the proper list of parameter symbols, bound to `args` in order.
+    Environment(std::shared_ptr<Object> params, ArgSpan args, std::shared_ptr<Environment> parent)
+        : params_(std::move(params)), values_(args.begin(), args.end()), parent_(std::move(parent)) {
+    }
+
+    // Flat frame of code that resolved its variables when it was compiled, which Find does not
+    // see into.
+    Environment(ArgSpan values, std::shared_ptr<Environment> parent)
+        : params_(), values_(values.begin(), values.end()), parent_(std::move(parent)) {
+    }
+
+    // The value of `name` in the innermost environment that binds it, nullptr if none does.
+    const std::shared_ptr<Object>* Find(const std::string& name) const;
+
+    // The value at `index` of the environment `depth` levels out, for code that resolved the
+    // name beforehand.
+    const std::shared_ptr<Object>& Get(size_t depth, size_t index) const {
+        const Environment* env = this;
+        for (; depth; --depth) {
+            env = env->parent_.get();
+        }
+        return env->values_[index];
+    }
+
+private:
+    friend std::shared_ptr<Environment> Promote(const std::shared_ptr<Environment>& env,
+                                                Arena* arena);
+
+    std::shared_ptr<Object> params_;
+    std::vector<std::shared_ptr<Object>> values_;
+    std::shared_ptr<Environment> parent_;
+};
+
+// Copy of `env`, its values and its parents that survives the reset of `arena`.
+std::shared_ptr<Environment> Promote(const std::shared_ptr<Environment>& env, Arena* arena);
+
+// Procedure made by evaluating a lambda, with whichever engine.
+class Procedure : public Object {
+public:
+    std::string Serialise() {
+        return "#<procedure>";
+    }
+
+    ObjectResult Eval() {
+        return Self();
+    }
+
+    // Copy that survives the reset of `arena`, for Promote; called with the arena suspended.
+    virtual std::shared_ptr<Object> Promote(Arena* arena) = 0;
+};
+
+// Procedure made by lambda. Its body is evaluated by the evaluator itself, so that a call in tail
+// position of the body replaces the caller instead of nesting in it.
+class Closure : public Procedure {
+public:
+    Closure(std::shared_ptr<Object> params, size_t arity, std::shared_ptr<Object> body,
+            std::shared_ptr<Environment> env)
+        : params_(std::move(params)), arity_(arity), body_(std::move(body)), env_(std::move(env)) {
+    }
+
+    const std::shared_ptr<Object>& GetParams() const {
+        return params_;
+    }
+
+    size_t GetArity() const {
+        return arity_;
+    }
+
+    // Non-empty proper list of expressions.
+    const std::shared_ptr<Object>& GetBody() const {
+        return body_;
+    }
+
+    const std::shared_ptr<Environment>& GetEnv() const {
+        return env_;
+    }
+
+    std::shared_ptr<Object> Promote(Arena* arena) override;
+
+private:
+    std::shared_ptr<Object> params_;
+    size_t arity_;
+    std::shared_ptr<Object> body_;
+    std::shared_ptr<Environment> env_;
+};
+
+class IsNumFunc : public Function {
+public:
+    IsNumFunc(std::string name) : Function(name) {
+    }
+    ObjectResult Apply(ArgSpan args) {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (IsReal(args[0])) {
+            return Make<Bool>("#t");
+        }
+        return Make<Bool>("#f");
+    }
+};
+
+class IsBoolFunc : public Function {
+public:
+    IsBoolFunc(std::string name) : Function(name) {
+    }
+    ObjectResult Apply(ArgSpan args) {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        if (Is<Bool>(args[0])) {
+            return Make<Bool>("#t");
+        }
+        return Make<Bool>("#f");
+    }
+};
+
+// Arguments are unboxed into blocks of this many fixnums for the kernels in kernels.h; calls
+// with fewer arguments stay on the scalar loops.
+constexpr size_t kUnboxBlock = 256;
+constexpr size_t kMinKernelArgs = 8;
+
+// Copies the values of the fixnums args[start], args[start + 1], ... into `block`, stopping at
+// the first other argument or after `size` of them. Returns how many were copied.
+inline size_t UnboxFixnums(ArgSpan args, size_t start, int64_t* block, size_t size) {
+    size_t count = 0;
+    for (; count < size && start + count < args.size(); ++count) {
+        auto* number = dynamic_cast<Number*>(args[start + count].get());
+        if (!number) {
+            break;
+        }
+        block[count] = number->GetValue();
+    }
+    return count;
+}
+
+// Bignum and flonum operands are compared first, and `chain` is checked on the sign of the
+// result against 0. NaN compares false.
+template <Chain chain>
+class CompareFunc : public Function {
+public:
+    CompareFunc(std::string name) : Function(name) {
+    }
+    ObjectResult Apply(ArgSpan args) {
+        if (args.size() >= kMinKernelArgs) {
+            // Consecutive blocks share one element, so that every adjacent pair is checked. The
+            // blocks after a failed one are still unboxed, since any non-number is an error.
+            int64_t block[kUnboxBlock];
+            bool ok = true;
+            size_t i = 0;
+            while (i + 1 < args.size()) {
+                size_t size = std::min(kUnboxBlock, args.size() - i);
+                size_t count = UnboxFixnums(args, i, block, size);
+                if (count < size) {
+                    break;
+                }
+                ok = ok && IsChainInt64(chain, block, count);
+                i += count - 1;
             }
-            if (name == "-") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a - b; };
-                auto func = ArifmFunc("-", f);
-                auto ans = func.Apply(args);
-                return ans;
+            if (i + 1 >= args.size()) {
+                return Make<Bool>(ok ? "#t" : "#f");
             }
-            if (name == "*") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a * b; };
-                auto func = ArifmFunc("*", f);
-                auto ans = func.Apply(args);
-                return ans;
+        }
+        bool has_big = false;
+        bool has_float = false;
+        for (const auto& arg : args) {
+            if (dynamic_cast<Number*>(arg.get())) {
+                continue;
             }
-            if (name == "/") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return a / b; };
-                auto func = ArifmFunc("/", f);
-                auto ans = func.Apply(args);
-                return ans;
+            bool is_big = dynamic_cast<BigNumber*>(arg.get());
+            bool is_float = dynamic_cast<Flonum*>(arg.get());
+            if (!is_big && !is_float) {
+                return Error::Runtime("not a number");
             }
-            if (name == "min") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return std::min(a, b); };
-                auto func = ArifmFunc("min", f);
-                auto ans = func.Apply(args);
-                return ans;
+            has_big |= is_big;
+            has_float |= is_float;
+        }
+        for (size_t i = 0; i + 1 < args.size(); ++i) {
+            bool ok;
+            if (has_float) {
+                double a = ToDouble(args[i]);
+                double b = ToDouble(args[i + 1]);
+                ok = !std::isnan(a) && !std::isnan(b) && Holds<chain>((a > b) - (a < b), 0);
+            } else if (has_big) {
+                ok = Holds<chain>(Compare(ToBigInt(args[i]), ToBigInt(args[i + 1])), 0);
+            } else {
+                ok = Holds<chain>(static_cast<Number*>(args[i].get())->GetValue(),
+                                  static_cast<Number*>(args[i + 1].get())->GetValue());
             }
-            if (name == "max") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a, int64_t b) { return std::max(a, b); };
-                auto func = ArifmFunc("max", f);
-                auto ans = func.Apply(args);
-                return ans;
+            if (!ok) {
+                return Make<Bool>("#f");
             }
-            if (name == "abs") {
-                if (!second_) {
-                    throw RuntimeError("");
-                }
-                auto args = ArgsToVector(second_);
-                auto f = [](int64_t a) { return std::abs(a); };
-                auto func = OneArgsIntFunc("abs", f);
-                auto ans = func.Apply(args);
-                return ans;
+        }
+        return Make<Bool>("#t");
+    }
+};
+
+// Folds the arguments left to right with the static members of `Op`. `Op::Fixnum` reports
+// overflow like __builtin_add_overflow; from the first overflow or bignum operand on, `Op::Big`
+// is used instead, which may also return an Error. Once a flonum is met the rest of the fold runs on unboxed doubles with
+// `Op::Flo`. Without arguments the result is `identity`, or an error if there is none. An
+// optional `Op::Fold` folds a whole block of fixnums at once.
+template <class Op>
+class ArifmFunc : public Function {
+public:
+    ArifmFunc(std::string name, std::optional<int64_t> identity = std::nullopt)
+        : Function(name), identity_(identity) {
+    }
+    ObjectResult Apply(ArgSpan args) {
+        if (args.empty()) {
+            if (identity_) {
+                return Make<Number>(*identity_);
             }
-            if (name == "not") {
-                if (!second_) {
-                    throw RuntimeError("");
+            return Error::Runtime("no arguments");
+        }
+        if (!IsReal(args[0])) {
+            return Error::Runtime("not a number");
+        }
+        if (args.size() == 1) {
+            return args[0];
+        }
+        size_t i = 1;
+        double flo_ans;
+        if (Is<Flonum>(args[0])) {
+            flo_ans = As<Flonum>(args[0])->GetValue();
+        } else {
+            int64_t ans = 0;
+            if (auto* first = dynamic_cast<Number*>(args[0].get())) {
+                ans = first->GetValue();
+                if constexpr (requires(const int64_t* data, int64_t* out) {
+                                  Op::Fold(0, data, 0, out);
+                              }) {
+                    // Runs of fixnums go through the kernel a block at a time. A block that
+                    // overflows is left to the loop below, which finds the exact operand.
+                    int64_t block[kUnboxBlock];
+                    while (args.size() >= kMinKernelArgs && i < args.size()) {
+                        size_t count = UnboxFixnums(args, i, block, kUnboxBlock);
+                        if (count == 0 || Op::Fold(ans, block, count, &ans)) {
+                            break;
+                        }
+                        i += count;
+                    }
                 }
-                if (Is<Cell>(second_)) {
-                    if (!As<Cell>(second_)->GetFirst() && !As<Cell>(second_)->GetSecond()) {
-                        return std::shared_ptr<Object>(new Bool("#f"));
+                for (; i < args.size(); ++i) {
+                    auto* arg = dynamic_cast<Number*>(args[i].get());
+                    int64_t next;
+                    if (!arg || Op::Fixnum(ans, arg->GetValue(), &next)) {
+                        break;
                     }
+                    ans = next;
                 }
-                auto s = ArgsToVector(second_);
-                if (s.size() > 1) {
-                    throw RuntimeError("");
+                if (i == args.size()) {
+                    return Make<Number>(ans);
                 }
-                if (s.empty()) {
-                    throw RuntimeError("");
+            }
+            BigInt big_ans = Is<Number>(args[0]) ? BigInt(ans) : ToBigInt(args[0]);
+            for (; i < args.size(); ++i) {
+                if (Is<Flonum>(args[i])) {
+                    break;
                 }
-                if (Is<Bool>(s[0])) {
-                    if (As<Bool>(s[0])->GetVal()) {
-                        return std::shared_ptr<Object>(new Bool("#f"));
-                    }
-                    return std::shared_ptr<Object>(new Bool("#t"));
+                if (!IsInteger(args[i])) {
+                    return Error::Runtime("not a number");
                 }
-                return std::shared_ptr<Object>(new Bool("#f"));
-            }
-            if (name == "and") {
-                if (!second_) {
-                    return f;
+                Result<BigInt> next = Op::Big(big_ans, ToBigInt(args[i]));
+                if (!next) {
+                    return std::move(next.GetError());
                 }
-                auto args = ArgsToVector(second_);
-                auto func = AndFunc(std::string(), "and");
-                auto ans = func.Apply(args);
-                return ans;
+                big_ans = std::move(*next);
             }
-            if (name == "or") {
-                if (!second_) {
-                    return f;
-                }
-                auto args = ArgsToVector(second_);
-                auto func = OrFunc(std::string(), "or");
-                auto ans = func.Apply(args);
-                return ans;
+            if (i == args.size()) {
+                return MakeInteger(std::move(big_ans));
             }
-            if (!second_) {
-                return std::shared_ptr<Object>(new Cell{first_, nullptr});
+            flo_ans = big_ans.ToDouble();
+        }
+        for (; i < args.size(); ++i) {
+            if (!IsReal(args[i])) {
+                return Error::Runtime("not a number");
             }
-            throw RuntimeError("");
-        } else {
-            throw RuntimeError("");
-            //            if (!second_) {
-            //                return f;
-            //            }
-            //            auto s = second_->Eval();
-            //            return std::shared_ptr<Object>(new Cell{f, s});
+            flo_ans = Op::Flo(flo_ans, ToDouble(args[i]));
         }
-        return nullptr;
+        return Make<Flonum>(flo_ans);
     }
 
 private:
-    std::shared_ptr<Object> first_;
-    std::shared_ptr<Object> second_;
+    const std::optional<int64_t> identity_;
 };
 
+// Applies the static members of `Op` to its only argument, with the same fixnum, bignum and
+// flonum paths as ArifmFunc.
+template <class Op>
+class OneArgsIntFunc : public Function {
+public:
+    OneArgsIntFunc(std::string name) : Function(name) {
+    }
+    ObjectResult Apply(ArgSpan args) {
+        if (args.size() != 1 || !IsReal(args[0])) {
+            return Error::Runtime("expected one number");
+        }
+        if (Is<Flonum>(args[0])) {
+            return Make<Flonum>(Op::Flo(As<Flonum>(args[0])->GetValue()));
+        }
+        int64_t ans;
+        if (Is<Number>(args[0]) && !Op::Fixnum(As<Number>(args[0])->GetValue(), &ans)) {
+            return Make<Number>(ans);
+        }
+        return MakeInteger(Op::Big(ToBigInt(args[0])));
+    }
+};
+
+class CloseBracket : public Object {
+public:
+    CloseBracket(Token* token) {
+    }
+    CloseBracket() {
+    }
+
+    std::string Serialise() {
+        return ")";
+    }
+
+    ObjectResult Eval() {
+        return Make<CloseBracket>();
+    }
+};
+
+Result<int64_t> IndexArg(const std::shared_ptr<Object>& arg, size_t size);
+
+Result<uint8_t> ByteArg(const std::shared_ptr<Object>& arg);
+
+// The builtin procedure called `name`, nullptr if there is none.
+Function* FindBuiltin(const std::string& name);
+
+// Evaluates the combination (head . tail); defined with the evaluator.
+ObjectResult EvalCall(const std::shared_ptr<Object>& head, const std::shared_ptr<Object>& tail);
+
+class Cell : public Object {
+public:
+    Cell(std::shared_ptr<Object> a, std::shared_ptr<Object> b) : first_(a), second_(b) {
+    }
+
+#ifndef SCHEME_COMPRESSED_REFS
+    ~Cell() {
+        auto& queue = ReleaseQueue::Get();
+        queue.Defer(std::move(first_));
+        queue.Defer(std::move(second_));
+        queue.Drain();
+    }
+#endif
+
+    std::shared_ptr<Object> GetFirst() const {
+        return Load(first_);
+    }
+    std::shared_ptr<Object> GetSecond() const {
+        return Load(second_);
+    }
+
+    void GetFirst(std::shared_ptr<Object> f) {
+        first_ = f;
+    }
+    void SetSecond(std::shared_ptr<Object> s) {
+        second_ = s;
+    }
+
+    std::string Serialise() {
+        std::string ans;
+        Serialiser serialiser(&ans);
+        serialiser.OpenList(GetFirst(), GetSecond());
+        serialiser.Run();
+        return ans;
+    }
+
+    ObjectResult Eval() {
+        return EvalCall(GetFirst(), GetSecond());
+    }
+
+private:
+    ObjectRef first_;
+    ObjectRef second_;
+};
+
+#ifdef SCHEME_COMPRESSED_REFS
+template <>
+constexpr bool kArenaTrivial<Number> = true;
+
+template <>
+constexpr bool kArenaTrivial<Flonum> = true;
+
+template <>
+constexpr bool kArenaTrivial<Cell> = true;
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // Runtime type checking and convertion.
@@ -838,67 +1179,529 @@ bool Is(const std::shared_ptr<Object>& obj) {
     return false;
 }
 
-inline std::vector<std::shared_ptr<Object>> ArgsToVector(std::shared_ptr<Object> curr) {
-    std::unordered_set<std::string> functions{
-        "quote", "+",     "-",     "/",    "-",       "=",        "<",    ">",         ">=",
-        "<=",    "min",   "max",   "abs",  "number?", "boolean?", "not",  "and",       "or",
-        "pair?", "null?", "list?", "cons", "car",     "cdr",      "list", "list-tail", "list-ref"};
+inline std::string SerialiseExpr(const std::shared_ptr<Object>& obj) {
+    if (!obj) {
+        return "()";
+    }
+    return obj->Serialise();
+}
 
-    if (!Is<Cell>(curr)) {
-        throw RuntimeError("");
+inline void Serialiser::Open(const std::shared_ptr<Object>& obj) {
+    if (!obj) {
+        *out_ += "()";
+    } else if (Cell* cell = dynamic_cast<Cell*>(obj.get())) {
+        OpenList(cell->GetFirst(), cell->GetSecond());
+    } else if (Vector* vec = dynamic_cast<Vector*>(obj.get())) {
+        OpenVector(vec, obj);
+    } else {
+        *out_ += obj->Serialise();
     }
-    std::vector<std::shared_ptr<Object>> ans(0);
-    if (As<Cell>(curr)->GetFirst()) {
-        if (Is<Symbol>(As<Cell>(curr)->GetFirst())) {
-            if (functions.contains(As<Symbol>(As<Cell>(curr)->GetFirst())->GetName())) {
-                curr = curr->Eval();
+}
+
+inline void Serialiser::OpenList(const std::shared_ptr<Object>& first, std::shared_ptr<Object> rest) {
+    *out_ += "(";
+    stack_.push_back({first, std::move(rest), nullptr, 0});
+}
+
+inline void Serialiser::OpenVector(const Vector* vec, std::shared_ptr<Object> holder) {
+    *out_ += "#(";
+    stack_.push_back({nullptr, std::move(holder), vec, 0});
+}
+
+inline void Serialiser::Run() {
+    while (!stack_.empty()) {
+        Frame& top = stack_.back();
+        if (top.vec) {
+            if (top.index == top.vec->Size()) {
+                *out_ += ")";
+                stack_.pop_back();
+                continue;
+            }
+            if (top.index > 0) {
+                *out_ += " ";
             }
+            Open(top.vec->Get(top.index++));
+        } else if (top.index == 0) {
+            auto first = std::move(top.first);
+            top.index = 1;
+            Open(first);
+        } else if (Cell* cell = dynamic_cast<Cell*>(top.rest.get())) {
+            auto next = cell->GetFirst();
+            top.rest = cell->GetSecond();
+            *out_ += " ";
+            Open(next);
+        } else if (top.rest) {
+            auto tail = std::move(top.rest);
+            top.rest = nullptr;
+            *out_ += " . ";
+            Open(tail);
+        } else {
+            *out_ += ")";
+            stack_.pop_back();
         }
     }
-    if (!Is<Cell>(curr)) {
-        throw RuntimeError("");
+}
+
+// Length of the argument list `curr`, which must be proper.
+inline Result<size_t> ArgCount(std::shared_ptr<Object> curr) {
+    size_t count = 0;
+    for (; curr; curr = As<Cell>(curr)->GetSecond()) {
+        if (!Is<Cell>(curr)) {
+            return Error::Runtime("improper argument list");
+        }
+        ++count;
     }
-    if (As<Cell>(curr)->GetFirst()) {
-        auto val = As<Cell>(curr)->GetFirst();
-        //        if (Is<Symbol>(As<Cell>(curr)->GetFirst())) {
-        //            auto temp = curr->Eval();
-        //            val = (As<Cell>(curr)->GetFirst())->Eval();
-        //        }
-        ans.push_back(val);
-        if (Is<Cell>(curr)) {
-            curr = As<Cell>(curr)->GetSecond();
-        } else {
-            curr = nullptr;
-        }
-        while (curr) {
-            val = curr;
-            // val = curr->Eval();
-            if (Is<Cell>(val)) {
-                if (As<Cell>(val)->GetFirst()) {
-                    if (!Is<Cell>(As<Cell>(val)->GetFirst())) {
-                        ans.push_back(As<Cell>(val)->GetFirst());
-                        curr = As<Cell>(curr)->GetSecond();
-                    } else {
-                        while (Is<Cell>(As<Cell>(val)->GetFirst())) {
-                            val = As<Cell>(val)->GetFirst();
-                        }
-                        if (Is<Symbol>(As<Cell>(val)->GetFirst())) {
-                            if (functions.contains(
-                                    As<Symbol>(As<Cell>(val)->GetFirst())->GetName())) {
-                                val = val->Eval();
-                            }
-                        }
-                        ans.push_back(val);
-                        break;
-                    }
-                } else {
-                    curr = nullptr;
-                }
-            } else {
-                ans.push_back(val);
-                break;
+    return count;
+}
+
+// Collects the elements of a proper list without evaluating them.
+inline Result<std::vector<std::shared_ptr<Object>>> ListToVector(std::shared_ptr<Object> curr) {
+    std::vector<std::shared_ptr<Object>> ans;
+    while (curr) {
+        if (!Is<Cell>(curr)) {
+            return Error::Runtime("improper list");
+        }
+        ans.push_back(As<Cell>(curr)->GetFirst());
+        curr = As<Cell>(curr)->GetSecond();
+    }
+    return ans;
+}
+
+inline std::shared_ptr<Object> VectorToList(ArgSpan elems) {
+    std::shared_ptr<Object> ans;
+    for (auto it = elems.rbegin(); it != elems.rend(); ++it) {
+        ans = Make<Cell>(*it, ans);
+    }
+    return ans;
+}
+
+inline bool IsInteger(const std::shared_ptr<Object>& obj) {
+    return Is<Number>(obj) || Is<BigNumber>(obj);
+}
+
+inline BigInt ToBigInt(const std::shared_ptr<Object>& obj) {
+    if (Is<Number>(obj)) {
+        return BigInt(As<Number>(obj)->GetValue());
+    }
+    return As<BigNumber>(obj)->GetValue();
+}
+
+inline bool IsReal(const std::shared_ptr<Object>& obj) {
+    return IsInteger(obj) || Is<Flonum>(obj);
+}
+
+inline double ToDouble(const std::shared_ptr<Object>& obj) {
+    if (Is<Flonum>(obj)) {
+        return As<Flonum>(obj)->GetValue();
+    }
+    if (Is<Number>(obj)) {
+        return static_cast<double>(As<Number>(obj)->GetValue());
+    }
+    return As<BigNumber>(obj)->GetValue().ToDouble();
+}
+
+inline std::shared_ptr<Object> MakeInteger(BigInt value) {
+    if (value.FitsInt64()) {
+        return Make<Number>(value.ToInt64());
+    }
+    return Make<BigNumber>(std::move(value));
+}
+
+inline bool IsEquivalent(const std::shared_ptr<Object>& a, const std::shared_ptr<Object>& b,
+                         Equivalence mode) {
+    if (a == b) {
+        return true;
+    }
+    if (!a || !b) {
+        return false;
+    }
+    if (Is<Number>(a) && Is<Number>(b)) {
+        return As<Number>(a)->GetValue() == As<Number>(b)->GetValue();
+    }
+    if (Is<Symbol>(a) && Is<Symbol>(b)) {
+        return As<Symbol>(a)->GetName() == As<Symbol>(b)->GetName();
+    }
+    if (Is<Bool>(a) && Is<Bool>(b)) {
+        return As<Bool>(a)->GetName() == As<Bool>(b)->GetName();
+    }
+    if (mode == Equivalence::EQ) {
+        return false;
+    }
+    if (Is<BigNumber>(a) && Is<BigNumber>(b)) {
+        return Compare(As<BigNumber>(a)->GetValue(), As<BigNumber>(b)->GetValue()) == 0;
+    }
+    if (Is<Flonum>(a) && Is<Flonum>(b)) {
+        double x = As<Flonum>(a)->GetValue();
+        double y = As<Flonum>(b)->GetValue();
+        return std::memcmp(&x, &y, sizeof(double)) == 0;
+    }
+    if (mode == Equivalence::EQV) {
+        return false;
+    }
+    if (Is<String>(a) && Is<String>(b)) {
+        auto x = As<String>(a);
+        auto y = As<String>(b);
+        return x->Size() == y->Size() && x->Flat() == y->Flat();
+    }
+    if (Is<Bytevector>(a) && Is<Bytevector>(b)) {
+        return As<Bytevector>(a)->Equals(*As<Bytevector>(b));
+    }
+    if (Is<Vector>(a) && Is<Vector>(b)) {
+        auto x = As<Vector>(a);
+        auto y = As<Vector>(b);
+        if (x->Size() != y->Size()) {
+            return false;
+        }
+        for (size_t i = 0; i < x->Size(); ++i) {
+            if (!IsEquivalent(x->Get(i), y->Get(i), mode)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (Is<Cell>(a) && Is<Cell>(b)) {
+        // Recurses into the heads only, so long lists do not deepen the stack.
+        auto x = a;
+        auto y = b;
+        while (Is<Cell>(x) && Is<Cell>(y)) {
+            if (!IsEquivalent(As<Cell>(x)->GetFirst(), As<Cell>(y)->GetFirst(), mode)) {
+                return false;
+            }
+            x = As<Cell>(x)->GetSecond();
+            y = As<Cell>(y)->GetSecond();
+        }
+        return IsEquivalent(x, y, mode);
+    }
+    return false;
+}
+
+// Spreads the bits of `x` over the whole word: FlatTable takes its control byte from the low bits.
+inline size_t MixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53;
+    return x ^ (x >> 33);
+}
+
+inline size_t HashObject(const std::shared_ptr<Object>& obj, Equivalence mode) {
+    if (!obj) {
+        return 0;
+    }
+    if (Is<Number>(obj)) {
+        return MixHash(As<Number>(obj)->GetValue());
+    }
+    if (Is<Symbol>(obj)) {
+        return MixHash(std::hash<std::string>()(As<Symbol>(obj)->GetName()));
+    }
+    if (Is<Bool>(obj)) {
+        return MixHash(std::hash<std::string>()(As<Bool>(obj)->GetName()));
+    }
+    if (mode != Equivalence::EQ) {
+        if (Is<BigNumber>(obj)) {
+            return MixHash(As<BigNumber>(obj)->GetValue().Hash());
+        }
+        if (Is<Flonum>(obj)) {
+            double value = As<Flonum>(obj)->GetValue();
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return MixHash(bits);
+        }
+    }
+    if (mode == Equivalence::EQUAL) {
+        if (Is<String>(obj)) {
+            return MixHash(std::hash<std::string>()(As<String>(obj)->Flat()));
+        }
+        if (Is<Bytevector>(obj)) {
+            auto bytes = As<Bytevector>(obj);
+            std::string_view view(reinterpret_cast<const char*>(bytes->Data()), bytes->Size());
+            return MixHash(std::hash<std::string_view>()(view));
+        }
+        if (Is<Vector>(obj)) {
+            auto vec = As<Vector>(obj);
+            uint64_t ans = vec->Size();
+            for (size_t i = 0; i < vec->Size(); ++i) {
+                ans = MixHash(ans ^ HashObject(vec->Get(i), mode));
+            }
+            return ans;
+        }
+        if (Is<Cell>(obj)) {
+            uint64_t ans = 1;
+            auto curr = obj;
+            while (Is<Cell>(curr)) {
+                ans = MixHash(ans ^ HashObject(As<Cell>(curr)->GetFirst(), mode));
+                curr = As<Cell>(curr)->GetSecond();
             }
+            return MixHash(ans ^ HashObject(curr, mode));
         }
     }
+    return MixHash(reinterpret_cast<uintptr_t>(obj.get()));
+}
+
+// Elements of a proper list inside a special form; anything else is a syntax error.
+inline Result<std::vector<std::shared_ptr<Object>>> FormToVector(std::shared_ptr<Object> curr) {
+    std::vector<std::shared_ptr<Object>> ans;
+    while (curr) {
+        if (!Is<Cell>(curr)) {
+            return Error::Syntax("improper list in a special form");
+        }
+        ans.push_back(As<Cell>(curr)->GetFirst());
+        curr = As<Cell>(curr)->GetSecond();
+    }
     return ans;
-}
\ No newline at end of file
+}
+
+inline Result<std::string> FormSymbol(const std::shared_ptr<Object>& obj) {
+    if (!Is<Symbol>(obj)) {
+        return Error::Syntax("expected a symbol, got " + SerialiseExpr(obj));
+    }
+    return As<Symbol>(obj)->GetName();
+}
+
+inline const std::shared_ptr<Object>* Environment::Find(const std::string& name) const {
+    for (const Environment* env = this; env; env = env->parent_.get()) {
+        size_t i = 0;
+        for (auto curr = env->params_; curr; curr = As<Cell>(curr)->GetSecond(), ++i) {
+            if (static_cast<Symbol*>(As<Cell>(curr)->GetFirst().get())->GetName() == name) {
+                return &env->values_[i];
+            }
+        }
+    }
+    return nullptr;
+}
+
+// (define-record-type <name> (constructor field ...) predicate (field accessor [modifier]) ...)
+// The whole form is checked before anything is registered. Evaluates to the type name.
+inline ObjectResult DefineRecordType(const std::shared_ptr<Object>& form) {
+    SCHEME_TRY(auto parts, FormToVector(form));
+    if (parts.size() < 3) {
+        return Error::Syntax("define-record-type: too few parts");
+    }
+    SCHEME_TRY(std::string type_name, FormSymbol(parts[0]));
+    RecordType type;
+    type.name = type_name;
+    if (type.name.size() > 2 && type.name.front() == '<' && type.name.back() == '>') {
+        type.name = type.name.substr(1, type.name.size() - 2);
+    }
+
+    std::vector<std::pair<std::string, RecordProc>> procs;
+    for (size_t i = 3; i < parts.size(); ++i) {
+        SCHEME_TRY(auto field, FormToVector(parts[i]));
+        if (field.size() < 2 || field.size() > 3) {
+            return Error::Syntax("define-record-type: malformed field " + SerialiseExpr(parts[i]));
+        }
+        SCHEME_TRY(std::string field_name, FormSymbol(field[0]));
+        if (std::find(type.fields.begin(), type.fields.end(), field_name) != type.fields.end()) {
+            return Error::Syntax("define-record-type: duplicate field " + field_name);
+        }
+        type.fields.push_back(field_name);
+        SCHEME_TRY(std::string accessor, FormSymbol(field[1]));
+        procs.push_back({accessor, {RecordProc::Kind::ACCESSOR, nullptr, {i - 3}}});
+        if (field.size() == 3) {
+            SCHEME_TRY(std::string modifier, FormSymbol(field[2]));
+            procs.push_back({modifier, {RecordProc::Kind::MODIFIER, nullptr, {i - 3}}});
+        }
+    }
+    SCHEME_TRY(auto constructor, FormToVector(parts[1]));
+    if (constructor.empty()) {
+        return Error::Syntax("define-record-type: missing constructor name");
+    }
+    RecordProc make{RecordProc::Kind::CONSTRUCTOR, nullptr, {}};
+    for (size_t i = 1; i < constructor.size(); ++i) {
+        SCHEME_TRY(std::string field, FormSymbol(constructor[i]));
+        auto it = std::find(type.fields.begin(), type.fields.end(), field);
+        if (it == type.fields.end()) {
+            return Error::Syntax("define-record-type: unknown field " + field);
+        }
+        make.slots.push_back(it - type.fields.begin());
+    }
+    SCHEME_TRY(std::string constructor_name, FormSymbol(constructor[0]));
+    SCHEME_TRY(std::string predicate_name, FormSymbol(parts[2]));
+    procs.push_back({constructor_name, make});
+    procs.push_back({predicate_name, {RecordProc::Kind::PREDICATE, nullptr, {}}});
+
+    RecordRegistry* records = CurrentRecords();
+    if (!records) {
+        return Error::Runtime("define-record-type: no interpreter to define in");
+    }
+    const RecordType* added = records->AddType(std::move(type));
+    for (auto& [proc_name, proc] : procs) {
+        proc.type = added;
+        records->AddProc(proc_name, std::move(proc));
+    }
+    return Make<Symbol>(type_name);
+}
+
+inline ObjectResult ApplyRecordProc(const RecordProc& proc, ArgSpan args) {
+    if (proc.kind == RecordProc::Kind::CONSTRUCTOR) {
+        if (args.size() != proc.slots.size()) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        std::vector<std::shared_ptr<Object>> slots(proc.type->fields.size());
+        for (size_t i = 0; i < args.size(); ++i) {
+            slots[proc.slots[i]] = args[i];
+        }
+        for (auto& slot : slots) {
+            if (!slot) {
+                slot = Make<Bool>("#f");
+            }
+        }
+        return Make<Record>(proc.type, slots);
+    }
+    if (proc.kind == RecordProc::Kind::PREDICATE) {
+        if (args.size() != 1) {
+            return Error::Runtime("wrong number of arguments");
+        }
+        bool is_type = Is<Record>(args[0]) && As<Record>(args[0])->GetType() == proc.type;
+        return Make<Bool>(is_type ? "#t" : "#f");
+    }
+    size_t arity = proc.kind == RecordProc::Kind::ACCESSOR ? 1 : 2;
+    if (args.size() != arity) {
+        return Error::Runtime("wrong number of arguments");
+    }
+    auto record = As<Record>(args[0]);
+    if (!record || record->GetType() != proc.type) {
+        return Error::Runtime("not a " + proc.type->name);
+    }
+    if (proc.kind == RecordProc::Kind::ACCESSOR) {
+        return record->Get(proc.slots[0]);
+    }
+    // Returns the record, like vector-set!.
+    record->Set(proc.slots[0], StoredIn(record.get(), args[1]));
+    return record;
+}
+
+// Copies the parts of `obj` that live in `arena` to the heap, so that they survive its reset.
+inline std::shared_ptr<Object> Promote(const std::shared_ptr<Object>& obj, Arena* arena) {
+    if (!obj || !arena || !arena->Owns(obj.get())) {
+        return obj;
+    }
+    HeapScope heap_scope;
+    if (Is<Cell>(obj)) {
+        std::vector<std::shared_ptr<Object>> elems;
+        auto curr = obj;
+        while (Is<Cell>(curr) && arena->Owns(curr.get())) {
+            elems.push_back(Promote(As<Cell>(curr)->GetFirst(), arena));
+            curr = As<Cell>(curr)->GetSecond();
+        }
+        auto ans = Promote(curr, arena);
+        for (auto it = elems.rbegin(); it != elems.rend(); ++it) {
+            ans = Make<Cell>(*it, ans);
+        }
+        return ans;
+    }
+    if (Is<Vector>(obj)) {
+        std::vector<std::shared_ptr<Object>> elems;
+        auto vec = As<Vector>(obj);
+        for (size_t i = 0; i < vec->Size(); ++i) {
+            elems.push_back(Promote(vec->Get(i), arena));
+        }
+        return Make<Vector>(std::move(elems));
+    }
+    if (Is<Number>(obj)) {
+        return Make<Number>(As<Number>(obj)->GetValue());
+    }
+    if (Is<BigNumber>(obj)) {
+        return Make<BigNumber>(As<BigNumber>(obj)->GetValue());
+    }
+    if (Is<Flonum>(obj)) {
+        return Make<Flonum>(As<Flonum>(obj)->GetValue());
+    }
+    if (Is<String>(obj)) {
+        return Make<String>(As<String>(obj)->Flat());
+    }
+    if (Is<PersistentMap>(obj)) {
+        PersistentMap::Trie::Transient batch(PersistentMap().GetTrie());
+        As<PersistentMap>(obj)->ForEach(
+            [&](const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& value) {
+                batch.Set(Promote(key, arena), Promote(value, arena));
+            });
+        return Make<PersistentMap>(batch.Persistent());
+    }
+    if (Is<Bytevector>(obj)) {
+        auto bytes = As<Bytevector>(obj);
+        return Make<Bytevector>(bytes->Data(), bytes->Size());
+    }
+    if (Is<Record>(obj)) {
+        auto record = As<Record>(obj);
+        std::vector<std::shared_ptr<Object>> slots;
+        for (size_t i = 0; i < record->Size(); ++i) {
+            slots.push_back(Promote(record->Get(i), arena));
+        }
+        return Make<Record>(record->GetType(), slots);
+    }
+    if (Is<HashTable>(obj)) {
+        auto table = As<HashTable>(obj);
+        auto ans = Make<HashTable>(table->GetMode());
+        table->ForEach([&](const std::shared_ptr<Object>& key, const std::shared_ptr<Object>& value) {
+            ans->Set(Promote(key, arena), Promote(value, arena));
+        });
+        return ans;
+    }
+    if (Is<Bool>(obj)) {
+        return Make<Bool>(As<Bool>(obj)->GetName());
+    }
+    if (Is<Symbol>(obj)) {
+        return Make<Symbol>(As<Symbol>(obj)->GetName());
+    }
+    if (Procedure* proc = dynamic_cast<Procedure*>(obj.get())) {
+        return proc->Promote(arena);
+    }
+    throw RuntimeError("");
+}
+
+inline std::shared_ptr<Environment> Promote(const std::shared_ptr<Environment>& env, Arena* arena) {
+    if (!env || !arena || !arena->Owns(env.get())) {
+        return env;
+    }
+    auto parent = Promote(env->parent_, arena);
+    HeapScope heap_scope;
+    std::vector<std::shared_ptr<Object>> values;
+    for (const auto& value : env->values_) {
+        values.push_back(Promote(value, arena));
+    }
+    return Make<Environment>(Promote(env->params_, arena), ArgSpan(values.data(), values.size()),
+                             std::move(parent));
+}
+
+inline std::shared_ptr<Object> Closure::Promote(Arena* arena) {
+    return Make<Closure>(::Promote(params_, arena), arity_, ::Promote(body_, arena),
+                         ::Promote(env_, arena));
+}
+
+// What to store in a slot of `container`: `value`, or a copy of it if the container outlives the
+// current arena, as the values of globals and the constants of cached nodes do.
+inline std::shared_ptr<Object> StoredIn(const Object* container,
+                                        const std::shared_ptr<Object>& value) {
+    Arena* arena = CurrentArena();
+    if (!arena || arena->Owns(container)) {
+        return value;
+    }
+    return Promote(value, arena);
+}
+
+// Binds the global `slot` to a copy of `value` that outlives the current Run. Evaluates to the
+// name of the global.
+inline ObjectResult DefineGlobal(size_t slot, const std::shared_ptr<Object>& value) {
+    GlobalRegistry* globals = CurrentGlobals();
+    globals->Set(slot, Promote(value));
+    return Make<Symbol>(globals->GetName(slot));
+}
+
+inline Result<uint8_t> ByteArg(const std::shared_ptr<Object>& arg) {
+    if (!Is<Number>(arg) || As<Number>(arg)->GetValue() < 0 || As<Number>(arg)->GetValue() > 255) {
+        return Error::Runtime("not a byte");
+    }
+    return uint8_t(As<Number>(arg)->GetValue());
+}
+
+inline Result<int64_t> IndexArg(const std::shared_ptr<Object>& arg, size_t size) {
+    if (!Is<Number>(arg)) {
+        return Error::Runtime("index is not an integer");
+    }
+    int64_t index = As<Number>(arg)->GetValue();
+    if (index < 0 || static_cast<size_t>(index) >= size) {
+        return Error::Runtime("index out of range");
+    }
+    return index;
+}
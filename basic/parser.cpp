@@ -3,82 +3,172 @@
 #include "tokenizer.h"
 #include "error.h"
 
-std::shared_ptr<Object> Read2(Tokenizer* tokenizer) {
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("");
+namespace {
+
+// A list, vector, bytevector or quote whose datum has not been read to the end yet.
+struct Open {
+    enum class Kind { LIST, VECTOR, BYTEVECTOR, QUOTE };
+
+    Kind kind;
+    // The first and the last cell of a list, nullptr while it is empty.
+    std::shared_ptr<Object> head = nullptr;
+    std::shared_ptr<Object> last = nullptr;
+    // 0 before a dot, 1 right after it, 2 once the datum after it has been read.
+    int dot = 0;
+    std::vector<std::shared_ptr<Object>> elems = {};
+    std::vector<uint8_t> bytes = {};
+};
+
+std::shared_ptr<Object> ReadAtom(Token* token) {
+    if (*token == Token{BoolToken::FALSE}) {
+        return Make<Bool>("#f");
     }
-    auto token = tokenizer->GetToken();
-    tokenizer->Next();
-    if (token == Token{BracketToken::OPEN}) {
-        return ReadList(tokenizer);
-    } else if (token == Token{BracketToken::CLOSE}) {
-        return std::shared_ptr<Object>(new CloseBracket(&token));
-    } else if (token == Token{BoolToken::FALSE}) {
-        return std::shared_ptr<Object>(new Bool("#f"));
-    } else if (token == Token{BoolToken::TRUE}) {
-        return std::shared_ptr<Object>(new Bool("#t"));
-    } else {
-        if (QuoteToken* x = std::get_if<QuoteToken>(&token)) {
-            if (tokenizer->IsEnd()) {
-                throw SyntaxError("");
-            }
-            //            auto f = std::shared_ptr<Object>(new Symbol("quote"));
-            //            auto s = Read2(tokenizer);
-            //            return std::shared_ptr<Object>(new Cell{f, s});
-            return std::shared_ptr<Object>(new Symbol("quote"));
-        }
-        if (ConstantToken* x = std::get_if<ConstantToken>(&token)) {
-            return std::shared_ptr<Object>(new Number(x));
-        }
-        return std::shared_ptr<Object>(new Symbol(&token));
+    if (*token == Token{BoolToken::TRUE}) {
+        return Make<Bool>("#t");
+    }
+    if (ConstantToken* x = std::get_if<ConstantToken>(token)) {
+        return Make<Number>(x);
     }
+    if (BigConstantToken* x = std::get_if<BigConstantToken>(token)) {
+        return Make<BigNumber>(BigInt::FromString(x->digits));
+    }
+    if (FloatToken* x = std::get_if<FloatToken>(token)) {
+        return Make<Flonum>(x->value);
+    }
+    if (StringToken* x = std::get_if<StringToken>(token)) {
+        return Make<String>(x->value);
+    }
+    return Make<Symbol>(token);
 }
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
-    auto first = Read2(tokenizer);
-    if (Is<CloseBracket>(first)) {
-        return nullptr;
-    }
-    if (Is<Symbol>(first) && As<Symbol>(first)->GetName() == ".") {
-        throw SyntaxError("");
+bool IsDot(const std::shared_ptr<Object>& datum) {
+    return Is<Symbol>(datum) && As<Symbol>(datum)->GetName() == ".";
+}
+
+// Adds a complete datum to the innermost open list, vector or bytevector.
+Result<void> AddDatum(Open* open, std::shared_ptr<Object> datum) {
+    switch (open->kind) {
+        case Open::Kind::LIST:
+            if (open->dot == 2) {
+                return Error::Syntax("more than one datum after dot");
+            }
+            if (IsDot(datum)) {
+                if (!open->head) {
+                    return Error::Syntax("dot at the start of a list");
+                }
+                if (open->dot == 1) {
+                    return Error::Syntax("nothing after dot");
+                }
+                open->dot = 1;
+            } else if (open->dot == 1) {
+                As<Cell>(open->last)->SetSecond(datum);
+                open->dot = 2;
+            } else {
+                auto cell = Make<Cell>(datum, nullptr);
+                if (open->head) {
+                    As<Cell>(open->last)->SetSecond(cell);
+                } else {
+                    open->head = cell;
+                }
+                open->last = cell;
+            }
+            return {};
+        case Open::Kind::VECTOR:
+            if (IsDot(datum)) {
+                return Error::Syntax("dot in a vector literal");
+            }
+            open->elems.push_back(std::move(datum));
+            return {};
+        case Open::Kind::BYTEVECTOR:
+            if (!Is<Number>(datum) || As<Number>(datum)->GetValue() < 0 ||
+                As<Number>(datum)->GetValue() > 255) {
+                return Error::Syntax("bytevector element is not a byte");
+            }
+            open->bytes.push_back(As<Number>(datum)->GetValue());
+            return {};
+        case Open::Kind::QUOTE:
+            break;
     }
-    // мб надо кинуть какие-то ошибки
-    auto obj = std::shared_ptr<Object>(new Cell{first, nullptr});
-    auto answer = obj;
-    auto second = Read2(tokenizer);
-    while (!Is<CloseBracket>(second)) {
-        if (Is<Symbol>(second) && As<Symbol>(second)->GetName() == ".") {
-            auto second1 = Read2(tokenizer);
-            if (Is<CloseBracket>(second1)) {
-                throw SyntaxError("");
+    return Error::Syntax("unexpected datum");
+}
+
+// The datum that starts at the current token, or a CloseBracket if it is a closing bracket.
+// Nested data are kept on an explicit stack, so their depth is limited only by memory.
+ObjectResult ReadDatum(Tokenizer* tokenizer) {
+    std::vector<Open> stack;
+    while (true) {
+        if (tokenizer->IsEnd()) {
+            if (!stack.empty() && stack.back().kind == Open::Kind::QUOTE) {
+                return Error::Syntax("nothing after quote");
             }
-            second = Read2(tokenizer);
-            if (Is<CloseBracket>(second)) {
-                As<Cell>(obj)->SetSecond(second1);
-                return answer;
+            return Error::Syntax("unexpected end of input");
+        }
+        auto token = tokenizer->GetToken();
+        SCHEME_CHECK(tokenizer->TryNext());
+        std::shared_ptr<Object> datum;
+        if (token == Token{BracketToken::OPEN}) {
+            stack.push_back({Open::Kind::LIST});
+            continue;
+        } else if (std::get_if<VectorToken>(&token)) {
+            stack.push_back({Open::Kind::VECTOR});
+            continue;
+        } else if (std::get_if<BytevectorToken>(&token)) {
+            stack.push_back({Open::Kind::BYTEVECTOR});
+            continue;
+        } else if (std::get_if<QuoteToken>(&token)) {
+            stack.push_back({Open::Kind::QUOTE});
+            continue;
+        } else if (token == Token{BracketToken::CLOSE}) {
+            if (stack.empty()) {
+                return Make<CloseBracket>(&token);
+            }
+            Open& open = stack.back();
+            if (open.kind == Open::Kind::QUOTE) {
+                return Error::Syntax("nothing after quote");
             }
-            if (!Is<Cell>(second1)) {
-                throw SyntaxError("");
+            if (open.dot == 1) {
+                return Error::Syntax("nothing after dot");
             }
+            if (open.kind == Open::Kind::LIST) {
+                datum = std::move(open.head);
+            } else if (open.kind == Open::Kind::VECTOR) {
+                datum = Make<Vector>(std::move(open.elems));
+            } else {
+                datum = Make<Bytevector>(std::move(open.bytes));
+            }
+            stack.pop_back();
         } else {
-            auto second2 = Read2(tokenizer);
-            auto new_obj = std::shared_ptr<Object>(new Cell{second, nullptr});
-            As<Cell>(obj)->SetSecond(new_obj);
-            obj = new_obj;
-            second = second2;
+            datum = ReadAtom(&token);
+        }
+        // 'x is read as (quote x).
+        while (!stack.empty() && stack.back().kind == Open::Kind::QUOTE) {
+            datum = Make<Cell>(Make<Symbol>("quote"), Make<Cell>(datum, nullptr));
+            stack.pop_back();
         }
+        if (stack.empty()) {
+            return datum;
+        }
+        SCHEME_CHECK(AddDatum(&stack.back(), std::move(datum)));
     }
-    return answer;
 }
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+}  // namespace
+
+ObjectResult TryRead(Tokenizer* tokenizer) {
+    if (tokenizer->GetError()) {
+        return *tokenizer->GetError();
+    }
     if (tokenizer->IsEnd()) {
-        throw SyntaxError("");
+        return Error::Syntax("empty input");
     }
-    auto out = Read2(tokenizer);
+    SCHEME_TRY(auto out, ReadDatum(tokenizer));
 
     if (!(tokenizer->IsEnd())) {
-        throw SyntaxError("");
+        return Error::Syntax("more than one expression");
     }
     return out;
+}
+
+std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+    return TryRead(tokenizer).ValueOrRaise();
 }
\ No newline at end of file
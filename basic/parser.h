@@ -5,6 +5,8 @@
 #include "object.h"
 #include <tokenizer.h>
 
+// Reads the single expression that makes up the rest of the input. Throws SyntaxError.
 std::shared_ptr<Object> Read(Tokenizer* tokenizer);
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer);
\ No newline at end of file
+// Same as Read, with the syntax error returned instead of thrown.
+ObjectResult TryRead(Tokenizer* tokenizer);
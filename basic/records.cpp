@@ -0,0 +1,33 @@
+#include "records.h"
+
+namespace {
+
+thread_local RecordRegistry* current_records = nullptr;
+
+}  // namespace
+
+const RecordType* RecordRegistry::AddType(RecordType type) {
+    types_.push_back(std::make_unique<RecordType>(std::move(type)));
+    return types_.back().get();
+}
+
+void RecordRegistry::AddProc(const std::string& name, RecordProc proc) {
+    procs_[name] = std::move(proc);
+}
+
+const RecordProc* RecordRegistry::FindProc(const std::string& name) const {
+    auto it = procs_.find(name);
+    return it == procs_.end() ? nullptr : &it->second;
+}
+
+RecordRegistry* CurrentRecords() {
+    return current_records;
+}
+
+RecordScope::RecordScope(RecordRegistry* records) : prev_(current_records) {
+    current_records = records;
+}
+
+RecordScope::~RecordScope() {
+    current_records = prev_;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Layout of the records of one define-record-type: one slot per field, in declaration order.
+struct RecordType {
+    std::string name;
+    std::vector<std::string> fields;
+};
+
+// Procedure generated by define-record-type.
+struct RecordProc {
+    enum class Kind { CONSTRUCTOR, PREDICATE, ACCESSOR, MODIFIER };
+
+    Kind kind;
+    const RecordType* type;
+    // The slot of each constructor argument, or the one slot of an accessor or modifier.
+    std::vector<size_t> slots;
+};
+
+// Record types defined by one Interpreter and the procedures they generated. Types are never
+// freed, so records refer to them by plain pointer and the type check is a pointer compare.
+class RecordRegistry {
+public:
+    const RecordType* AddType(RecordType type);
+
+    // Replaces an earlier procedure of the same name.
+    void AddProc(const std::string& name, RecordProc proc);
+
+    // nullptr if `name` is not a record procedure.
+    const RecordProc* FindProc(const std::string& name) const;
+
+private:
+    std::vector<std::unique_ptr<RecordType>> types_;
+    std::unordered_map<std::string, RecordProc> procs_;
+};
+
+// Registry that define-record-type adds to while set, nullptr otherwise.
+RecordRegistry* CurrentRecords();
+
+// Makes `records` current for the lifetime of the scope.
+class RecordScope {
+public:
+    RecordScope(RecordRegistry* records);
+    RecordScope(const RecordScope&) = delete;
+    RecordScope& operator=(const RecordScope&) = delete;
+    ~RecordScope();
+
+private:
+    RecordRegistry* prev_;
+};
@@ -0,0 +1,48 @@
+#include "resolver.h"
+
+#include <utility>
+
+void Resolver::Enter(std::vector<std::string> params) {
+    scopes_.push_back({std::move(params), {}, {}});
+}
+
+std::vector<Address> Resolver::Leave() {
+    auto captures = std::move(scopes_.back().captures);
+    scopes_.pop_back();
+    return captures;
+}
+
+bool Resolver::Resolve(const std::string& name, Address* address) {
+    size_t level = scopes_.size();
+    Address found;
+    while (level > 0 && !Find(scopes_[level - 1], name, &found)) {
+        --level;
+    }
+    if (level == 0) {
+        return false;
+    }
+    for (; level < scopes_.size(); ++level) {
+        Scope& scope = scopes_[level];
+        scope.captured.push_back(name);
+        scope.captures.push_back(found);
+        found = {1, static_cast<uint32_t>(scope.captured.size() - 1)};
+    }
+    *address = found;
+    return true;
+}
+
+bool Resolver::Find(const Scope& scope, const std::string& name, Address* address) {
+    for (size_t i = 0; i < scope.params.size(); ++i) {
+        if (scope.params[i] == name) {
+            *address = {0, static_cast<uint32_t>(i)};
+            return true;
+        }
+    }
+    for (size_t i = 0; i < scope.captured.size(); ++i) {
+        if (scope.captured[i] == name) {
+            *address = {1, static_cast<uint32_t>(i)};
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Where the value of a variable is when code that refers to it runs: at `index` in the arguments
+// of the innermost call (depth 0), or in the values that its closure captured (depth 1).
+struct Address {
+    uint32_t depth;
+    uint32_t index;
+};
+
+// Lexical scopes of the lambdas around the expression being compiled. Closures are flat: a lambda
+// captures, when it is evaluated, the values of just those variables of the enclosing lambdas
+// that its body uses, so no lookup walks further out than its own closure.
+class Resolver {
+public:
+    // Enters the body of a lambda with the parameters `params`.
+    void Enter(std::vector<std::string> params);
+
+    // Leaves the innermost lambda. Returns where the values that it captures are in the scope
+    // around it, in the order of their indices.
+    std::vector<Address> Leave();
+
+    // Outside of any lambda, where define may be used.
+    bool AtTopLevel() const {
+        return scopes_.empty();
+    }
+
+    // The address of the variable `name`, if a lambda around binds it. The lambdas in between
+    // capture it from the one around them.
+    bool Resolve(const std::string& name, Address* address);
+
+private:
+    struct Scope {
+        std::vector<std::string> params;
+        // The variables captured so far and where each one is in the scope around.
+        std::vector<std::string> captured;
+        std::vector<Address> captures;
+    };
+
+    static bool Find(const Scope& scope, const std::string& name, Address* address);
+
+    std::vector<Scope> scopes_;
+};
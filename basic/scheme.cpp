@@ -7,94 +7,76 @@
 #include "tokenizer.h"
 #include "error.h"
 
-std::string Interpreter::Run(const std::string &str2) {
-    if (IsTrivial(str2)) {
-        return Trivial();
-    }
-    if (str2[0] == ' ') {
-        throw SyntaxError("");
-    }
-    std::string str1 = str2;
-    if (str1[str1.length() - 1] == ' ') {
-        while (str1[str1.length() - 1] == ' ') {
-            str1.pop_back();
-        }
-    }
-    std::string str = str1;
-    if (str1[0] == '\'') {
-        if (str1[1] == ' ') {
-            throw SyntaxError("");
-        }
-        str = "(quote ";
-        for (int64_t i = 1; i < str1.length(); ++i) {
-            str += str1[i];
-        }
-        str += ")";
+std::string Interpreter::Run(const std::string &str) {
+    return TryRun(str).ValueOrRaise();
+}
+
+Result<std::string> Interpreter::TryRun(const std::string &str) {
+    // Declared first so that the AST and the result are released before the arena is reset.
+    ArenaScope arena_scope(&arena_);
+    RecordScope record_scope(&records_);
+    GlobalScope global_scope(&globals_);
+    std::shared_ptr<Object> output_ast;
+    if (engine_ == Engine::NODES) {
+        SCHEME_TRY(auto nodes, GetNodes(str));
+        SCHEME_TRY(output_ast, ExecuteNodes(*nodes, eval_depth_limit_, node_stats_));
+    } else {
+        SCHEME_TRY(auto folded_ast, ReadForm(str));
+        auto output = engine_ == Engine::BYTECODE
+                          ? Execute(*Compile(folded_ast), eval_depth_limit_)
+                          : Evaluate(folded_ast, eval_depth_limit_);
+        SCHEME_TRY(output_ast, std::move(output));
     }
+    return SerialiseExpr(output_ast);
+}
+
+Result<std::shared_ptr<Object>> Interpreter::ReadForm(const std::string &str) {
     std::stringstream s(str);
-    Tokenizer tokenizer = Tokenizer(&s);
-    std::shared_ptr<Object> input_ast;
-    try {
-        input_ast = Read(&tokenizer);
-    } catch (...) {
-        throw SyntaxError("");
-    }
-    if (!input_ast) {
-        throw RuntimeError("");
-    }
+    Tokenizer tokenizer(&s);
+    SCHEME_TRY(auto input_ast, TryRead(&tokenizer));
     if (Is<CloseBracket>(input_ast)) {
-        throw SyntaxError("");
+        return Error::Syntax("unexpected )");
     }
-    if (Is<Number>(input_ast) || Is<Symbol>(input_ast) || Is<Bool>(input_ast)) {
-        return input_ast->Serialise();
+    return FoldConstants(input_ast, eval_depth_limit_, fold_stats_);
+}
+
+Result<std::shared_ptr<Node>> Interpreter::GetNodes(const std::string &str) {
+    if (auto it = nodes_.find(str); it != nodes_.end()) {
+        return it->second;
     }
-    if (Is<Cell>(input_ast)) {
-        if (!((As<Cell>(input_ast))->GetFirst())) {
-            throw RuntimeError("");
-        }
-        std::shared_ptr<Object> output_ast;
-        if (Is<Symbol>((As<Cell>(input_ast))->GetFirst())) {
-            auto name = As<Symbol>((As<Cell>(input_ast))->GetFirst())->GetName();
-            if (name == "quote") {
-                auto temp = (As<Cell>(input_ast))->GetSecond();
-                if (!temp) {
-                    throw SyntaxError("");
-                }
-                if (!Is<Cell>(temp)) {
-                    return temp->Serialise();
-                }
-                if (!As<Cell>(temp)->GetFirst()) {
-                    throw RuntimeError("");
-                }
-                return "(" + (As<Cell>(temp)->GetFirst())->Serialise() + ")";
-            } else {
-                std::unordered_set<std::string> functions{
-                    "quote",   "+",        "*",   "-",   "/",    "-",         "=",
-                    "<",       ">",        ">=",  "<=",  "min",  "max",       "abs",
-                    "number?", "boolean?", "not", "and", "or",   "pair?",     "null?",
-                    "list?",   "cons",     "car", "cdr", "list", "list-tail", "list-ref"};
-                if (functions.contains(name)) {
-                    output_ast = input_ast->Eval();
-                } else {
-                    throw RuntimeError("");
-                }
-            }
-            // output_ast = input_ast->Eval();
-            std::string t;
-            if (Is<Cell>(output_ast)) {
-                if (!As<Cell>(output_ast)->GetFirst() && !As<Cell>(output_ast)->GetSecond()) {
-                    return "()";
-                }
-                t = "(" + output_ast->Serialise() + ")";
-            } else {
-                t = output_ast->Serialise();
-            }
-            return t;
-        }
-        throw RuntimeError("");
-        output_ast = input_ast->Eval();
-        auto t = output_ast->Serialise();
-        return t;
+    SCHEME_TRY(auto folded_ast, ReadForm(str));
+    if (nodes_.size() >= kNodeCacheSize) {
+        nodes_.clear();
     }
-    throw RuntimeError("");
+    auto nodes = CompileNodes(folded_ast);
+    nodes_.emplace(str, nodes);
+    return nodes;
+}
+
+void Interpreter::SetEvalDepthLimit(size_t limit) {
+    eval_depth_limit_ = limit;
+}
+
+void Interpreter::SetFoldStats(FoldStats* stats) {
+    fold_stats_ = stats;
+}
+
+void Interpreter::SetEngine(Engine engine) {
+    engine_ = engine;
+}
+
+void Interpreter::SetNodeStats(NodeStats* stats) {
+    node_stats_ = stats;
+}
+
+void Interpreter::SetHugePages(bool enabled) {
+    arena_.GetHeap()->SetHugePages(enabled);
+}
+
+HeapStats Interpreter::GetHeapStats() {
+    return arena_.GetHeap()->GetStats();
+}
+
+size_t Interpreter::GetAllocationCount() const {
+    return arena_.Allocations();
 }
@@ -1,9 +1,82 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+
+#include "arena.h"
+#include "error.h"
+#include "eval.h"
+#include "fold.h"
+#include "globals.h"
+#include "nodes.h"
+#include "records.h"
+#include "vm.h"
 #define SCHEME_FUZZING_2_PRINT_REQUESTS
 
+// How Interpreter runs an expression once it is read and folded.
+enum class Engine {
+    // Evaluate walks the expression itself.
+    TREE,
+    // Compile turns it into bytecode first, and Execute runs that.
+    BYTECODE,
+    // CompileNodes turns it into executable nodes, which are cached by the text of the expression.
+    NODES
+};
+
 class Interpreter {
 public:
+    // Throws SyntaxError, RuntimeError or NameError.
     std::string Run(const std::string& s);
+
+    // Same as Run, with the error returned instead of thrown.
+    Result<std::string> TryRun(const std::string& s);
+
+    // Number of pending evaluation steps past which Run fails with RuntimeError.
+    void SetEvalDepthLimit(size_t limit);
+
+    // Adds the changes that constant folding makes to each expression to `stats`; nullptr, the
+    // default, stops counting.
+    void SetFoldStats(FoldStats* stats);
+
+    // Engine::TREE by default. All of them give the same values and errors, except for the depth
+    // limit: bytecode counts only pending procedure calls towards it, and nodes never allow more
+    // than kNodeDepthLimit. A cached expression is not folded again, so it adds nothing to the
+    // fold stats.
+    void SetEngine(Engine engine);
+
+    // Adds what the nodes of Engine::NODES do to specialize to `stats`; nullptr, the default, stops
+    // counting.
+    void SetNodeStats(NodeStats* stats);
+
+    // Runtime switch for MADV_HUGEPAGE on the object heap; enabled by default.
+    void SetHugePages(bool enabled);
+
+    HeapStats GetHeapStats();
+
+    // Objects allocated by the runs so far, reused blocks included; what an expression allocates
+    // is the difference from before to after running it.
+    size_t GetAllocationCount() const;
+
+private:
+    // Number of expressions whose nodes are kept; the cache is emptied when it fills up.
+    static constexpr size_t kNodeCacheSize = 1024;
+
+    // Reads and folds one expression.
+    Result<std::shared_ptr<Object>> ReadForm(const std::string& s);
+
+    // The nodes of `s`, from the cache if it was run before.
+    Result<std::shared_ptr<Node>> GetNodes(const std::string& s);
+
+    // Holds every object built while running one expression; rewound after serialisation.
+    Arena arena_;
+    // Record types defined so far; unlike objects, they persist from one Run to the next.
+    RecordRegistry records_;
+    // Globals defined so far, which persist in the same way.
+    GlobalRegistry globals_;
+    size_t eval_depth_limit_ = kDefaultEvalDepthLimit;
+    FoldStats* fold_stats_ = nullptr;
+    Engine engine_ = Engine::TREE;
+    NodeStats* node_stats_ = nullptr;
+    std::unordered_map<std::string, std::shared_ptr<Node>> nodes_;
 };
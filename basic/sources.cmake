@@ -2,6 +2,21 @@ add_library(scheme_basic
     tokenizer.cpp
     parser.cpp
     scheme.cpp
+    arena.cpp
+    heap.cpp
+    bigint.cpp
+    records.cpp
+    globals.cpp
+    builtins.cpp
+    arg_stack.cpp
+    kernels.cpp
+    special_forms.cpp
+    eval.cpp
+    fold.cpp
+    resolver.cpp
+    compiler.cpp
+    vm.cpp
+    nodes.cpp
     
     # maybe more .cpp files here
 )
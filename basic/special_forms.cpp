@@ -0,0 +1,234 @@
+#include "special_forms.h"
+
+namespace {
+
+Result<void> CheckProperList(const std::shared_ptr<Object>& list, const std::string& message) {
+    for (auto curr = list; curr; curr = As<Cell>(curr)->GetSecond()) {
+        if (!Is<Cell>(curr)) {
+            return Error::Syntax(message);
+        }
+    }
+    return {};
+}
+
+Result<FormStep> SequenceRest(const std::shared_ptr<Object>& rest, std::shared_ptr<Object>) {
+    return Sequence(rest);
+}
+
+Result<FormStep> Quote(const std::shared_ptr<Object>& args, const std::shared_ptr<Environment>&) {
+    if (!Is<Cell>(args) || As<Cell>(args)->GetSecond()) {
+        return Error::Syntax("quote: expected one datum");
+    }
+    return FormStep::Value(As<Cell>(args)->GetFirst());
+}
+
+// and stops at the first false value, or at the first true one.
+template <bool is_and>
+Result<FormStep> ConnectiveRest(const std::shared_ptr<Object>& rest, std::shared_ptr<Object> value) {
+    if (IsFalse(value) == is_and) {
+        return FormStep::Value(std::move(value));
+    }
+    return Sequence(rest);
+}
+
+template <bool is_and>
+Result<FormStep> Connective(const std::shared_ptr<Object>& args,
+                            const std::shared_ptr<Environment>&) {
+    SCHEME_CHECK(CheckProperList(args, is_and ? "and: improper argument list"
+                                              : "or: improper argument list"));
+    if (!args) {
+        return FormStep::Value(Make<Bool>(is_and ? "#t" : "#f"));
+    }
+    auto cell = As<Cell>(args);
+    if (!cell->GetSecond()) {
+        return FormStep::Eval(cell->GetFirst());
+    }
+    return FormStep::Then(cell->GetFirst(), ConnectiveRest<is_and>, cell->GetSecond());
+}
+
+// `branches` is (consequent [alternative]). Without an alternative a false test is the value.
+Result<FormStep> IfBranch(const std::shared_ptr<Object>& branches, std::shared_ptr<Object> test) {
+    auto cell = As<Cell>(branches);
+    if (!IsFalse(test)) {
+        return FormStep::Eval(cell->GetFirst());
+    }
+    if (auto alternative = cell->GetSecond()) {
+        return FormStep::Eval(As<Cell>(alternative)->GetFirst());
+    }
+    return FormStep::Value(std::move(test));
+}
+
+// (if test consequent [alternative])
+Result<FormStep> If(const std::shared_ptr<Object>& args, const std::shared_ptr<Environment>&) {
+    SCHEME_TRY(auto parts, FormToVector(args));
+    if (parts.size() != 2 && parts.size() != 3) {
+        return Error::Syntax("if: expected a test and one or two branches");
+    }
+    return FormStep::Then(parts[0], IfBranch, As<Cell>(args)->GetSecond());
+}
+
+Result<FormStep> CondTest(const std::shared_ptr<Object>& clauses, std::shared_ptr<Object> test);
+
+// Tries the first of `clauses`. The clauses are checked as they are reached.
+Result<FormStep> CondClause(const std::shared_ptr<Object>& clauses) {
+    if (!clauses) {
+        return FormStep::Value(Make<Bool>("#f"));
+    }
+    SCHEME_TRY(auto clause, FormToVector(As<Cell>(clauses)->GetFirst()));
+    if (clause.empty()) {
+        return Error::Syntax("cond: empty clause");
+    }
+    auto body = As<Cell>(As<Cell>(clauses)->GetFirst())->GetSecond();
+    if (Is<Symbol>(clause[0]) && As<Symbol>(clause[0])->GetName() == "else") {
+        if (As<Cell>(clauses)->GetSecond() || !body) {
+            return Error::Syntax("cond: misplaced or empty else clause");
+        }
+        return Sequence(body);
+    }
+    return FormStep::Then(clause[0], CondTest, clauses);
+}
+
+// A clause without expressions yields its test value.
+Result<FormStep> CondTest(const std::shared_ptr<Object>& clauses, std::shared_ptr<Object> test) {
+    if (IsFalse(test)) {
+        return CondClause(As<Cell>(clauses)->GetSecond());
+    }
+    auto body = As<Cell>(As<Cell>(clauses)->GetFirst())->GetSecond();
+    if (!body) {
+        return FormStep::Value(std::move(test));
+    }
+    return Sequence(body);
+}
+
+// (cond (test expr ...) ... [(else expr ...)]). With no matching clause the value is #f.
+Result<FormStep> Cond(const std::shared_ptr<Object>& args, const std::shared_ptr<Environment>&) {
+    SCHEME_CHECK(CheckProperList(args, "cond: improper list of clauses"));
+    return CondClause(args);
+}
+
+// (begin expr ...)
+Result<FormStep> Begin(const std::shared_ptr<Object>& args, const std::shared_ptr<Environment>&) {
+    SCHEME_CHECK(CheckProperList(args, "begin: improper list of expressions"));
+    if (!args) {
+        return Error::Syntax("begin: expected at least one expression");
+    }
+    return Sequence(args);
+}
+
+// (lambda (param ...) body ...) closes over the environment it is evaluated in.
+Result<FormStep> Lambda(const std::shared_ptr<Object>& args,
+                        const std::shared_ptr<Environment>& env) {
+    SCHEME_TRY(auto params, LambdaParams(args));
+    return FormStep::Value(Make<Closure>(As<Cell>(args)->GetFirst(), params.size(),
+                                         As<Cell>(args)->GetSecond(), env));
+}
+
+Result<FormStep> DefineValue(const std::shared_ptr<Object>& name, std::shared_ptr<Object> value) {
+    size_t slot = CurrentGlobals()->Intern(As<Symbol>(name)->GetName());
+    SCHEME_TRY(auto result, DefineGlobal(slot, value));
+    return FormStep::Value(std::move(result));
+}
+
+// (define name expr) binds a global, outside of any lambda. Evaluates to the name.
+Result<FormStep> Define(const std::shared_ptr<Object>& args,
+                        const std::shared_ptr<Environment>& env) {
+    if (env) {
+        return Error::Syntax("define: only allowed at top level");
+    }
+    SCHEME_TRY(auto definition, DefineParts(args));
+    if (!CurrentGlobals()) {
+        return Error::Runtime("define: no interpreter to define in");
+    }
+    return FormStep::Then(std::move(definition.value), DefineValue,
+                          Make<Symbol>(definition.name));
+}
+
+Result<FormStep> RecordTypeForm(const std::shared_ptr<Object>& args,
+                                const std::shared_ptr<Environment>&) {
+    SCHEME_TRY(auto name, DefineRecordType(args));
+    return FormStep::Value(std::move(name));
+}
+
+}  // namespace
+
+Result<FormStep> Sequence(const std::shared_ptr<Object>& body) {
+    auto cell = As<Cell>(body);
+    if (!cell->GetSecond()) {
+        return FormStep::Eval(cell->GetFirst());
+    }
+    return FormStep::Then(cell->GetFirst(), SequenceRest, cell->GetSecond());
+}
+
+Result<std::vector<std::string>> LambdaParams(const std::shared_ptr<Object>& args) {
+    SCHEME_TRY(auto parts, FormToVector(args));
+    if (parts.size() < 2) {
+        return Error::Syntax("lambda: expected parameters and a body");
+    }
+    SCHEME_TRY(auto params, FormToVector(parts[0]));
+    std::vector<std::string> names;
+    for (const auto& param : params) {
+        SCHEME_TRY(auto name, FormSymbol(param));
+        for (const auto& prev : names) {
+            if (prev == name) {
+                return Error::Syntax("lambda: duplicate parameter " + name);
+            }
+        }
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+Result<Definition> DefineParts(const std::shared_ptr<Object>& args) {
+    SCHEME_TRY(auto parts, FormToVector(args));
+    if (parts.empty()) {
+        return Error::Syntax("define: expected a name and a value");
+    }
+    Definition definition;
+    if (Is<Cell>(parts[0])) {
+        auto signature = As<Cell>(parts[0]);
+        SCHEME_TRY(definition.name, FormSymbol(signature->GetFirst()));
+        auto lambda_args = Make<Cell>(signature->GetSecond(), As<Cell>(args)->GetSecond());
+        SCHEME_CHECK(LambdaParams(lambda_args));
+        definition.value = Make<Cell>(Make<Symbol>("lambda"), std::move(lambda_args));
+    } else {
+        if (parts.size() != 2) {
+            return Error::Syntax("define: expected a name and a value");
+        }
+        SCHEME_TRY(definition.name, FormSymbol(parts[0]));
+        definition.value = parts[1];
+    }
+    if (FindSpecialForm(definition.name) || FindBuiltin(definition.name)) {
+        return Error::Syntax("define: cannot redefine " + definition.name);
+    }
+    return definition;
+}
+
+SpecialFormRegistry::SpecialFormRegistry() {
+    Add("quote", Quote);
+    Add("and", Connective<true>);
+    Add("or", Connective<false>);
+    Add("if", If);
+    Add("cond", Cond);
+    Add("begin", Begin);
+    Add("lambda", Lambda);
+    Add("define", Define);
+    Add("define-record-type", RecordTypeForm);
+}
+
+const SpecialFormRegistry& SpecialFormRegistry::Get() {
+    static const SpecialFormRegistry registry;
+    return registry;
+}
+
+void SpecialFormRegistry::Add(const std::string& name, SpecialForm form) {
+    table_.Insert(name, form);
+}
+
+SpecialForm SpecialFormRegistry::Find(const std::string& name) const {
+    const SpecialForm* form = table_.Find(name);
+    return form ? *form : nullptr;
+}
+
+SpecialForm FindSpecialForm(const std::string& name) {
+    return SpecialFormRegistry::Get().Find(name);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flat_table.h"
+#include "object.h"
+
+// What a special form asks the evaluator to do next. Forms never evaluate subexpressions
+// themselves: they hand them to the evaluator together with the function to resume with, so
+// that nesting grows the evaluator's stack and not the native one.
+struct FormStep {
+    enum class Kind { VALUE, EVAL, THEN };
+
+    // Called with the saved state and the value of the expression that was evaluated.
+    using Resume = Result<FormStep> (*)(const std::shared_ptr<Object>& state,
+                                        std::shared_ptr<Object> value);
+
+    // The form is done and evaluates to `value`.
+    static FormStep Value(std::shared_ptr<Object> value) {
+        return {Kind::VALUE, std::move(value), nullptr, nullptr};
+    }
+
+    // The form evaluates to whatever `expr` does; it is evaluated in place of the form.
+    static FormStep Eval(std::shared_ptr<Object> expr) {
+        return {Kind::EVAL, std::move(expr), nullptr, nullptr};
+    }
+
+    // Evaluates `expr`, then continues with `resume`.
+    static FormStep Then(std::shared_ptr<Object> expr, Resume resume, std::shared_ptr<Object> state) {
+        return {Kind::THEN, std::move(expr), resume, std::move(state)};
+    }
+
+    Kind kind;
+    // The value for VALUE, otherwise the expression to evaluate.
+    std::shared_ptr<Object> object;
+    Resume resume;
+    std::shared_ptr<Object> state;
+};
+
+// Checks the arguments of (lambda (param ...) body ...) and returns the parameter names.
+Result<std::vector<std::string>> LambdaParams(const std::shared_ptr<Object>& args);
+
+// What (define name expr) binds name to, or (define (name param ...) body ...), which binds it to
+// (lambda (param ...) body ...).
+struct Definition {
+    std::string name;
+    std::shared_ptr<Object> value;
+};
+
+// Checks the arguments of define. Builtins and special forms are found before globals, so they
+// cannot be redefined.
+Result<Definition> DefineParts(const std::shared_ptr<Object>& args);
+
+// Body of a special form: takes the form's argument list unevaluated and the environment that the
+// form is evaluated in.
+using SpecialForm = Result<FormStep> (*)(const std::shared_ptr<Object>& args,
+                                         const std::shared_ptr<Environment>& env);
+
+// Everything except #f counts as true.
+inline bool IsFalse(const std::shared_ptr<Object>& obj) {
+    return Is<Bool>(obj) && !As<Bool>(obj)->GetVal();
+}
+
+// Evaluates the expressions of the non-empty proper list `body` in order; the value is the last
+// one's, which is evaluated in place of the form.
+Result<FormStep> Sequence(const std::shared_ptr<Object>& body);
+
+// Forms whose arguments are not evaluated before the call: each one gets its argument list as
+// written and evaluates only the parts it needs. Looked up before the builtins, so a special form
+// cannot be shadowed by a procedure of the same name.
+class SpecialFormRegistry {
+public:
+    SpecialFormRegistry(const SpecialFormRegistry&) = delete;
+    SpecialFormRegistry& operator=(const SpecialFormRegistry&) = delete;
+
+    static const SpecialFormRegistry& Get();
+
+    void Add(const std::string& name, SpecialForm form);
+
+    // nullptr if `name` is not a special form.
+    SpecialForm Find(const std::string& name) const;
+
+private:
+    SpecialFormRegistry();
+
+    FlatTable<std::string, SpecialForm, std::hash<std::string>, std::equal_to<std::string>> table_;
+};
+
+// The special form called `name`, nullptr if there is none.
+SpecialForm FindSpecialForm(const std::string& name);
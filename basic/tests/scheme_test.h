@@ -27,6 +27,14 @@ public:
         REQUIRE_THROWS_AS(interpreter_.Run(expression), NameError);
     }
 
+    // Checks the error that TryRun reports for `expression`.
+    void ExpectError(std::string expression, Error::Kind kind, const std::string& message) {
+        auto result = interpreter_.TryRun(expression);
+        REQUIRE(!result);
+        REQUIRE(result.GetError().kind == kind);
+        REQUIRE(result.GetError().message == message);
+    }
+
 private:
     Interpreter interpreter_;
 };
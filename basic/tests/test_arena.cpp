@@ -0,0 +1,153 @@
+#include <catch.hpp>
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include <parser.h>
+
+namespace {
+
+size_t heap_allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++heap_allocations;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+TEST_CASE("Arena reuses memory after reset") {
+    Arena arena(1024);
+    void* first = arena.Allocate(16, 8);
+    REQUIRE(arena.Owns(first));
+    REQUIRE(arena.BytesUsed() >= 16);
+    for (int i = 0; i < 1000; ++i) {
+        arena.Allocate(24, 8);
+    }
+    arena.Reset();
+    REQUIRE(arena.BytesUsed() == 0);
+    REQUIRE(arena.Allocate(16, 8) == first);
+    REQUIRE(arena.Allocations() == 1002);
+
+    void* big = arena.Allocate(1 << 20, 16);
+    REQUIRE(arena.Owns(big));
+    REQUIRE(reinterpret_cast<uintptr_t>(big) % 16 == 0);
+}
+
+TEST_CASE("Arena reuses deallocated blocks of the same size class") {
+    Arena arena(1024);
+    void* first = arena.Allocate(40, 8);
+    void* second = arena.Allocate(40, 8);
+    arena.Deallocate(first, 40, 8);
+    REQUIRE(arena.Allocate(48, 16) == first);
+    REQUIRE(reinterpret_cast<uintptr_t>(first) % 16 == 0);
+    arena.Deallocate(second, 40, 8);
+    REQUIRE(arena.Allocate(16, 8) != second);
+    REQUIRE(arena.Allocate(33, 8) == second);
+}
+
+TEST_CASE("Objects are allocated in the current arena") {
+    Arena arena;
+    {
+        ArenaScope scope(&arena);
+        auto num = Make<Number>(int64_t(5));
+        REQUIRE(arena.Owns(num.get()));
+        {
+            HeapScope heap_scope;
+            auto heap_num = Make<Number>(int64_t(5));
+            REQUIRE(!arena.Owns(heap_num.get()));
+        }
+    }
+    REQUIRE(arena.BytesUsed() == 0);
+    REQUIRE(CurrentArena() == nullptr);
+}
+
+TEST_CASE("Promoted objects survive arena reset") {
+    Arena arena;
+    std::shared_ptr<Object> promoted;
+    {
+        ArenaScope scope(&arena);
+        std::stringstream ss{"(1 #(2 (3 . #t)) foo)"};
+        Tokenizer tokenizer{&ss};
+        auto obj = Read(&tokenizer);
+        REQUIRE(arena.Owns(obj.get()));
+        promoted = Promote(obj);
+        REQUIRE(!arena.Owns(promoted.get()));
+    }
+    {
+        ArenaScope scope(&arena);
+        for (int i = 0; i < 100; ++i) {
+            Make<Cell>(Make<Number>(int64_t(i)), nullptr);
+        }
+    }
+    REQUIRE(promoted->Serialise() == "(1 #(2 (3 . #t)) foo)");
+}
+
+TEST_CASE("Object heap carves storage from aligned regions") {
+    ObjectHeap heap;
+    REQUIRE(heap.GetStats().regions_mapped == 0);
+
+    void* first = heap.Allocate(100);
+    REQUIRE(reinterpret_cast<uintptr_t>(first) % ObjectHeap::kHugePageSize == 0);
+    REQUIRE(heap.Owns(first));
+    auto stats = heap.GetStats();
+    REQUIRE(stats.regions_mapped == 1);
+    REQUIRE(stats.bytes_mapped == ObjectHeap::kDefaultRegionSize);
+    REQUIRE(stats.bytes_used == 112);
+
+    heap.Allocate(ObjectHeap::kDefaultRegionSize + 1);
+    stats = heap.GetStats();
+    REQUIRE(stats.regions_mapped == 2);
+    REQUIRE(stats.bytes_mapped >= 2 * ObjectHeap::kDefaultRegionSize);
+
+    heap.SetHugePages(false);
+    REQUIRE(heap.GetStats().huge_page_regions == 0);
+}
+
+#ifdef SCHEME_COMPRESSED_REFS
+TEST_CASE("Pairs and vectors hold compressed references") {
+    REQUIRE(sizeof(ObjectRef) == 4);
+    REQUIRE(sizeof(Cell) <= 2 * sizeof(void*));
+
+    Arena arena;
+    ArenaScope scope(&arena);
+    auto num = Make<Number>(int64_t(7));
+    REQUIRE(CompressedHeap()->Owns(num.get()));
+    auto cell = Make<Cell>(num, nullptr);
+    REQUIRE(cell->GetFirst().get() == num.get());
+    REQUIRE(!cell->GetSecond());
+
+    auto vec = Make<Vector>(size_t(3), cell);
+    vec->Set(1, num);
+    REQUIRE(vec->Get(0).get() == cell.get());
+    REQUIRE(vec->Serialise() == "#((7) 7 (7))");
+}
+#endif
+
+TEST_CASE("Builtin calls pass arguments without heap allocation") {
+    Arena arena;
+    ArenaScope scope(&arena);
+    std::stringstream ss{"(+ 1 (* 2 3) (- 9 4))"};
+    Tokenizer tokenizer{&ss};
+    auto expr = Read(&tokenizer);
+    // The first call sets up the builtins and the argument stack.
+    REQUIRE((*EvalExpr(expr))->Serialise() == "12");
+
+    size_t before = heap_allocations;
+    for (int i = 0; i < 100; ++i) {
+        EvalExpr(expr);
+    }
+    REQUIRE(heap_allocations == before);
+}
@@ -0,0 +1,53 @@
+#include "scheme_test.h"
+
+#include <bigint.h>
+
+TEST_CASE_METHOD(SchemeTest, "BignumLiterals") {
+    ExpectEq("123456789012345678901234567890", "123456789012345678901234567890");
+    ExpectEq("-123456789012345678901234567890", "-123456789012345678901234567890");
+    ExpectEq("9223372036854775807", "9223372036854775807");
+    ExpectEq("9223372036854775808", "9223372036854775808");
+    ExpectEq("(number? 123456789012345678901234567890)", "#t");
+}
+
+TEST_CASE_METHOD(SchemeTest, "FixnumOverflowPromotes") {
+    ExpectEq("(* 4294967296 4294967296)", "18446744073709551616");
+    ExpectEq("(+ 9223372036854775807 1)", "9223372036854775808");
+    ExpectEq("(- -9223372036854775808 1)", "-9223372036854775809");
+    ExpectEq("(abs -9223372036854775808)", "9223372036854775808");
+    ExpectEq("(/ -9223372036854775808 -1)", "9223372036854775808");
+    ExpectEq("(* 99999999999 99999999999 99999999999)", "999999999970000000000299999999999");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumsDemoteWhenSmall") {
+    ExpectEq("(- (+ 9223372036854775807 1) 1)", "9223372036854775807");
+    ExpectEq("(- 123456789012345678901234567890 123456789012345678901234567890)", "0");
+    ExpectEq("(/ 123456789012345678901234567890 123456789012345678901234567890)", "1");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumArithmetic") {
+    ExpectEq("(/ 123456789012345678901234567890 10)", "12345678901234567890123456789");
+    ExpectEq("(/ -123456789012345678901234567890 7)", "-17636684144620811271604938270");
+    ExpectEq("(max 1 123456789012345678901234567890 -5)", "123456789012345678901234567890");
+    ExpectEq("(min 1 -123456789012345678901234567890 -5)", "-123456789012345678901234567890");
+    ExpectEq("(abs -123456789012345678901234567890)", "123456789012345678901234567890");
+
+    ExpectRuntimeError("(/ 123456789012345678901234567890 0)");
+    ExpectRuntimeError("(+ 123456789012345678901234567890 #t)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumComparison") {
+    ExpectEq("(< 1 123456789012345678901234567890 123456789012345678901234567891)", "#t");
+    ExpectEq("(> -123456789012345678901234567890 0)", "#f");
+    ExpectEq("(= 123456789012345678901234567890 123456789012345678901234567890)", "#t");
+    ExpectEq("(= (+ 9223372036854775807 1) 9223372036854775808)", "#t");
+}
+
+TEST_CASE("Karatsuba agrees with schoolbook multiplication") {
+    BigInt a = BigInt::FromString(std::string(700, '7'));
+    BigInt b = -BigInt::FromString(std::string(650, '3') + "1");
+    REQUIRE(a.LimbCount() > 64);
+    REQUIRE(Compare(a * b, BigInt::MulSchoolbook(a, b)) == 0);
+    REQUIRE(Compare((a * b) / b, a) == 0);
+    REQUIRE(((a * b) % a).IsZero());
+}
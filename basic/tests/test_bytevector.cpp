@@ -0,0 +1,51 @@
+#include "scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "BytevectorLiterals") {
+    ExpectEq("#u8()", "#u8()");
+    ExpectEq("#u8(1 2 255)", "#u8(1 2 255)");
+    ExpectEq("'#u8(0)", "#u8(0)");
+    ExpectEq("(bytevector? #u8(1))", "#t");
+    ExpectEq("(bytevector? #(1))", "#f");
+
+    ExpectSyntaxError("#u8(256)");
+    ExpectSyntaxError("#u8(-1)");
+    ExpectSyntaxError("#u8(1 . 2)");
+    ExpectSyntaxError("#u8(1 2");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BytevectorConstruction") {
+    ExpectEq("(make-bytevector 3 7)", "#u8(7 7 7)");
+    ExpectEq("(make-bytevector 2)", "#u8(0 0)");
+    ExpectEq("(bytevector)", "#u8()");
+    ExpectEq("(bytevector 1 (+ 1 1))", "#u8(1 2)");
+    ExpectEq("(bytevector-length #u8(1 2 3))", "3");
+
+    ExpectRuntimeError("(make-bytevector -1)");
+    ExpectRuntimeError("(make-bytevector 2 256)");
+    ExpectRuntimeError("(bytevector 1 #t)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BytevectorAccess") {
+    ExpectEq("(bytevector-u8-ref #u8(5 6) 1)", "6");
+    ExpectEq("(bytevector-u8-set! (make-bytevector 2) 0 9)", "#u8(9 0)");
+    ExpectEq("(bytevector-fill! (make-bytevector 3) 4)", "#u8(4 4 4)");
+
+    ExpectRuntimeError("(bytevector-u8-ref #u8(5 6) 2)");
+    ExpectRuntimeError("(bytevector-u8-set! #u8(1) 0 300)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BytevectorBulkOperations") {
+    ExpectEq("(bytevector-copy #u8(1 2 3 4))", "#u8(1 2 3 4)");
+    ExpectEq("(bytevector-copy #u8(1 2 3 4) 2)", "#u8(3 4)");
+    ExpectEq("(bytevector-copy #u8(1 2 3 4) 1 3)", "#u8(2 3)");
+    ExpectEq("(bytevector=? #u8(1 2) (bytevector 1 2) #u8(1 2))", "#t");
+    ExpectEq("(bytevector=? #u8(1 2) #u8(1 3))", "#f");
+    ExpectEq("(bytevector=? #u8() #u8())", "#t");
+    ExpectEq("(bytevector-index #u8(1 2 3 2) 2)", "1");
+    ExpectEq("(bytevector-index #u8(1 2 3 2) 2 2)", "3");
+    ExpectEq("(bytevector-index #u8(1 2 3) 9)", "#f");
+    ExpectEq("(equal? #u8(1 2) #u8(1 2))", "#t");
+
+    ExpectRuntimeError("(bytevector-copy #u8(1 2) 2 1)");
+    ExpectRuntimeError("(bytevector=? #u8(1) '(1))");
+}
@@ -0,0 +1,109 @@
+#include "scheme_test.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Runs `programs` in order with each engine, on one interpreter per engine so that globals carry
+// over, and requires the same values and errors as the tree evaluator.
+void ExpectSameInEngines(const std::vector<std::string>& programs) {
+    Interpreter tree;
+    Interpreter bytecode;
+    bytecode.SetEngine(Engine::BYTECODE);
+    Interpreter nodes;
+    nodes.SetEngine(Engine::NODES);
+    for (const auto& program : programs) {
+        INFO(program);
+        auto expected = tree.TryRun(program);
+        for (Interpreter* interpreter : {&bytecode, &nodes}) {
+            auto actual = interpreter->TryRun(program);
+            REQUIRE(!!expected == !!actual);
+            if (expected) {
+                REQUIRE(*expected == *actual);
+            } else {
+                REQUIRE(expected.GetError().kind == actual.GetError().kind);
+                REQUIRE(expected.GetError().message == actual.GetError().message);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(SchemeTest, "DefineValue") {
+    ExpectEq("(define x 5)", "x");
+    ExpectEq("x", "5");
+    ExpectEq("(+ x 1)", "6");
+    ExpectEq("(define x (* x 2))", "x");
+    ExpectEq("x", "10");
+    ExpectNameError("y");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DefineProcedure") {
+    ExpectEq("(define (square n) (* n n))", "square");
+    ExpectEq("(square 7)", "49");
+    ExpectEq("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))", "fib");
+    ExpectEq("(fib 15)", "610");
+    ExpectEq("(square (square 2))", "16");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DefineCapturesEnclosingVariables") {
+    ExpectEq("(define (adder n) (lambda (x) (+ x n)))", "adder");
+    ExpectEq("(define add3 (adder 3))", "add3");
+    ExpectEq("(add3 4)", "7");
+    ExpectEq("(define (curry a) (lambda (b) (lambda (c) (list a b c))))", "curry");
+    ExpectEq("(((curry 1) 2) 3)", "(1 2 3)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DefineKeepsContainersAcrossRuns") {
+    ExpectEq("(define v (make-vector 2 0))", "v");
+    ExpectNoError("(vector-set! v 0 (list 1 2))");
+    ExpectEq("v", "#((1 2) 0)");
+    ExpectEq("(define t (make-hash-table))", "t");
+    ExpectNoError("(hash-table-set! t (list 'k) (lambda (x) (* x 3)))");
+    ExpectEq("((hash-table-ref t (list 'k)) 5)", "15");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DefineErrors") {
+    ExpectError("(define)", Error::Kind::SYNTAX, "define: expected a name and a value");
+    ExpectError("(define x)", Error::Kind::SYNTAX, "define: expected a name and a value");
+    ExpectError("(define x 1 2)", Error::Kind::SYNTAX, "define: expected a name and a value");
+    ExpectSyntaxError("(define 1 2)");
+    ExpectSyntaxError("(define (f 1) 2)");
+    ExpectError("(define car 1)", Error::Kind::SYNTAX, "define: cannot redefine car");
+    ExpectError("(define if 1)", Error::Kind::SYNTAX, "define: cannot redefine if");
+    ExpectError("((lambda () (define x 1)))", Error::Kind::SYNTAX,
+                "define: only allowed at top level");
+}
+
+TEST_CASE("DefineInEngines") {
+    ExpectSameInEngines({
+        "(define x 5)",
+        "x",
+        "(define (f n) (+ n x))",
+        "(f 1)",
+        "(define x 10)",
+        "(f 1)",
+        "(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))",
+        "(loop 100000 0)",
+        "(define (even? n) (if (= n 0) #t (odd? (- n 1))))",
+        "(define (odd? n) (if (= n 0) #f (even? (- n 1))))",
+        "(even? 10001)",
+        "(define (make-counter) ((lambda (n) (lambda () n)) 7))",
+        "((make-counter))",
+        "(define v (make-vector 1 0))",
+        "(vector-set! v 0 (cons 1 2))",
+        "v",
+        "(define f 3)",
+        "(f 1)",
+        "undefined",
+        "(undefined 1)",
+        "(define (g x x) x)",
+        "(define car 1)",
+        "((lambda (y) (define z y)) 1)",
+        "(define-record-type point (make-point x y) point? (x point-x))",
+        "(define p (make-point 1 2))",
+        "(point-x p)",
+    });
+}
@@ -0,0 +1,55 @@
+#include "scheme_test.h"
+
+#include <string>
+
+namespace {
+
+std::string Nested(const std::string& open, const std::string& inner, const std::string& close,
+                   int depth) {
+    std::string ans;
+    for (int i = 0; i < depth; ++i) {
+        ans += open;
+    }
+    ans += inner;
+    for (int i = 0; i < depth; ++i) {
+        ans += close;
+    }
+    return ans;
+}
+
+constexpr int kDeep = 300000;
+
+}  // namespace
+
+TEST_CASE_METHOD(SchemeTest, "DeepCallsDoNotOverflowTheStack") {
+    ExpectEq(Nested("(+ 1 ", "0", ")", kDeep), std::to_string(kDeep));
+    ExpectEq(Nested("(car (list ", "7", "))", kDeep), "7");
+    ExpectEq(Nested("(if #t ", "1", " 2)", kDeep), "1");
+    ExpectEq(Nested("(and 1 ", "2", ")", kDeep), "2");
+}
+
+TEST_CASE_METHOD(SchemeTest, "DeepDataDoNotOverflowTheStack") {
+    auto list = Nested("(", "", ")", kDeep);
+    ExpectEq("'" + list, list);
+    auto vector = Nested("#(", "", ")", kDeep);
+    ExpectEq("'" + vector, vector);
+}
+
+TEST_CASE("DepthLimit") {
+    Interpreter interpreter;
+    interpreter.SetEvalDepthLimit(100);
+    REQUIRE(interpreter.Run(Nested("(+ 1 ", "0", ")", 100)) == "100");
+    REQUIRE_THROWS_AS(interpreter.Run(Nested("(+ 1 ", "0", ")", 101)), RuntimeError);
+    auto result = interpreter.TryRun(Nested("(- ", "0", ")", 1000));
+    REQUIRE(!result);
+    REQUIRE(result.GetError().message == "maximum evaluation depth exceeded");
+    // Quoted data are not evaluated, so they are not limited.
+    REQUIRE(interpreter.Run("'" + Nested("(", "", ")", 1000)) == Nested("(", "", ")", 1000));
+    // Neither is a sequence of calls in tail position.
+    REQUIRE(interpreter.Run(Nested("(if #f 0 ", "1", ")", 1000)) == "1");
+}
+
+TEST_CASE_METHOD(SchemeTest, "ErrorsInsideDeepCalls") {
+    ExpectRuntimeError(Nested("(+ 1 ", "(car 1)", ")", kDeep));
+    ExpectEq("(+ 1 2)", "3");
+}
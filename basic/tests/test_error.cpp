@@ -0,0 +1,42 @@
+#include "scheme_test.h"
+
+TEST_CASE("TryRun returns the value") {
+    Interpreter interpreter;
+    auto result = interpreter.TryRun("(+ 1 2)");
+    REQUIRE(result);
+    REQUIRE(*result == "3");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Errors name the failing builtin") {
+    ExpectError("(car 1)", Error::Kind::RUNTIME, "car: not a pair");
+    ExpectError("(cdr)", Error::Kind::RUNTIME, "cdr: wrong number of arguments");
+    ExpectError("(vector-ref #(1 2) 5)", Error::Kind::RUNTIME, "vector-ref: index out of range");
+    ExpectError("(+ 1 #t)", Error::Kind::RUNTIME, "+: not a number");
+    ExpectError("(/ 1 0)", Error::Kind::RUNTIME, "/: division by zero");
+    ExpectError("(hash-table-ref (make-hash-table) 1)", Error::Kind::RUNTIME,
+                "hash-table-ref: key not found");
+}
+
+TEST_CASE_METHOD(SchemeTest, "The innermost failing call is named") {
+    ExpectError("(+ 1 (car '()))", Error::Kind::RUNTIME, "car: not a pair");
+    ExpectError("(list (undefined 1))", Error::Kind::NAME, "undefined");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Syntax and name errors are returned") {
+    ExpectError("(1 2", Error::Kind::SYNTAX, "unexpected end of input");
+    ExpectError(")", Error::Kind::SYNTAX, "unexpected )");
+    ExpectError("1 2", Error::Kind::SYNTAX, "more than one expression");
+    ExpectError("foo", Error::Kind::NAME, "foo");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Record procedures are named") {
+    ExpectNoError("(define-record-type point (make-point x y) point? (x point-x) (y point-y))");
+    ExpectError("(point-x 1)", Error::Kind::RUNTIME, "point-x: not a point");
+    ExpectError("(make-point 1)", Error::Kind::RUNTIME, "make-point: wrong number of arguments");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Run still throws") {
+    ExpectRuntimeError("(car 1)");
+    ExpectSyntaxError("(1 2");
+    ExpectNameError("foo");
+}
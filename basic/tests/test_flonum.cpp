@@ -0,0 +1,47 @@
+#include "scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "FlonumLiterals") {
+    ExpectEq("1.5", "1.5");
+    ExpectEq("-0.25", "-0.25");
+    ExpectEq(".5", "0.5");
+    ExpectEq("100.0", "100.0");
+    ExpectEq("2e3", "2000.0");
+    ExpectEq("1e21", "1e+21");
+    ExpectEq("1e400", "+inf.0");
+    ExpectEq("'(1.5 . 2)", "(1.5 . 2)");
+    ExpectEq("(number? 1.5)", "#t");
+
+    ExpectSyntaxError("1e");
+}
+
+TEST_CASE_METHOD(SchemeTest, "FlonumsPrintShortestRoundTrip") {
+    ExpectEq("0.1", "0.1");
+    ExpectEq("(* 0.1 3)", "0.30000000000000004");
+    ExpectEq("(/ 1.0 3)", "0.3333333333333333");
+    ExpectEq("-0.0", "-0.0");
+}
+
+TEST_CASE_METHOD(SchemeTest, "MixedArithmetic") {
+    ExpectEq("(+ 1 2.5)", "3.5");
+    ExpectEq("(+ 1.5 1)", "2.5");
+    ExpectEq("(- 10 0.5 1)", "8.5");
+    ExpectEq("(* 2 1.5 2)", "6.0");
+    ExpectEq("(/ 1 4.0)", "0.25");
+    ExpectEq("(/ 7 2)", "3");
+    ExpectEq("(/ 1 0.0)", "+inf.0");
+    ExpectEq("(+ 9223372036854775807 1 0.5)", "9223372036854775808.0");
+    ExpectEq("(max 1 2.0)", "2.0");
+    ExpectEq("(min 1 2.0)", "1.0");
+    ExpectEq("(abs -2.5)", "2.5");
+
+    ExpectRuntimeError("(+ 1.5 #t)");
+    ExpectRuntimeError("(abs 1.5 2)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "MixedComparison") {
+    ExpectEq("(< 1 1.5 2)", "#t");
+    ExpectEq("(= 1 1.0)", "#t");
+    ExpectEq("(> 2.5 123456789012345678901234567890)", "#f");
+    ExpectEq("(< 1 (/ 0.0 0.0))", "#f");
+    ExpectEq("(>= (/ 0.0 0.0) 1)", "#f");
+}
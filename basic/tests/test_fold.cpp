@@ -0,0 +1,82 @@
+#include "scheme_test.h"
+
+#include <sstream>
+#include <string>
+
+#include <fold.h>
+#include <parser.h>
+
+namespace {
+
+std::string Fold(const std::string& expr, size_t depth_limit = kDefaultEvalDepthLimit) {
+    std::stringstream ss{expr};
+    Tokenizer tokenizer{&ss};
+    return SerialiseExpr(FoldConstants(Read(&tokenizer), depth_limit));
+}
+
+}  // namespace
+
+TEST_CASE("FoldConstantCalls") {
+    REQUIRE(Fold("(+ 1 (* 2 3))") == "7");
+    REQUIRE(Fold("(< 1 2.5)") == "#t");
+    REQUIRE(Fold("(not (pair? '(1)))") == "#f");
+    REQUIRE(Fold("(+ 1 (f 2 (* 3 4)))") == "(+ 1 (f 2 12))");
+    REQUIRE(Fold("(list 1 (- 3 2))") == "(list 1 1)");
+    REQUIRE(Fold("'(+ 1 2)") == "(quote (+ 1 2))");
+    // A variable shadows the builtin of the same name.
+    REQUIRE(Fold("(lambda (*) (* 2 (+ 1 1)))") == "(lambda (*) (* 2 2))");
+}
+
+TEST_CASE("FoldKeepsFailingCalls") {
+    REQUIRE(Fold("(/ 1 0)") == "(/ 1 0)");
+    REQUIRE(Fold("(+ 1 (car 1))") == "(+ 1 (car 1))");
+    REQUIRE(Fold("(abs 'a)") == "(abs (quote a))");
+    REQUIRE(Fold("(if (+ 1 2) 3 4 5)") == "(if 3 3 4 5)");
+}
+
+TEST_CASE("FoldPrunesBranches") {
+    REQUIRE(Fold("(if (< 1 2) (f x) (g))") == "(f x)");
+    REQUIRE(Fold("(if #f 1)") == "#f");
+    REQUIRE(Fold("(and x #t y)") == "(and x y)");
+    REQUIRE(Fold("(and x (= 1 2) y)") == "(and x #f)");
+    REQUIRE(Fold("(or #f (= 1 2) y)") == "y");
+    REQUIRE(Fold("(or 1 (car 1))") == "1");
+    REQUIRE(Fold("(and)") == "(and)");
+    REQUIRE(Fold("(begin 1 (f) 2 (g))") == "(begin (f) (g))");
+    REQUIRE(Fold("(cond (#f 1) (x 2) (#t 3) (y 4))") == "(cond (x 2) (#t 3))");
+    REQUIRE(Fold("(cond ((= 1 2) 1) ((= 1 1) (f) (g)) (else 3))") == "(begin (f) (g))");
+    REQUIRE(Fold("(cond (#f 1))") == "#f");
+    // Malformed forms are left to the evaluator to reject.
+    REQUIRE(Fold("(cond (#f 1) (else 2) (#t 3))") == "(cond (#f 1) (else 2) (#t 3))");
+    REQUIRE(Fold("(if #t)") == "(if #t)");
+}
+
+TEST_CASE("FoldStopsAtTheDepthLimit") {
+    REQUIRE(Fold("(+ 1 (+ 1 (+ 1 0)))", 3) == "3");
+    REQUIRE(Fold("(+ 1 (+ 1 (+ 1 0)))", 2) == "(+ 1 (+ 1 (+ 1 0)))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "FoldedProgramsKeepTheirValuesAndErrors") {
+    ExpectEq("(if (< 1 2) 'yes (car 1))", "yes");
+    ExpectEq("(not (and #f undefined))", "#t");
+    ExpectEq("((lambda (+) (+ 1 2)) -)", "-1");
+    ExpectEq("(eq? '(1) '(1))", "#f");
+    ExpectEq("(cond (#f (car 1)) ((= 1 1) 'b) (else (car 1)))", "b");
+    ExpectError("(/ 1 0)", Error::Kind::RUNTIME, "/: division by zero");
+    ExpectError("(+ 1 (if #t (car 1) 2))", Error::Kind::RUNTIME, "car: not a pair");
+    ExpectNameError("(and #t undefined)");
+}
+
+TEST_CASE("FoldStats") {
+    Interpreter interpreter;
+    FoldStats stats;
+    interpreter.SetFoldStats(&stats);
+    REQUIRE(interpreter.Run("(+ 1 (* 2 3))") == "7");
+    REQUIRE(stats.folded == 2);
+    REQUIRE(interpreter.Run("(if (< 1 2) 'yes 'no)") == "yes");
+    REQUIRE(stats.folded == 3);
+    REQUIRE(stats.pruned == 1);
+    interpreter.SetFoldStats(nullptr);
+    interpreter.Run("(+ 1 2)");
+    REQUIRE(stats.folded == 3);
+}
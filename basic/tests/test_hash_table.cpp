@@ -0,0 +1,89 @@
+#include "scheme_test.h"
+
+#include <random>
+#include <unordered_map>
+
+#include <flat_table.h>
+
+TEST_CASE_METHOD(SchemeTest, "Equivalences") {
+    ExpectEq("(eq? 'a 'a)", "#t");
+    ExpectEq("(eq? 1 1)", "#t");
+    ExpectEq("(eq? '(1) '(1))", "#f");
+    ExpectEq("(eq? 1.5 1.5)", "#f");
+    ExpectEq("(eqv? 1.5 1.5)", "#t");
+    ExpectEq("(eqv? 1 1.0)", "#f");
+    ExpectEq("(eqv? 123456789012345678901234567890 123456789012345678901234567890)", "#t");
+    ExpectEq(R"((eqv? "a" "a"))", "#f");
+    ExpectEq(R"((equal? "a" "a"))", "#t");
+    ExpectEq(R"((equal? '(1 #(2 "x") . 3) '(1 #(2 "x") . 3)))", "#t");
+    ExpectEq("(equal? '(1 2) '(1 2 3))", "#f");
+
+    ExpectRuntimeError("(eq? 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableBasics") {
+    ExpectEq("(make-hash-table)", "#<hash-table>");
+    ExpectEq("(hash-table? (make-hash-table 'eqv?))", "#t");
+    ExpectEq("(hash-table? '())", "#f");
+    ExpectEq("(hash-table-ref (hash-table-set! (make-hash-table) 'a 1) 'a)", "1");
+    ExpectEq("(hash-table-ref (hash-table-set! (hash-table-set! (make-hash-table) 'a 1) 'a 2) 'a)",
+             "2");
+    ExpectEq("(hash-table-ref (make-hash-table) 'a 0)", "0");
+    ExpectEq("(hash-table-count (make-hash-table))", "0");
+    ExpectEq(
+        "(hash-table-count (hash-table-delete! (hash-table-set! (hash-table-set! (make-hash-table) "
+        "'a 1) 'b 2) 'a))",
+        "1");
+
+    ExpectRuntimeError("(hash-table-ref (make-hash-table) 'a)");
+    ExpectRuntimeError("(make-hash-table 'same?)");
+    ExpectRuntimeError("(hash-table-set! '() 1 2)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableEquivalence") {
+    ExpectEq("(hash-table-ref (hash-table-set! (make-hash-table) '(1 (2)) 'x) (list 1 (list 2)))",
+             "x");
+    ExpectEq("(hash-table-ref (hash-table-set! (make-hash-table 'eq?) '(1) 'x) '(1) 'none)",
+             "none");
+    ExpectEq("(hash-table-ref (hash-table-set! (make-hash-table 'eq?) 'k 'x) 'k)", "x");
+    ExpectEq("(hash-table-ref (hash-table-set! (make-hash-table 'eqv?) 2.5 'x) 2.5)", "x");
+    ExpectEq(R"((hash-table-ref (hash-table-set! (make-hash-table) "key" 'x) "key"))", "x");
+}
+
+TEST_CASE("FlatTable matches unordered_map") {
+    struct Hash {
+        size_t operator()(int64_t x) const {
+            // Deliberately weak, so that groups fill up and probing is exercised.
+            return x % 97;
+        }
+    };
+    FlatTable<int64_t, int64_t, Hash, std::equal_to<int64_t>> table;
+    std::unordered_map<int64_t, int64_t> expected;
+    std::mt19937 gen(42);
+    for (int i = 0; i < 200000; ++i) {
+        int64_t key = gen() % 5000;
+        switch (gen() % 3) {
+            case 0:
+                table.Insert(key, i);
+                expected[key] = i;
+                break;
+            case 1:
+                REQUIRE(table.Erase(key) == (expected.erase(key) == 1));
+                break;
+            default:
+                auto it = expected.find(key);
+                int64_t* value = table.Find(key);
+                REQUIRE((value != nullptr) == (it != expected.end()));
+                if (value) {
+                    REQUIRE(*value == it->second);
+                }
+        }
+        REQUIRE(table.Size() == expected.size());
+    }
+    size_t count = 0;
+    table.ForEach([&](int64_t key, int64_t value) {
+        REQUIRE(expected.at(key) == value);
+        ++count;
+    });
+    REQUIRE(count == expected.size());
+}
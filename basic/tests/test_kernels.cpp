@@ -0,0 +1,107 @@
+#include "scheme_test.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <kernels.h>
+
+namespace {
+
+std::string Call(const std::string& name, const std::vector<int64_t>& values) {
+    std::string ans = "(" + name;
+    for (int64_t value : values) {
+        ans += " " + std::to_string(value);
+    }
+    return ans + ")";
+}
+
+// Runs `check` with the AVX2 kernels and, if the CPU has them, with the portable ones.
+template <class F>
+void ForEachKernel(F&& check) {
+    bool enabled = SimdKernelsEnabled();
+    for (bool simd : {true, false}) {
+        SetSimdKernels(simd);
+        check();
+    }
+    SetSimdKernels(enabled);
+}
+
+}  // namespace
+
+TEST_CASE("Kernels agree with scalar folds") {
+    std::mt19937_64 gen(42);
+    ForEachKernel([&] {
+        for (size_t size : {0, 1, 3, 4, 5, 8, 17, 255, 1000}) {
+            std::vector<int64_t> data(size);
+            for (auto& value : data) {
+                value = int64_t(gen() % 2001) - 1000;
+            }
+            int64_t sum;
+            REQUIRE(!SumInt64(7, data.data(), size, &sum));
+            REQUIRE(sum == std::accumulate(data.begin(), data.end(), int64_t(7)));
+            REQUIRE(MinInt64(7, data.data(), size) ==
+                    std::min<int64_t>(7, size ? *std::min_element(data.begin(), data.end()) : 7));
+            REQUIRE(MaxInt64(7, data.data(), size) ==
+                    std::max<int64_t>(7, size ? *std::max_element(data.begin(), data.end()) : 7));
+
+            std::sort(data.begin(), data.end());
+            REQUIRE(IsChainInt64(Chain::LESS_EQUAL, data.data(), size));
+            REQUIRE(IsChainInt64(Chain::GREATER_EQUAL, data.data(), size) ==
+                    (size < 2 || data.front() == data.back()));
+            data.erase(std::unique(data.begin(), data.end()), data.end());
+            REQUIRE(IsChainInt64(Chain::LESS, data.data(), data.size()));
+            if (data.size() >= 2) {
+                std::swap(data[data.size() / 2], data[data.size() / 2 - 1]);
+                REQUIRE(!IsChainInt64(Chain::LESS, data.data(), data.size()));
+                std::reverse(data.begin(), data.end());
+                REQUIRE(!IsChainInt64(Chain::GREATER, data.data(), data.size()));
+            }
+        }
+    });
+}
+
+TEST_CASE("Sum kernel reports overflow") {
+    ForEachKernel([] {
+        std::vector<int64_t> data(9, INT64_MAX / 4);
+        int64_t sum;
+        REQUIRE(SumInt64(0, data.data(), data.size(), &sum));
+        REQUIRE(SumInt64(INT64_MAX, data.data(), 1, &sum));
+        data = {INT64_MIN, -1, 0, 0, 0};
+        REQUIRE(SumInt64(0, data.data(), data.size(), &sum));
+    });
+}
+
+TEST_CASE_METHOD(SchemeTest, "LongArgumentLists") {
+    std::vector<int64_t> values(1000);
+    std::iota(values.begin(), values.end(), -500);
+    ForEachKernel([&] {
+        ExpectEq(Call("+", values), "-500");
+        ExpectEq(Call("min", values), "-500");
+        ExpectEq(Call("max", values), "499");
+        ExpectEq(Call("<", values), "#t");
+        ExpectEq(Call("<=", values), "#t");
+        ExpectEq(Call(">", values), "#f");
+        ExpectEq(Call("=", std::vector<int64_t>(300, 3)), "#t");
+
+        auto big = values;
+        big[600] = INT64_MAX;
+        ExpectEq(Call("+", big), "9223372036854775207");
+        ExpectEq(Call("<", big), "#f");
+        big[601] = INT64_MAX;
+        ExpectEq(Call("+", big), "18446744073709550913");
+        ExpectEq("(+ 1 2 3 4 5 6 7 8 1.5)", "37.5");
+        ExpectEq("(max 1 2 3 4 5 6 7 8 9 123456789012345678901234567890)",
+                 "123456789012345678901234567890");
+
+        auto unsorted = values;
+        std::swap(unsorted[998], unsorted[999]);
+        ExpectEq(Call("<", unsorted), "#f");
+        std::swap(unsorted[256], unsorted[255]);
+        ExpectEq(Call(">=", unsorted), "#f");
+        auto call = Call("<", values);
+        ExpectRuntimeError(call.substr(0, call.size() - 1) + " #t)");
+    });
+}
@@ -0,0 +1,121 @@
+#include "scheme_test.h"
+
+#include <map>
+#include <random>
+
+#include <hamt.h>
+
+TEST_CASE_METHOD(SchemeTest, "MapBasics") {
+    ExpectEq("(make-map)", "#<map>");
+    ExpectEq("(map? (make-map))", "#t");
+    ExpectEq("(map? '())", "#f");
+    ExpectEq("(map-size (make-map))", "0");
+    ExpectEq("(map-ref (map-set (make-map) 'a 1 'b 2) 'b)", "2");
+    ExpectEq("(map-ref (map-set (map-set (make-map) 'a 1) 'a 2) 'a)", "2");
+    ExpectEq("(map-size (map-set (make-map) 'a 1 'b 2 'a 3))", "2");
+    ExpectEq("(map->list (map-set (make-map) 'a 1))", "((a . 1))");
+    ExpectEq("(map-ref (make-map) 'a 0)", "0");
+
+    ExpectRuntimeError("(map-ref (make-map) 'a)");
+    ExpectRuntimeError("(map-set (make-map) 'a)");
+    ExpectRuntimeError("(map-size '())");
+}
+
+TEST_CASE_METHOD(SchemeTest, "MapRemove") {
+    ExpectEq("(map-size (map-remove (map-set (make-map) 'a 1 'b 2) 'a))", "1");
+    ExpectEq("(map-size (map-remove (map-set (make-map) 'a 1 'b 2) 'a 'b 'c))", "0");
+    ExpectEq("(map-ref (map-remove (map-set (make-map) 'a 1) 'a) 'a 'gone)", "gone");
+}
+
+TEST_CASE_METHOD(SchemeTest, "MapKeysUseEqual") {
+    ExpectEq("(map-ref (map-set (make-map) '(1 \"x\") 'v) (list 1 \"x\"))", "v");
+    ExpectEq("(map-ref (map-set (make-map) 1.5 'v) 1.5)", "v");
+    ExpectEq("(map-ref (map-set (make-map) 1 'v) 1.0 'none)", "none");
+}
+
+namespace {
+
+struct IntHash {
+    size_t mask;
+    size_t operator()(int64_t x) const {
+        return (x * 0x9e3779b97f4a7c15) & mask;
+    }
+};
+
+using IntMap = Hamt<int64_t, int64_t, IntHash, std::equal_to<int64_t>>;
+
+void RequireSame(const IntMap& map, const std::map<int64_t, int64_t>& expected) {
+    REQUIRE(map.Size() == expected.size());
+    for (const auto& [key, value] : expected) {
+        const int64_t* found = map.Find(key);
+        REQUIRE(found);
+        REQUIRE(*found == value);
+    }
+    size_t count = 0;
+    map.ForEach([&](int64_t key, int64_t value) {
+        REQUIRE(expected.at(key) == value);
+        ++count;
+    });
+    REQUIRE(count == expected.size());
+}
+
+// A narrow `mask` makes keys collide on all hash bits.
+void CheckVersions(size_t mask) {
+    std::mt19937 gen(7);
+    std::vector<IntMap> versions{IntMap(IntHash{mask})};
+    std::vector<std::map<int64_t, int64_t>> expected(1);
+    for (int i = 0; i < 3000; ++i) {
+        int64_t key = gen() % 500;
+        auto map = versions.back();
+        auto model = expected.back();
+        if (gen() % 3) {
+            map = map.Set(key, i);
+            model[key] = i;
+        } else {
+            map = map.Remove(key);
+            model.erase(key);
+            REQUIRE(!map.Find(key));
+        }
+        versions.push_back(map);
+        expected.push_back(model);
+    }
+    for (size_t i = 0; i < versions.size(); i += 97) {
+        RequireSame(versions[i], expected[i]);
+    }
+    RequireSame(versions.back(), expected.back());
+}
+
+}  // namespace
+
+TEST_CASE("Old map versions stay valid") {
+    CheckVersions(~size_t(0));
+    CheckVersions(0xf000000000000003);
+}
+
+TEST_CASE("Transient updates leave the source map untouched") {
+    IntMap base(IntHash{~size_t(0)});
+    for (int64_t i = 0; i < 1000; ++i) {
+        base = base.Set(i, i);
+    }
+    IntMap::Transient batch(base);
+    for (int64_t i = 0; i < 2000; i += 2) {
+        batch.Set(i, -i);
+        batch.Remove(i + 1);
+    }
+    auto first = batch.Persistent();
+    batch.Set(0, 42);
+    auto second = batch.Persistent();
+
+    std::map<int64_t, int64_t> expected;
+    for (int64_t i = 0; i < 1000; ++i) {
+        expected[i] = i;
+    }
+    RequireSame(base, expected);
+    expected.clear();
+    for (int64_t i = 0; i < 2000; i += 2) {
+        expected[i] = -i;
+    }
+    RequireSame(first, expected);
+    expected[0] = 42;
+    RequireSame(second, expected);
+}
@@ -0,0 +1,161 @@
+#include "scheme_test.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Runs `programs` in order with the tree evaluator and with nodes, each twice so that the second
+// run takes the nodes from the cache, and requires the same values and errors.
+void ExpectSameAsTree(const std::vector<std::string>& programs) {
+    Interpreter tree;
+    Interpreter nodes;
+    nodes.SetEngine(Engine::NODES);
+    for (const auto& program : programs) {
+        INFO(program);
+        auto expected = tree.TryRun(program);
+        for (int run = 0; run < 2; ++run) {
+            auto actual = nodes.TryRun(program);
+            REQUIRE(!!expected == !!actual);
+            if (expected) {
+                REQUIRE(*expected == *actual);
+            } else {
+                REQUIRE(expected.GetError().kind == actual.GetError().kind);
+                REQUIRE(expected.GetError().message == actual.GetError().message);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("NodeValues") {
+    ExpectSameAsTree({
+        "42",
+        "'(1 (2 #(3)) . 4)",
+        "(+ 1 2)",
+        "((lambda (x y) (- x y)) 10 3)",
+        "((lambda (x) (+ x 1)) 9223372036854775807)",
+        "((lambda (x) (if x 'yes 'no)) #f)",
+        "((lambda (x) (if x 'yes)) #f)",
+        "((lambda (x) (and 1 x 3)) #f)",
+        "((lambda (x) (or #f x 3)) 2)",
+        "(and)",
+        "(or)",
+        "((lambda (x) (cond ((= x 1) 'one) ((+ x 2)) (else 'many))) 2)",
+        "((lambda (x) (cond ((= x 1) 'one))) 2)",
+        "((lambda (x) (begin (+ x 1) (* x 2))) 5)",
+        "(((lambda (x y) (lambda (y) (list x y))) 1 2) 3)",
+        "((lambda (f) (f f 3)) (lambda (self n) (if (= n 0) 0 (+ 1 (self self (- n 1))))))",
+        "(lambda (x) x)",
+        "((lambda (f) (f 1 2)) +)",
+        "car",
+        "(define-record-type point (make-point x y) point? (x point-x) (y point-y))",
+        "(point-y (make-point 1 2))",
+    });
+}
+
+TEST_CASE("NodeErrors") {
+    ExpectSameAsTree({
+        "()",
+        "x",
+        "(f 1)",
+        "((lambda (x) (car x)) 1)",
+        "((lambda (x) x) 1 2)",
+        "(1 2)",
+        "(+ 1 . 2)",
+        "(quote)",
+        "(if 1 . 2)",
+        "(or 1 . 2)",
+        "(begin)",
+        "(cond . 1)",
+        "(cond (#f 1) ())",
+        "(cond (#t 1) ())",
+        "(cond (#f 1) (else 2) (#t 3))",
+        "(lambda (x x) x)",
+        "(+ (car '()) (if))",
+        "((lambda (x) (if x (undefined) 1)) #f)",
+        "(define-record-type)",
+    });
+}
+
+TEST_CASE("NodeTailLoopRunsInConstantDepth") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::NODES);
+    interpreter.SetEvalDepthLimit(16);
+    REQUIRE(interpreter.Run("((lambda (loop) (loop loop 1000000 0))"
+                            " (lambda (self n acc)"
+                            "  (cond ((= n 0) acc) (else (self self (- n 1) (+ acc 1))))))") ==
+            "1000000");
+}
+
+TEST_CASE("NodesStopAtTheirDepthLimit") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::NODES);
+    std::string sum =
+        "((lambda (sum) (sum sum N))"
+        " (lambda (self n) (if (= n 0) 0 (+ n (self self (- n 1))))))";
+    REQUIRE(interpreter.Run(sum.replace(sum.find('N'), 1, "500")) == "125250");
+    auto result = interpreter.TryRun(sum.replace(sum.find("500"), 3, "100000"));
+    REQUIRE(!result);
+    REQUIRE(result.GetError().message == "maximum evaluation depth exceeded");
+
+    std::string nested;
+    for (size_t i = 0; i < 2 * kNodeDepthLimit; ++i) {
+        nested += "(+ 1 ";
+    }
+    nested += "x" + std::string(2 * kNodeDepthLimit, ')');
+    result = interpreter.TryRun("((lambda (x) " + nested + ") 0)");
+    REQUIRE(!result);
+    REQUIRE(result.GetError().message == "maximum evaluation depth exceeded");
+}
+
+TEST_CASE("NodesAreCachedByText") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::NODES);
+    FoldStats stats;
+    interpreter.SetFoldStats(&stats);
+    std::string program = "((lambda (x) (list x (+ 1 2) '(a b))) 0)";
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(interpreter.Run(program) == "(0 3 (a b))");
+    }
+    // Folded once, when the nodes were built.
+    REQUIRE(stats.folded == 1);
+}
+
+TEST_CASE("NodesSpecializeOnFixnums") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::NODES);
+    NodeStats stats;
+    interpreter.SetNodeStats(&stats);
+    std::string loop =
+        "((lambda (loop) (loop loop 1000 0))"
+        " (lambda (self n acc) (if (= n 0) acc (self self (- n 1) (+ acc 2)))))";
+    REQUIRE(interpreter.Run(loop) == "2000");
+    REQUIRE(stats.specialized == 3);
+    REQUIRE(stats.guard_failures == 0);
+
+    // The cached nodes stay specialized.
+    REQUIRE(interpreter.Run(loop) == "2000");
+    REQUIRE(stats.specialized == 3);
+
+    // A float, and then an overflow, fall back to the generic call once each.
+    stats = {};
+    REQUIRE(interpreter.Run("((lambda (f) (list (f 1) (f 1.5) (f 2))) (lambda (x) (+ x 1)))") ==
+            "(2 2.5 3)");
+    REQUIRE(stats.specialized == 1);
+    REQUIRE(stats.guard_failures == 1);
+    stats = {};
+    REQUIRE(interpreter.Run("((lambda (f) (list (f 1) (f 9223372036854775807)))"
+                            " (lambda (x) (* x 2)))") == "(2 18446744073709551614)");
+    REQUIRE(stats.specialized == 1);
+    REQUIRE(stats.guard_failures == 1);
+
+    // Operands of other types on the first run go straight to the generic call.
+    stats = {};
+    REQUIRE(interpreter.Run("((lambda (f) (list (f 1.5) (f 1))) (lambda (x) (+ x 1)))") ==
+            "(2.5 2)");
+    REQUIRE(stats.specialized == 0);
+    REQUIRE(stats.guard_failures == 0);
+    REQUIRE(!interpreter.TryRun("((lambda (x) (+ x 'a)) 1)"));
+}
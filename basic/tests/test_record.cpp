@@ -0,0 +1,58 @@
+#include "scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "RecordDefinition") {
+    ExpectEq("(define-record-type <point> (make-point x y) point? (x point-x set-point-x!) (y point-y))",
+             "<point>");
+    ExpectEq("(make-point 1 2)", "#<point 1 2>");
+    ExpectEq("(point? (make-point 1 2))", "#t");
+    ExpectEq("(point? '(1 2))", "#f");
+    ExpectEq("(point? 1)", "#f");
+    ExpectEq("(point-x (make-point 1 2))", "1");
+    ExpectEq("(point-y (make-point 1 (+ 1 1)))", "2");
+    ExpectEq("(set-point-x! (make-point 1 2) 5)", "#<point 5 2>");
+    ExpectEq("(point-x (set-point-x! (make-point 1 2) 5))", "5");
+}
+
+TEST_CASE_METHOD(SchemeTest, "RecordPartialConstructor") {
+    ExpectEq("(define-record-type node (make-node value) node? (value node-value) (next node-next))",
+             "node");
+    ExpectEq("(make-node 1)", "#<node 1 #f>");
+    ExpectEq("(node-next (make-node 1))", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "RecordTypeChecks") {
+    ExpectEq("(define-record-type a (make-a x) a? (x a-x))", "a");
+    ExpectEq("(define-record-type b (make-b x) b? (x b-x))", "b");
+    ExpectEq("(a? (make-b 1))", "#f");
+    ExpectEq("(b? (make-b 1))", "#t");
+
+    ExpectRuntimeError("(a-x (make-b 1))");
+    ExpectRuntimeError("(a-x 1)");
+    ExpectRuntimeError("(make-a)");
+    ExpectRuntimeError("(make-a 1 2)");
+    ExpectRuntimeError("(a-x)");
+    ExpectNameError("(make-c 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "RecordRedefinition") {
+    ExpectEq("(define-record-type p (make-p x) p? (x p-x))", "p");
+    ExpectEq("(define-record-type p (make-p x y) p? (x p-x) (y p-y))", "p");
+    ExpectEq("(make-p 1 2)", "#<p 1 2>");
+    ExpectEq("(p-y (make-p 1 2))", "2");
+    ExpectRuntimeError("(make-p 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "RecordMalformed") {
+    ExpectSyntaxError("(define-record-type)");
+    ExpectSyntaxError("(define-record-type p (make-p x))");
+    ExpectSyntaxError("(define-record-type 1 (make-p) p?)");
+    ExpectSyntaxError("(define-record-type p (make-p y) p? (x p-x))");
+    ExpectSyntaxError("(define-record-type p (make-p x) p? (x p-x) (x p-x2))");
+    ExpectSyntaxError("(define-record-type p (make-p x) p? (x))");
+    ExpectSyntaxError("(define-record-type p (make-p x) p? (x 1))");
+    ExpectSyntaxError("(define-record-type p (make-p x) p? x)");
+    ExpectSyntaxError("(define-record-type p (make-p . x) p? (x p-x))");
+
+    // Nothing of a rejected definition is registered.
+    ExpectNameError("(make-p 1)");
+}
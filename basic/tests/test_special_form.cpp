@@ -0,0 +1,76 @@
+#include "scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "SpecialFormsSkipUnusedArguments") {
+    // Each skipped expression would fail if it were evaluated.
+    ExpectEq("(and #f (car 1))", "#f");
+    ExpectEq("(or 1 (undefined))", "1");
+    ExpectEq("(and 1 (or #f 2) (car '(3)))", "3");
+    ExpectRuntimeError("(and 1 (car 1))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "If") {
+    ExpectEq("(if #t 1 2)", "1");
+    ExpectEq("(if #f 1 2)", "2");
+    ExpectEq("(if '() 1 2)", "1");
+    ExpectEq("(if (> 2 1) 'yes (car 1))", "yes");
+    ExpectEq("(if (< 2 1) (car 1) 'no)", "no");
+    ExpectEq("(if #f 1)", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "IfInvalidSyntax") {
+    ExpectSyntaxError("(if)");
+    ExpectSyntaxError("(if #t)");
+    ExpectSyntaxError("(if #t 1 2 3)");
+    ExpectSyntaxError("(if #t . 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Cond") {
+    ExpectEq("(cond ((> 1 2) 'a) ((> 2 1) 'b) (else 'c))", "b");
+    ExpectEq("(cond (#f 1) (else 2 3))", "3");
+    ExpectEq("(cond ((+ 1 2)))", "3");
+    ExpectEq("(cond (#f 1))", "#f");
+    ExpectEq("(cond)", "#f");
+    ExpectEq("(cond (1 'first) ((car 1) 'never))", "first");
+}
+
+TEST_CASE_METHOD(SchemeTest, "CondInvalidSyntax") {
+    ExpectSyntaxError("(cond ())");
+    ExpectSyntaxError("(cond 1)");
+    ExpectSyntaxError("(cond (else 1) (#t 2))");
+    ExpectSyntaxError("(cond (else))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "QuoteInvalidSyntax") {
+    ExpectSyntaxError("(quote)");
+    ExpectSyntaxError("(quote 1 2)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Begin") {
+    ExpectEq("(begin 1 2 3)", "3");
+    ExpectEq("(begin (+ 1 2))", "3");
+    ExpectRuntimeError("(begin (car 1) 2)");
+    ExpectSyntaxError("(begin)");
+    ExpectSyntaxError("(begin 1 . 2)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Lambda") {
+    ExpectEq("(lambda (x) x)", "#<procedure>");
+    ExpectEq("((lambda (x y) (+ x y)) 1 2)", "3");
+    ExpectEq("((lambda () 1 2))", "2");
+    ExpectEq("((lambda (x) ((lambda (y) (- x y)) 2)) 5)", "3");
+    ExpectEq("(((lambda (x) (lambda (y) (* x y))) 3) 4)", "12");
+    ExpectEq("((lambda (f) (f 1 2)) +)", "3");
+    ExpectEq("((lambda (car) car) 5)", "5");
+    ExpectEq("((lambda (x) '(x)) 1)", "(x)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "LambdaErrors") {
+    ExpectRuntimeError("((lambda (x) x))");
+    ExpectRuntimeError("((lambda (x) x) 1 2)");
+    ExpectRuntimeError("(1 2)");
+    ExpectNameError("((lambda (x) y) 1)");
+    ExpectSyntaxError("(lambda (x))");
+    ExpectSyntaxError("(lambda x x)");
+    ExpectSyntaxError("(lambda (x 1) x)");
+    ExpectSyntaxError("(lambda (x x) x)");
+}
@@ -0,0 +1,58 @@
+#include "scheme_test.h"
+
+#include <object.h>
+
+TEST_CASE_METHOD(SchemeTest, "StringLiterals") {
+    ExpectEq(R"("abc")", R"("abc")");
+    ExpectEq(R"("")", R"("")");
+    ExpectEq(R"("a\"b\\c\nd\te")", R"("a\"b\\c\nd\te")");
+    ExpectEq(R"('("a" 1))", R"(("a" 1))");
+    ExpectEq(R"((string? "x"))", "#t");
+    ExpectEq("(string? 'x)", "#f");
+
+    ExpectSyntaxError(R"("abc)");
+    ExpectSyntaxError(R"("a\qb")");
+}
+
+TEST_CASE_METHOD(SchemeTest, "StringAccess") {
+    ExpectEq(R"((string-length "hello"))", "5");
+    ExpectEq(R"((string-length ""))", "0");
+    ExpectEq(R"((string-ref "abc" 1))", R"("b")");
+    ExpectEq(R"((substring "hello world" 6))", R"("world")");
+    ExpectEq(R"((substring "hello" 1 3))", R"("el")");
+    ExpectEq(R"((substring "hello" 5 5))", R"("")");
+
+    ExpectRuntimeError(R"((string-ref "abc" 3))");
+    ExpectRuntimeError(R"((substring "hello" 3 2))");
+    ExpectRuntimeError(R"((substring "hello" 0 6))");
+    ExpectRuntimeError("(string-length 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "StringAppendAndCompare") {
+    ExpectEq("(string-append)", R"("")");
+    ExpectEq(R"((string-append "foo" "bar" ""))", R"("foobar")");
+    ExpectEq(R"((string=? "ab" (string-append "a" "b") "ab"))", "#t");
+    ExpectEq(R"((string=? "ab" "abc"))", "#f");
+
+    ExpectRuntimeError(R"((string-append "a" 1))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "StringSearch") {
+    ExpectEq(R"((string-contains "hello world" "o w"))", "4");
+    ExpectEq(R"((string-contains "hello world" "o"))", "4");
+    ExpectEq(R"((string-contains "hello" "z"))", "#f");
+    ExpectEq(R"((string-contains "hello" ""))", "0");
+    ExpectEq(R"((string-contains "lo" "hello"))", "#f");
+}
+
+TEST_CASE("Repeated appends build a rope") {
+    const std::string piece = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!?";
+    auto str = Make<String>(piece);
+    for (int i = 0; i < 100000; ++i) {
+        str = String::Concat(str, Make<String>(piece));
+    }
+    REQUIRE(str->Size() == piece.size() * 100001);
+    REQUIRE(str->Flat().size() == str->Size());
+    REQUIRE(str->Flat().substr(piece.size() * 500, piece.size()) == piece);
+    REQUIRE(str->Find("!?0") == piece.size() - 2);
+}
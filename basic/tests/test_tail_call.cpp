@@ -0,0 +1,59 @@
+#include "scheme_test.h"
+
+#include <string>
+
+namespace {
+
+// Counts `n` down to zero with `self` calling itself in tail position of `body`, where `next` is
+// the recursive call.
+std::string Loop(const std::string& body, int n) {
+    std::string next = "(self self (- n 1) (+ acc 1))";
+    std::string with_next = body;
+    with_next.replace(with_next.find("NEXT"), 4, next);
+    return "((lambda (loop) (loop loop " + std::to_string(n) + " 0)) (lambda (self n acc) " +
+           with_next + "))";
+}
+
+#ifdef SCHEME_COMPRESSED_REFS
+// Objects are owned by the arena until the end of Run there, so memory grows with the loop.
+constexpr int kIterations = 100000;
+#else
+constexpr int kIterations = 10000000;
+#endif
+
+}  // namespace
+
+TEST_CASE("TailLoopRunsInBoundedMemory") {
+    Interpreter interpreter;
+    // A handful of pending steps per iteration at most; a call that is not in tail position would
+    // add some on every one.
+    interpreter.SetEvalDepthLimit(16);
+    auto result = interpreter.Run(Loop("(if (= n 0) acc NEXT)", kIterations));
+    REQUIRE(result == std::to_string(kIterations));
+#ifndef SCHEME_COMPRESSED_REFS
+    // The objects of an iteration are freed into the arena and reused by the next one.
+    REQUIRE(interpreter.GetHeapStats().regions_mapped == 1);
+#endif
+}
+
+TEST_CASE("TailPositions") {
+    Interpreter interpreter;
+    interpreter.SetEvalDepthLimit(16);
+    constexpr int kCount = 100000;
+    auto expected = std::to_string(kCount);
+    REQUIRE(interpreter.Run(Loop("(cond ((= n 0) acc) (else NEXT))", kCount)) == expected);
+    REQUIRE(interpreter.Run(Loop("(cond ((= n 0) acc) ((> n 0) 'dummy NEXT))", kCount)) ==
+            expected);
+    REQUIRE(interpreter.Run(Loop("(if (= n 0) acc (and #t NEXT))", kCount)) == expected);
+    REQUIRE(interpreter.Run(Loop("(if (= n 0) acc (or #f NEXT))", kCount)) == expected);
+    REQUIRE(interpreter.Run(Loop("(if (= n 0) acc (begin n NEXT))", kCount)) == expected);
+    REQUIRE(interpreter.Run(Loop("(if (= n 0) acc ((lambda () NEXT)))", kCount)) == expected);
+}
+
+TEST_CASE("CallsOutsideTailPositionAreLimited") {
+    Interpreter interpreter;
+    interpreter.SetEvalDepthLimit(16);
+    auto result = interpreter.TryRun(Loop("(if (= n 0) acc (+ 0 NEXT))", 100));
+    REQUIRE(!result);
+    REQUIRE(result.GetError().message == "maximum evaluation depth exceeded");
+}
@@ -50,6 +50,40 @@ TEST_CASE("Negative numbers") {
     REQUIRE(tokenizer.GetToken() == Token{ConstantToken{2}});
 }
 
+TEST_CASE("Float literals") {
+    std::stringstream ss{"1.5 -0.25 .5 2e3 1.5E-2 7 . 8"};
+    Tokenizer tokenizer{&ss};
+
+    REQUIRE(tokenizer.GetToken() == Token{FloatToken{1.5}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{FloatToken{-0.25}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{FloatToken{0.5}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{FloatToken{2000}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{FloatToken{0.015}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{7}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{DotToken{}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{8}});
+}
+
+TEST_CASE("String literals") {
+    std::stringstream ss{R"EOF("abc" "" "a\"b\\c\n" 1)EOF"};
+    Tokenizer tokenizer{&ss};
+
+    REQUIRE(tokenizer.GetToken() == Token{StringToken{"abc"}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{StringToken{""}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{StringToken{"a\"b\\c\n"}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{1}});
+}
+
 TEST_CASE("Symbol names") {
     std::stringstream ss{"foo bar zog-zog?"};
     Tokenizer tokenizer{&ss};
@@ -0,0 +1,55 @@
+#include "scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "VectorsAreSelfEvaluating") {
+    ExpectEq("#()", "#()");
+    ExpectEq("#(1 2 3)", "#(1 2 3)");
+    ExpectEq("#(1 #t (2 3) #(4))", "#(1 #t (2 3) #(4))");
+    ExpectEq("'#(1 2)", "#(1 2)");
+
+    ExpectSyntaxError("#(1 2");
+    ExpectSyntaxError("#(1 . 2)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorPredicate") {
+    ExpectEq("(vector? #(1))", "#t");
+    ExpectEq("(vector? '(1))", "#f");
+    ExpectEq("(vector? 1)", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorConstruction") {
+    ExpectEq("(vector)", "#()");
+    ExpectEq("(vector 1 (+ 1 1) 3)", "#(1 2 3)");
+    ExpectEq("(make-vector 3 0)", "#(0 0 0)");
+    ExpectEq("(make-vector 2)", "#(#f #f)");
+    ExpectEq("(make-vector 0 1)", "#()");
+
+    ExpectRuntimeError("(make-vector)");
+    ExpectRuntimeError("(make-vector -1)");
+    ExpectRuntimeError("(make-vector #t)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorAccess") {
+    ExpectEq("(vector-length #(1 2 3))", "3");
+    ExpectEq("(vector-length (make-vector 10 1))", "10");
+    ExpectEq("(vector-ref #(1 2 3) 0)", "1");
+    ExpectEq("(vector-ref (vector 1 2 3) (- 3 1))", "3");
+    ExpectEq("(vector-set! (make-vector 3 0) 1 5)", "#(0 5 0)");
+    ExpectEq("(vector-ref (vector-set! (vector 1 2) 0 '(a)) 0)", "(a)");
+
+    ExpectRuntimeError("(vector-ref #(1 2 3) 3)");
+    ExpectRuntimeError("(vector-ref #(1 2 3) -1)");
+    ExpectRuntimeError("(vector-ref '(1 2 3) 0)");
+    ExpectRuntimeError("(vector-set! #(1 2 3) 3 0)");
+    ExpectRuntimeError("(vector-length '(1 2))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorListConversion") {
+    ExpectEq("(vector->list #(1 2 3))", "(1 2 3)");
+    ExpectEq("(vector->list #())", "()");
+    ExpectEq("(list->vector '(1 2 3))", "#(1 2 3)");
+    ExpectEq("(list->vector '())", "#()");
+    ExpectEq("(list->vector (vector->list #(1 (2) #t)))", "#(1 (2) #t)");
+
+    ExpectRuntimeError("(list->vector '(1 . 2))");
+    ExpectRuntimeError("(vector->list '(1 2))");
+}
@@ -0,0 +1,168 @@
+#include "scheme_test.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Runs `programs` in order with each engine and requires the same values and errors.
+void ExpectSameOnBothEngines(const std::vector<std::string>& programs) {
+    Interpreter tree;
+    Interpreter bytecode;
+    bytecode.SetEngine(Engine::BYTECODE);
+    for (const auto& program : programs) {
+        INFO(program);
+        auto expected = tree.TryRun(program);
+        auto actual = bytecode.TryRun(program);
+        REQUIRE(!!expected == !!actual);
+        if (expected) {
+            REQUIRE(*expected == *actual);
+        } else {
+            REQUIRE(expected.GetError().kind == actual.GetError().kind);
+            REQUIRE(expected.GetError().message == actual.GetError().message);
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("BytecodeValues") {
+    ExpectSameOnBothEngines({
+        "42",
+        "'(1 . 2)",
+        "\"abc\"",
+        "(+ 1 2)",
+        "((lambda (x y) (- x y)) 10 3)",
+        "((lambda (x) (* x x x)) 4611686018427387904)",
+        "((lambda (x) (+ x 1)) 9223372036854775807)",
+        "((lambda (x) (- x 1)) -9223372036854775808)",
+        "((lambda (x) (+ x 1.5)) 2)",
+        "((lambda (x y) (list (= x y) (< x y) (> x y) (<= x y) (>= x y))) 1 2)",
+        "((lambda (x) (+ x 1 2 3)) 4)",
+        "((lambda (x) (if x 'yes 'no)) #f)",
+        "((lambda (x) (if x 'yes)) #f)",
+        "((lambda (x) (if x 'yes)) 0)",
+        "((lambda (x) (and 1 x 3)) #f)",
+        "((lambda (x) (and 1 x 3)) 2)",
+        "((lambda (x) (or #f x 3)) #f)",
+        "((lambda (x) (or #f x 3)) 2)",
+        "(and)",
+        "(or)",
+        "((lambda (x) (cond ((= x 1) 'one) ((= x 2)) (else 'many))) 1)",
+        "((lambda (x) (cond ((= x 1) 'one) ((+ x 2)) (else 'many))) 2)",
+        "((lambda (x) (cond ((= x 1) 'one))) 2)",
+        "(cond)",
+        "((lambda (x) (begin (+ x 1) (* x 2))) 5)",
+        "(((lambda (x) (lambda (y) (+ x y))) 1) 2)",
+        "(((lambda (x y) (lambda (y) (list x y))) 1 2) 3)",
+        "((lambda (f) (f f 3)) (lambda (self n) (if (= n 0) 0 (+ 1 (self self (- n 1))))))",
+        "(lambda (x) x)",
+        "((lambda (f) (f 1 2)) +)",
+        "((lambda (f) (f '(1 2))) car)",
+        "car",
+        "(define-record-type point (make-point x y) point? (x point-x) (y point-y))",
+        "(point-y (make-point 1 2))",
+        "((lambda (p) (point? p)) (make-point 1 2))",
+        "((lambda (x) ((lambda (y) (list x y)) 2)) 1)",
+        "(((lambda (x) (lambda (y) ((lambda (z) (list x y z)) 3))) 1) 2)",
+        "((lambda (x) (car (cons x (+ x 1)))) 5)",
+        "((lambda (x) (cdr (cons x (+ x 1)))) 5)",
+        "((lambda (cons) (car (cons 1 2))) list)",
+    });
+}
+
+TEST_CASE("BytecodeErrors") {
+    ExpectSameOnBothEngines({
+        "()",
+        "x",
+        "(f 1)",
+        "(+ 1 'a)",
+        "((lambda (x) (+ x 'a)) 1)",
+        "((lambda (x) (car x)) 1)",
+        "((lambda (x) x))",
+        "((lambda (x) x) 1 2)",
+        "(1 2)",
+        "((lambda (x) (x)) 1)",
+        "(+ 1 . 2)",
+        "(quote)",
+        "(if)",
+        "(if 1 . 2)",
+        "(and 1 . 2)",
+        "(or 1 . 2)",
+        "(begin)",
+        "(begin 1 . 2)",
+        "(cond . 1)",
+        "(cond (#f 1) ())",
+        "(cond (#t 1) ())",
+        "(cond (#f 1) (else 2) (#t 3))",
+        "(cond (else))",
+        "(cond (#f 1) (1 . 2))",
+        "(lambda)",
+        "(lambda (x x) x)",
+        "(lambda (x 1) x)",
+        "(lambda (x . y) x)",
+        "(+ (car '()) (if))",
+        "((lambda (x) (if x (undefined) 1)) #f)",
+        "((lambda (x) (if x (undefined) 1)) #t)",
+        "(define-record-type)",
+        "((lambda (x y) x) 1)",
+        "((lambda (x) (car (cons x (car x)))) 1)",
+        "((lambda (x) (cdr (cons (car x) x))) 1)",
+        "((lambda (x) (car (cons x))) 1)",
+    });
+}
+
+TEST_CASE("BytecodeAllocatesNoFramesOrTemporaries") {
+    // What one more iteration of `loop` allocates, with the engine `engine`.
+    auto per_iteration = [](Engine engine, const std::string& loop) {
+        Interpreter interpreter;
+        interpreter.SetEngine(engine);
+        interpreter.Run(loop);
+        auto allocated = [&](const std::string& n) {
+            size_t before = interpreter.GetAllocationCount();
+            interpreter.Run("(loop " + n + ")");
+            return interpreter.GetAllocationCount() - before;
+        };
+        return (allocated("2000") - allocated("1000")) / 1000;
+    };
+    std::string plain = "(define (loop n) (if (= n 0) 0 (loop (- n 1))))";
+    std::string temporaries =
+        "(define (loop n) (if (= n 0) 0 ((lambda (m) (loop (car (cons m n)))) (- n 1))))";
+    size_t plain_count = per_iteration(Engine::BYTECODE, plain);
+    REQUIRE(plain_count < per_iteration(Engine::TREE, plain));
+    REQUIRE(per_iteration(Engine::BYTECODE, temporaries) == plain_count);
+}
+
+TEST_CASE("BytecodeTailLoopRunsInConstantDepth") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::BYTECODE);
+    interpreter.SetEvalDepthLimit(4);
+    REQUIRE(interpreter.Run("((lambda (loop) (loop loop 1000000 0))"
+                            " (lambda (self n acc)"
+                            "  (cond ((= n 0) acc) (else (self self (- n 1) (+ acc 1))))))") ==
+            "1000000");
+}
+
+TEST_CASE("BytecodeCallsOutsideTailPositionAreLimited") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::BYTECODE);
+    interpreter.SetEvalDepthLimit(16);
+    std::string sum =
+        "((lambda (sum) (sum sum N))"
+        " (lambda (self n) (if (= n 0) 0 (+ n (self self (- n 1))))))";
+    REQUIRE(interpreter.Run(sum.replace(sum.find('N'), 1, "16")) == "136");
+    auto result = interpreter.TryRun(sum.replace(sum.find("16"), 2, "17"));
+    REQUIRE(!result);
+    REQUIRE(result.GetError().message == "maximum evaluation depth exceeded");
+}
+
+TEST_CASE("BytecodeCompilesDeepNesting") {
+    Interpreter interpreter;
+    interpreter.SetEngine(Engine::BYTECODE);
+    std::string nested;
+    for (int i = 0; i < 100000; ++i) {
+        nested += "(+ 1 ";
+    }
+    nested += "x" + std::string(100000, ')');
+    REQUIRE(interpreter.Run("((lambda (x) " + nested + ") 0)") == "100000");
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <tokenizer.h>
 #include "error.h"
+#include <charconv>
+#include <cstdlib>
 #include <vector>
 
 SymbolToken::SymbolToken(std::string s) : name(s){};
@@ -17,16 +19,56 @@ bool DotToken::operator==(const DotToken&) const {
     return true;
 }
 
-ConstantToken::ConstantToken(int n) : value(n) {
+bool VectorToken::operator==(const VectorToken&) const {
+    return true;
+}
+
+bool BytevectorToken::operator==(const BytevectorToken&) const {
+    return true;
+}
+
+ConstantToken::ConstantToken(int64_t n) : value(n) {
 }
 
 bool ConstantToken::operator==(const ConstantToken& other) const {
     return value == other.value;
 }
 
-Tokenizer::Tokenizer(std::istream* in) : is_end_(false), stream_(in), curr_token_(0) {
-    Next();
-    curr_token_ = GetToken();
+BigConstantToken::BigConstantToken(std::string s) : digits(s) {
+}
+
+bool BigConstantToken::operator==(const BigConstantToken& other) const {
+    return digits == other.digits;
+}
+
+FloatToken::FloatToken(double d) : value(d) {
+}
+
+bool FloatToken::operator==(const FloatToken& other) const {
+    return value == other.value;
+}
+
+StringToken::StringToken(std::string s) : value(s) {
+}
+
+bool StringToken::operator==(const StringToken& other) const {
+    return value == other.value;
+}
+
+// `stack` is an optional '-' followed by decimal digits.
+Token NumberToken(const std::string& stack) {
+    int64_t value;
+    auto [end, error] = std::from_chars(stack.data(), stack.data() + stack.size(), value);
+    if (error == std::errc::result_out_of_range) {
+        return BigConstantToken(stack);
+    }
+    return ConstantToken(value);
+}
+
+Tokenizer::Tokenizer(std::istream* in) : is_end_(false), stream_(in), curr_token_(ConstantToken(0)) {
+    if (auto status = TryNext(); !status) {
+        error_ = std::move(status.GetError());
+    }
 }
 
 bool Tokenizer::IsEnd() {
@@ -66,7 +108,74 @@ bool IsInsideSymbol(char c) {
     return false;
 }
 
+// Reads the rest of a numeric literal whose sign and leading digits are already in `stack`.
+Result<Token> ReadNumber(std::istream* in, std::string stack) {
+    bool is_float = stack.find('.') != std::string::npos;
+    while (IsNumber(in->peek())) {
+        stack += in->get();
+    }
+    if (!is_float && in->peek() == '.') {
+        is_float = true;
+        stack += in->get();
+        while (IsNumber(in->peek())) {
+            stack += in->get();
+        }
+    }
+    if (in->peek() == 'e' || in->peek() == 'E') {
+        is_float = true;
+        stack += in->get();
+        if (in->peek() == '+' || in->peek() == '-') {
+            stack += in->get();
+        }
+        if (!IsNumber(in->peek())) {
+            return Error::Syntax("exponent without digits");
+        }
+        while (IsNumber(in->peek())) {
+            stack += in->get();
+        }
+    }
+    if (is_float) {
+        return FloatToken(std::strtod(stack.c_str(), nullptr));
+    }
+    return NumberToken(stack);
+}
+
+// Reads a string literal up to the closing quote; the opening one is already consumed.
+Result<Token> ReadString(std::istream* in) {
+    std::string value;
+    while (true) {
+        auto c = in->get();
+        if (c == EOF) {
+            return Error::Syntax("unterminated string");
+        }
+        if (c == '"') {
+            return StringToken(value);
+        }
+        if (c == '\\') {
+            c = in->get();
+            if (c == 'n') {
+                c = '\n';
+            } else if (c == 't') {
+                c = '\t';
+            } else if (c == 'r') {
+                c = '\r';
+            } else if (c != '"' && c != '\\') {
+                return Error::Syntax("unknown escape in string");
+            }
+        }
+        value += static_cast<char>(c);
+    }
+}
+
 void Tokenizer::Next() {
+    TryNext().ValueOrRaise();
+}
+
+const std::optional<Error>& Tokenizer::GetError() const {
+    return error_;
+}
+
+Result<void> Tokenizer::TryNext() {
     auto c = stream_->peek();
     if (c == EOF) {
         stream_->get();
@@ -76,7 +185,7 @@ void Tokenizer::Next() {
             if (stream_->peek() == EOF) {
                 stream_->get();
                 is_end_ = true;
-                return;
+                return {};
             }
             stream_->get();
         }
@@ -86,47 +195,42 @@ void Tokenizer::Next() {
         } else if (c1 == ')') {
             curr_token_ = BracketToken::CLOSE;
         } else if (c1 == '.') {
-            curr_token_ = DotToken();
+            if (IsNumber(stream_->peek())) {
+                SCHEME_TRY(curr_token_, ReadNumber(stream_, "."));
+            } else {
+                curr_token_ = DotToken();
+            }
         } else if (c1 == 39) {
             curr_token_ = QuoteToken();
+        } else if (c1 == '"') {
+            SCHEME_TRY(curr_token_, ReadString(stream_));
         } else if (c1 == '+') {
-            std::string stack;
-            while (IsNumber(stream_->peek())) {
-                stack += stream_->get();
-            }
-            if (!stack.empty()) {
-                curr_token_ = ConstantToken(std::stoi(stack));
+            if (IsNumber(stream_->peek())) {
+                SCHEME_TRY(curr_token_, ReadNumber(stream_, ""));
             } else {
                 curr_token_ = SymbolToken("+");
             }
         } else if (c1 == '-') {
-            std::string stack = "-";
-            while (IsNumber(stream_->peek())) {
-                stack += stream_->get();
-            }
-            if (stack != "-") {
-                curr_token_ = ConstantToken(std::stoi(stack));
+            if (IsNumber(stream_->peek())) {
+                SCHEME_TRY(curr_token_, ReadNumber(stream_, "-"));
             } else {
                 curr_token_ = SymbolToken("-");
             }
         } else if (IsNumber(c1)) {
-            std::string stack;
-            stack += c1;
-            while (IsNumber(stream_->peek())) {
-                stack += stream_->get();
-            }
-            curr_token_ = ConstantToken(std::stoi(stack));
+            SCHEME_TRY(curr_token_, ReadNumber(stream_, std::string(1, c1)));
         } else {
             if (c1 == '#') {
                 if (stream_->peek() == EOF) {
                     curr_token_ = SymbolToken("#");
-                    return;
+                    return {};
                 } else {
                     char c2 = stream_->get();
                     std::string stack;
                     stack += '#';
                     stack += c2;
-                    if (stream_->peek() == ' ' || stream_->peek() == ')') {
+                    if (c2 == '(') {
+                        curr_token_ = VectorToken();
+                    } else if (!IsInsideSymbol(stream_->peek())) {
                         if (c2 == 't') {
                             curr_token_ = BoolToken::TRUE;
                         } else if (c2 == 'f') {
@@ -134,13 +238,16 @@ void Tokenizer::Next() {
                         } else {
                             curr_token_ = SymbolToken(stack);
                         }
-                    } else if (IsInsideSymbol(stream_->peek())) {
+                    } else {
                         while (IsInsideSymbol(stream_->peek())) {
                             stack += stream_->get();
                         }
-                        curr_token_ = SymbolToken(stack);
-                    } else {
-                        curr_token_ = SymbolToken(stack);
+                        if (stack == "#u8" && stream_->peek() == '(') {
+                            stream_->get();
+                            curr_token_ = BytevectorToken();
+                        } else {
+                            curr_token_ = SymbolToken(stack);
+                        }
                     }
                 }
             } else if (IsStartingSymbol(c1)) {
@@ -151,10 +258,11 @@ void Tokenizer::Next() {
                 }
                 curr_token_ = SymbolToken(stack);
             } else {
-                throw SyntaxError({""});
+                return Error::Syntax(std::string("unexpected character '") + c1 + "'");
             }
         }
     }
+    return {};
 }
 
 Token Tokenizer::GetToken() {
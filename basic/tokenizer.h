@@ -3,6 +3,10 @@
 #include <variant>
 #include <optional>
 #include <istream>
+#include <cstdint>
+#include <string>
+
+#include "error.h"
 
 struct SymbolToken {
     std::string name;
@@ -18,33 +22,75 @@ struct DotToken {
     bool operator==(const DotToken&) const;
 };
 
+// Opening `#(` of a vector literal, closed by an ordinary BracketToken::CLOSE.
+struct VectorToken {
+    bool operator==(const VectorToken&) const;
+};
+
+// Opening `#u8(` of a bytevector literal.
+struct BytevectorToken {
+    bool operator==(const BytevectorToken&) const;
+};
+
 enum class BracketToken { OPEN, CLOSE };
 
 enum class BoolToken { TRUE, FALSE };
 
 struct ConstantToken {
-    int value;
-    ConstantToken(int n);
+    int64_t value;
+    ConstantToken(int64_t n);
     bool operator==(const ConstantToken& other) const;
 };
 
+// Integer literal outside of the int64_t range, kept as its decimal digits.
+struct BigConstantToken {
+    std::string digits;
+    BigConstantToken(std::string s);
+    bool operator==(const BigConstantToken& other) const;
+};
+
+// Literal with a fraction or an exponent, such as `1.5`, `.5` or `-2e10`.
+struct FloatToken {
+    double value;
+    FloatToken(double d);
+    bool operator==(const FloatToken& other) const;
+};
+
+// Contents of a `"..."` literal with the escapes already resolved.
+struct StringToken {
+    std::string value;
+    StringToken(std::string s);
+    bool operator==(const StringToken& other) const;
+};
+
 using Token =
-    std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken, BoolToken>;
+    std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken, BoolToken,
+                 VectorToken, BigConstantToken, FloatToken, StringToken,
+                 BytevectorToken>;
 
 class Tokenizer {
 public:
+    // Reads the first token. If it is malformed, the error is kept for GetError() instead of
+    // being thrown.
     Tokenizer(std::istream* in);
 
     bool IsEnd();
 
+    // Throws SyntaxError on a malformed token.
     void Next();
 
+    Result<void> TryNext();
+
+    // Error in the first token, if any.
+    const std::optional<Error>& GetError() const;
+
     Token GetToken();
 
 private:
     bool is_end_;
     std::istream* stream_;
     Token curr_token_;
+    std::optional<Error> error_;
 };
 
 bool IsTrivial(std::string str);
@@ -0,0 +1,438 @@
+#include "vm.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arg_stack.h"
+#include "eval.h"
+#include "special_forms.h"
+
+// Dispatch jumps straight from one instruction to the next through a table of label addresses
+// where the compiler supports it, and goes through a switch otherwise.
+#if defined(__GNUC__) || defined(__clang__)
+#define SCHEME_VM_COMPUTED_GOTO
+#endif
+
+namespace {
+
+// Procedure made by a compiled lambda. Its environment holds just the values that it captured.
+class CompiledClosure : public Procedure {
+public:
+    CompiledClosure(std::shared_ptr<const Code> code, std::shared_ptr<Environment> env)
+        : code_(std::move(code)), env_(std::move(env)) {
+    }
+
+    const std::shared_ptr<const Code>& GetCode() const {
+        return code_;
+    }
+
+    const std::shared_ptr<Environment>& GetEnv() const {
+        return env_;
+    }
+
+    std::shared_ptr<Object> Promote(Arena* arena) override {
+        return Make<CompiledClosure>(::Promote(code_, arena), ::Promote(env_, arena));
+    }
+
+private:
+    std::shared_ptr<const Code> code_;
+    std::shared_ptr<Environment> env_;
+};
+
+// Call in progress. The code is owned here, as the closure that it came from may be gone.
+//
+// The variables of a call live on the stack: its arguments, followed by the values that its
+// closure captured. Closures copy the values they capture, so nothing can refer to the variables
+// once the call returns, and no Environment is allocated for them.
+struct CallFrame {
+    std::shared_ptr<const Code> holder;
+    const Code* code;
+    const uint32_t* pc;
+    // Where the variables start on the stack, and where the value goes when the call returns.
+    size_t vars;
+    size_t result;
+};
+
+class Machine {
+public:
+    static Machine& Get() {
+        thread_local Machine machine;
+        return machine;
+    }
+
+    // Runs may nest, e.g. through a builtin that evaluates; each one only unwinds its own frames
+    // and values.
+    ObjectResult Run(const Code& code, size_t limit) {
+        size_t stack_base = stack_.size();
+        size_t frame_base = frames_.size();
+        frames_.push_back({nullptr, &code, code.ops.data(), stack_base, stack_base});
+        auto result = Loop(frame_base, frame_base + 1 + limit);
+        while (stack_.size() > stack_base) {
+            stack_.pop_back();
+        }
+        while (frames_.size() > frame_base) {
+            frames_.pop_back();
+        }
+        return result;
+    }
+
+private:
+    ObjectResult Loop(size_t base, size_t limit) {
+        const Code* code = frames_.back().code;
+        const uint32_t* pc = frames_.back().pc;
+        size_t vars = frames_.back().vars;
+        GlobalRegistry* globals = CurrentGlobals();
+        size_t count;
+
+#ifdef SCHEME_VM_COMPUTED_GOTO
+#define SCHEME_VM_LABEL(name) &&op_##name,
+        static const void* const kLabels[] = {SCHEME_OPCODES(SCHEME_VM_LABEL)};
+#undef SCHEME_VM_LABEL
+#define CASE(name) op_##name:
+#define DISPATCH() goto* kLabels[*pc++]
+        DISPATCH();
+#else
+#define CASE(name) case Op::name:
+#define DISPATCH() continue
+        while (true) {
+            switch (static_cast<Op>(*pc++)) {
+#endif
+        CASE(CONST) {
+            stack_.push_back(code->constants[*pc++]);
+            DISPATCH();
+        }
+        CASE(ARG) {
+            stack_.push_back(stack_[vars + *pc++]);
+            DISPATCH();
+        }
+        CASE(CAPTURED) {
+            stack_.push_back(stack_[vars + code->arity + *pc++]);
+            DISPATCH();
+        }
+        CASE(GLOBAL) {
+            const auto& value = globals->Get(*pc);
+            if (!value) {
+                return Error::Name(globals->GetName(*pc));
+            }
+            stack_.push_back(value);
+            ++pc;
+            DISPATCH();
+        }
+        CASE(DEFINE) {
+            SCHEME_TRY(stack_.back(), DefineGlobal(*pc++, stack_.back()));
+            DISPATCH();
+        }
+        CASE(BUILTIN) {
+            auto func = static_cast<Function*>(code->constants[pc[0]].get());
+            SCHEME_CHECK(ApplyTop(pc[1], [func](ArgSpan args) {
+                return WithName(func->Apply(args), func->GetName());
+            }));
+            pc += 2;
+            DISPATCH();
+        }
+        CASE(NAMED) {
+            count = pc[1];
+            if (const auto& callee = globals->Get(pc[0])) {
+                stack_.insert(stack_.end() - count, callee);
+                pc += 2;
+                goto op_CALL_COUNTED;
+            }
+            SCHEME_CHECK(ApplyNamed(globals->GetName(pc[0]), count));
+            pc += 2;
+            DISPATCH();
+        }
+        CASE(TAIL_NAMED) {
+            count = pc[1];
+            if (const auto& callee = globals->Get(pc[0])) {
+                stack_.insert(stack_.end() - count, callee);
+                pc += 2;
+                goto op_TAIL_CALL_COUNTED;
+            }
+            SCHEME_CHECK(ApplyNamed(globals->GetName(pc[0]), count));
+            goto op_RETURN_VALUE;
+        }
+        CASE(ADD) {
+            SCHEME_CHECK(Arithmetic<Op::ADD>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(SUB) {
+            SCHEME_CHECK(Arithmetic<Op::SUB>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(MUL) {
+            SCHEME_CHECK(Arithmetic<Op::MUL>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(EQ) {
+            SCHEME_CHECK(Arithmetic<Op::EQ>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(LT) {
+            SCHEME_CHECK(Arithmetic<Op::LT>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(GT) {
+            SCHEME_CHECK(Arithmetic<Op::GT>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(LE) {
+            SCHEME_CHECK(Arithmetic<Op::LE>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(GE) {
+            SCHEME_CHECK(Arithmetic<Op::GE>(code->constants[*pc++]));
+            DISPATCH();
+        }
+        CASE(CALL) {
+            count = *pc++;
+        op_CALL_COUNTED:
+            auto closure = dynamic_cast<CompiledClosure*>(stack_[stack_.size() - count - 1].get());
+            if (closure) {
+                SCHEME_CHECK(CheckArity(*closure->GetCode(), count));
+                if (frames_.size() >= limit) {
+                    return Error::Runtime("maximum evaluation depth exceeded");
+                }
+                // The callee stays below the variables until the call returns into its slot.
+                frames_.back().pc = pc;
+                vars = stack_.size() - count;
+                PushCaptured(*closure);
+                frames_.push_back(
+                    {closure->GetCode(), closure->GetCode().get(), nullptr, vars, vars - 1});
+                code = frames_.back().code;
+                pc = code->ops.data();
+                DISPATCH();
+            }
+            SCHEME_CHECK(ApplyValue(count));
+            DISPATCH();
+        }
+        CASE(TAIL_CALL) {
+            count = *pc++;
+        op_TAIL_CALL_COUNTED:
+            auto closure = dynamic_cast<CompiledClosure*>(stack_[stack_.size() - count - 1].get());
+            if (closure) {
+                // The body replaces the call, so a loop of calls runs in constant space.
+                SCHEME_CHECK(CheckArity(*closure->GetCode(), count));
+                CallFrame& frame = frames_.back();
+                frame.holder = closure->GetCode();
+                frame.code = frame.holder.get();
+                PushCaptured(*closure);
+                ReplaceVars(frame);
+                code = frame.code;
+                pc = code->ops.data();
+                DISPATCH();
+            }
+            SCHEME_CHECK(ApplyValue(count));
+            goto op_RETURN_VALUE;
+        }
+        CASE(ENTER) {
+            const Code* lambda = code->lambdas[*pc++].get();
+            if (frames_.size() >= limit) {
+                return Error::Runtime("maximum evaluation depth exceeded");
+            }
+            // The code of the current call holds the lambda, and outlives the new one.
+            frames_.back().pc = pc;
+            size_t lambda_vars = stack_.size() - lambda->arity;
+            PushCaptured(*lambda, vars, *code);
+            frames_.push_back({nullptr, lambda, nullptr, lambda_vars, lambda_vars});
+            code = lambda;
+            pc = code->ops.data();
+            vars = lambda_vars;
+            DISPATCH();
+        }
+        CASE(TAIL_ENTER) {
+            std::shared_ptr<const Code> lambda = code->lambdas[*pc];
+            // Captured before the variables of the current call are overwritten.
+            PushCaptured(*lambda, vars, *code);
+            CallFrame& frame = frames_.back();
+            frame.holder = std::move(lambda);
+            frame.code = frame.holder.get();
+            ReplaceVars(frame);
+            code = frame.code;
+            pc = code->ops.data();
+            DISPATCH();
+        }
+        CASE(RETURN) {
+        op_RETURN_VALUE:
+            if (frames_.size() == base + 1) {
+                frames_.pop_back();
+                auto value = std::move(stack_.back());
+                stack_.pop_back();
+                return value;
+            }
+            stack_[frames_.back().result] = std::move(stack_.back());
+            PopTop(stack_.size() - frames_.back().result - 1);
+            frames_.pop_back();
+            code = frames_.back().code;
+            pc = frames_.back().pc;
+            vars = frames_.back().vars;
+            DISPATCH();
+        }
+        CASE(JUMP) {
+            pc = code->ops.data() + *pc;
+            DISPATCH();
+        }
+        CASE(JUMP_IF_FALSE) {
+            bool is_false = IsFalse(stack_.back());
+            stack_.pop_back();
+            pc = is_false ? code->ops.data() + *pc : pc + 1;
+            DISPATCH();
+        }
+        CASE(AND_JUMP) {
+            if (IsFalse(stack_.back())) {
+                pc = code->ops.data() + *pc;
+            } else {
+                stack_.pop_back();
+                ++pc;
+            }
+            DISPATCH();
+        }
+        CASE(OR_JUMP) {
+            if (!IsFalse(stack_.back())) {
+                pc = code->ops.data() + *pc;
+            } else {
+                stack_.pop_back();
+                ++pc;
+            }
+            DISPATCH();
+        }
+        CASE(POP) {
+            stack_.pop_back();
+            DISPATCH();
+        }
+        CASE(CLOSURE) {
+            const auto& lambda = code->lambdas[*pc++];
+            stack_.push_back(Make<CompiledClosure>(lambda, Capture(*lambda, vars, *code)));
+            DISPATCH();
+        }
+        CASE(RECORD) {
+            SCHEME_TRY(auto name, DefineRecordType(code->constants[*pc++]));
+            stack_.push_back(std::move(name));
+            DISPATCH();
+        }
+        CASE(RAISE) {
+            return code->errors[*pc];
+        }
+#ifndef SCHEME_VM_COMPUTED_GOTO
+            }
+        }
+#endif
+#undef CASE
+#undef DISPATCH
+    }
+
+    void PopTop(size_t count) {
+        for (; count; --count) {
+            stack_.pop_back();
+        }
+    }
+
+    // Applies `apply` to the `count` values on top and replaces them with the result.
+    template <class F>
+    Result<void> ApplyTop(size_t count, F&& apply) {
+        auto result = apply(ArgSpan(stack_.data() + stack_.size() - count, count));
+        PopTop(count);
+        SCHEME_TRY(auto value, std::move(result));
+        stack_.push_back(std::move(value));
+        return {};
+    }
+
+    Result<void> ApplyNamed(const std::string& name, size_t count) {
+        return ApplyTop(count, [&name](ArgSpan args) { return ApplyByName(name, args); });
+    }
+
+    // The variable at `address` in a call of `code` whose variables start at `vars`.
+    const std::shared_ptr<Object>& Variable(size_t vars, const Code& code,
+                                            const Address& address) const {
+        return stack_[vars + (address.depth ? code.arity : 0) + address.index];
+    }
+
+    // The values that a closure of `lambda` captures from the call of `code` whose variables
+    // start at `vars`; none for most closures.
+    std::shared_ptr<Environment> Capture(const Code& lambda, size_t vars, const Code& code) const {
+        if (lambda.captures.empty()) {
+            return nullptr;
+        }
+        ArgFrame values(lambda.captures.size());
+        for (size_t i = 0; i < lambda.captures.size(); ++i) {
+            values[i] = Variable(vars, code, lambda.captures[i]);
+        }
+        return Make<Environment>(values.Args(), nullptr);
+    }
+
+    // Pushes the same values as Capture, for a lambda that is entered without a closure.
+    void PushCaptured(const Code& lambda, size_t vars, const Code& code) {
+        for (const auto& address : lambda.captures) {
+            auto value = Variable(vars, code, address);
+            stack_.push_back(std::move(value));
+        }
+    }
+
+    // Pushes the values that `closure` captured, after the arguments of its call.
+    void PushCaptured(const CompiledClosure& closure) {
+        size_t count = closure.GetCode()->captures.size();
+        for (size_t i = 0; i < count; ++i) {
+            stack_.push_back(closure.GetEnv()->Get(0, i));
+        }
+    }
+
+    // Applies the callee below the `count` values on top, which is not a compiled closure.
+    Result<void> ApplyValue(size_t count) {
+        auto& callee = stack_[stack_.size() - count - 1];
+        auto func = dynamic_cast<Function*>(callee.get());
+        if (!func) {
+            return Error::Runtime("cannot apply " + SerialiseExpr(callee));
+        }
+        SCHEME_CHECK(ApplyTop(count, [func](ArgSpan args) {
+            return WithName(func->Apply(args), func->GetName());
+        }));
+        auto value = std::move(stack_.back());
+        stack_.pop_back();
+        stack_.back() = std::move(value);
+        return {};
+    }
+
+    static Result<void> CheckArity(const Code& body, size_t count) {
+        if (count != body.arity) {
+            return Error::Runtime("procedure expects " + std::to_string(body.arity) +
+                                  " arguments, got " + std::to_string(count));
+        }
+        return {};
+    }
+
+    // Moves the variables of the call of frame.code, on top, into the place of those of the call
+    // that `frame` was running before; anything in between, like the callee, is dropped.
+    void ReplaceVars(const CallFrame& frame) {
+        size_t count = frame.code->arity + frame.code->captures.size();
+        size_t from = stack_.size() - count;
+        for (size_t i = 0; i < count; ++i) {
+            stack_[frame.vars + i] = std::move(stack_[from + i]);
+        }
+        PopTop(stack_.size() - frame.vars - count);
+    }
+
+    template <Op op>
+    Result<void> Arithmetic(const std::shared_ptr<Object>& builtin) {
+        auto* a = dynamic_cast<Number*>(stack_[stack_.size() - 2].get());
+        auto* b = dynamic_cast<Number*>(stack_.back().get());
+        std::shared_ptr<Object> value;
+        if (!a || !b || !Fixnum<op>(a->GetValue(), b->GetValue(), &value)) {
+            auto func = static_cast<Function*>(builtin.get());
+            SCHEME_TRY(value, WithName(func->Apply(ArgSpan(stack_.data() + stack_.size() - 2, 2)),
+                                       func->GetName()));
+        }
+        stack_.pop_back();
+        stack_.back() = std::move(value);
+        return {};
+    }
+
+    // Operands of the calls in progress, the newest on top.
+    std::vector<std::shared_ptr<Object>> stack_;
+    std::vector<CallFrame> frames_;
+};
+
+}  // namespace
+
+ObjectResult Execute(const Code& code, size_t depth_limit) {
+    return Machine::Get().Run(code, depth_limit);
+}
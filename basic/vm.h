@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+#include "bytecode.h"
+#include "object.h"
+
+// Runs `code` made by Compile and returns its value, or the error that the evaluator would have
+// failed with. Fails with a runtime error once more than `depth_limit` calls outside of tail
+// position are pending.
+ObjectResult Execute(const Code& code, size_t depth_limit);